@@ -0,0 +1,62 @@
+/*
+ *  BenchUtil.hpp
+ *
+ *  Author: Jazmin Ortiz
+ *
+ *  Helpers shared by the benchmarks in bench/: the clock every stage is
+ *  timed with, and the canned CLUTO tree that the ClusterParse stages read.
+ */
+
+#ifndef BENCHUTIL_HPP_INCLUDED
+#define BENCHUTIL_HPP_INCLUDED 1
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock::time_point TimePoint;
+
+/* Returns the number of seconds since start. */
+inline double seconds_since(TimePoint start)
+{
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/* Writes a CLUTO -fulltree output file for a tree over num_leaves leaves,
+ *     built by joining neighbouring clusters level by level, so that its
+ *     height is about log2(num_leaves). Line i holds the parent of node i,
+ *     the root's parent is -1. */
+inline void write_cluto_tree(const std::string& filename,
+                             std::size_t num_leaves)
+{
+    std::vector<long long> parents(2 * num_leaves - 1, -1);
+    std::vector<std::size_t> level;
+    for (std::size_t i = 0; i < num_leaves; ++i) {
+        level.push_back(i);
+    }
+
+    std::size_t next_node = num_leaves;
+    while (level.size() > 1) {
+        std::vector<std::size_t> joined;
+        for (std::size_t i = 0; i + 1 < level.size(); i += 2) {
+            parents[level[i]] = next_node;
+            parents[level[i + 1]] = next_node;
+            joined.push_back(next_node++);
+        }
+        if (level.size() % 2 == 1) {
+            joined.push_back(level.back());
+        }
+        level.swap(joined);
+    }
+
+    std::ofstream out(filename);
+    for (std::size_t i = 0; i < parents.size(); ++i) {
+        out << parents[i] << " 0.000000e+00 0.000000e+00\n";
+    }
+}
+
+#endif // BENCHUTIL_HPP_INCLUDED
@@ -0,0 +1,248 @@
+/*
+ *  microbench.cpp
+ *
+ *  Author: Jazmin Ortiz
+ *
+ *  Micro-benchmarks for the hot paths of TraceSet, FrequentPairs and
+ *  ClusterParse. Each benchmark is run at several input sizes, and each size
+ *  is repeated so that the spread of the timings can be reported with them.
+ *  Every result is a single comma separated line of the form
+ *
+ *      benchmark,size,reps,ns_per_op,stddev_ns,min_ns,throughput,unit
+ *
+ *  where ns_per_op is the mean over the repetitions, stddev_ns their sample
+ *  standard deviation and min_ns the fastest, and throughput is in millions
+ *  of operations per second at the mean. What an operation is depends on the
+ *  benchmark and is given by unit. The input of every benchmark is generated
+ *  from a fixed seed, so two runs measure the same work and their output can
+ *  be compared line by line.
+ *
+ *  Usage: micro-bench [reps] [max_size]
+ *
+ *  The sizes are the powers of ten from 10^4 up to max_size (10^6 by
+ *  default), and each is repeated reps times (5 by default).
+ */
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include <algorithm>
+
+#include "trace_set/TraceSet.hpp"
+#include "frequent_pairs/FrequentPairs.hpp"
+#include "cluster_parse/ClusterParse.hpp"
+#include "bench/BenchUtil.hpp"
+
+using namespace std;
+
+// Written to by every benchmark so that the work cannot be optimized away.
+static size_t sink = 0;
+
+/* Runs repetition reps times, each call does its own setup and returns the
+ *     seconds taken by the part being measured, which did ops operations,
+ *     and prints the result line. */
+static void measure(const string& name, size_t size, size_t ops,
+                    unsigned reps, const string& unit,
+                    const function<double()>& repetition)
+{
+    vector<double> ns_per_op;
+    for (unsigned r = 0; r < reps; ++r) {
+        ns_per_op.push_back(repetition() * 1e9 / ops);
+    }
+
+    double mean = 0;
+    for (size_t r = 0; r < ns_per_op.size(); ++r) {
+        mean += ns_per_op[r];
+    }
+    mean /= ns_per_op.size();
+
+    double variance = 0;
+    for (size_t r = 0; r < ns_per_op.size(); ++r) {
+        variance += (ns_per_op[r] - mean) * (ns_per_op[r] - mean);
+    }
+    if (ns_per_op.size() > 1) {
+        variance /= ns_per_op.size() - 1;
+    }
+
+    cout << name << "," << size << "," << reps << "," << mean << ","
+         << sqrt(variance) << ","
+         << *min_element(ns_per_op.begin(), ns_per_op.end()) << ","
+         << 1e3 / mean << "," << unit << endl;
+}
+
+/* Returns num_accesses LBAs drawn from a skewed distribution over as many
+ *     LBAs, the same way for every run. */
+static vector<size_t> make_LBAs(size_t num_accesses)
+{
+    vector<size_t> LBAs(num_accesses);
+    unsigned long long state = 2015;
+    for (size_t i = 0; i < num_accesses; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t r = (state >> 33) % num_accesses;
+        LBAs[i] = r * r / num_accesses;
+    }
+    return LBAs;
+}
+
+/* Writes the LBAs one per line to the file called filename. */
+static void write_trace(const string& filename, const vector<size_t>& LBAs)
+{
+    ofstream out(filename);
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        out << LBAs[i] << "\n";
+    }
+}
+
+/* Runs every benchmark at the given size. */
+static void run_size(size_t size, unsigned reps)
+{
+    string trace_name = "micro-bench.trace";
+    string tree_name = "micro-bench.tree";
+    vector<size_t> LBAs = make_LBAs(size);
+    write_trace(trace_name, LBAs);
+
+    measure("TraceSet::readIn", size, size, reps, "Maccesses/s", [&]() {
+        TraceSet trace;
+        ifstream in(trace_name);
+        TimePoint start = chrono::steady_clock::now();
+        trace.readIn(in);
+        double seconds = seconds_since(start);
+        sink += trace.get_Sequence().size();
+        return seconds;
+    });
+
+    measure("TraceSet::readInMapped", size, size, reps, "Maccesses/s",
+            [&]() {
+        TraceSet trace;
+        TimePoint start = chrono::steady_clock::now();
+        trace.readInMapped(trace_name);
+        double seconds = seconds_since(start);
+        sink += trace.get_Sequence().size();
+        return seconds;
+    });
+
+    measure("TraceSet::insert", size, size, reps, "Maccesses/s", [&]() {
+        TraceSet trace;
+        TimePoint start = chrono::steady_clock::now();
+        for (size_t i = 0; i < LBAs.size(); ++i) {
+            trace.insert(LBAs[i]);
+        }
+        double seconds = seconds_since(start);
+        sink += trace.get_Sequence().size();
+        return seconds;
+    });
+
+    TraceSet loaded;
+    loaded.readInMapped(trace_name);
+    loaded.total_seek_distance();
+    measure("TraceSet::total_seek_distance", size, size, reps,
+            "Maccesses/s", [&]() {
+        TimePoint start = chrono::steady_clock::now();
+        sink += loaded.total_seek_distance();
+        return seconds_since(start);
+    });
+
+    // The hottest 1% of the LBAs are moved to the front, on a fresh trace
+    // each time since change_locations changes it. The locations of the
+    // whole trace are shifted, so the time is given per access.
+    vector<size_t> hot = loaded.rank_LBAs(size / 100, 1);
+    measure("TraceSet::change_locations", size, size, reps,
+            "Maccesses/s", [&]() {
+        TraceSet trace;
+        trace.readInMapped(trace_name);
+        TimePoint start = chrono::steady_clock::now();
+        trace.change_locations(hot, 0);
+        double seconds = seconds_since(start);
+        sink += trace.get_mapLBA()[hot[0]].location;
+        return seconds;
+    });
+
+    // The accesses of 1000 LBAs of the trace, each found by following its
+    // chain of next indices.
+    size_t num_queries = 1000;
+    measure("TraceSet::get_indices", size, num_queries, reps, "Mqueries/s",
+            [&]() {
+        TimePoint start = chrono::steady_clock::now();
+        for (size_t q = 0; q < num_queries; ++q) {
+            sink += loaded.get_indices(LBAs[q * LBAs.size() / num_queries])
+                        .size();
+        }
+        return seconds_since(start);
+    });
+
+    // The adjacency matrix of the 100 hottest LBAs
+    FrequentPairs pairs;
+    pairs.get_Sequence() = LBAs;
+    vector<size_t> frequent = loaded.rank_LBAs(100, 1);
+    for (size_t i = 0; i < frequent.size(); ++i) {
+        pairs.insert_Frequent_LBA(to_string(frequent[i]));
+    }
+    measure("FrequentPairs::fillInFrequentMatrix", size, size, reps,
+            "Maccesses/s", [&]() {
+        TimePoint start = chrono::steady_clock::now();
+        vector<vector<float>> matrix = pairs.fillInFrequentMatrix();
+        double seconds = seconds_since(start);
+        sink += matrix.size();
+        return seconds;
+    });
+
+    // A cluster tree over one leaf for every ten accesses
+    size_t num_leaves = size / 10;
+    write_cluto_tree(tree_name, num_leaves);
+    measure("ClusterParse::readIn", num_leaves, 2 * num_leaves - 1, reps,
+            "Mnodes/s", [&]() {
+        ClusterParse cluster;
+        ifstream in(tree_name);
+        TimePoint start = chrono::steady_clock::now();
+        cluster.readIn(in, false);
+        double seconds = seconds_since(start);
+        sink += cluster.getRoot();
+        return seconds;
+    });
+
+    ClusterParse cluster;
+    ifstream tree(tree_name);
+    cluster.readIn(tree, false);
+    vector<size_t> no_mapping;
+    measure("ClusterParse::formatOutput", num_leaves, num_leaves, reps,
+            "Mleaves/s", [&]() {
+        TimePoint start = chrono::steady_clock::now();
+        vector<size_t> leaves = cluster.formatOutput(no_mapping);
+        double seconds = seconds_since(start);
+        sink += leaves.size();
+        return seconds;
+    });
+
+    remove(trace_name.c_str());
+    remove(tree_name.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned reps = 5;
+    size_t max_size = 1000000;
+    if (argc > 1) {
+        reps = strtoul(argv[1], nullptr, 10);
+    }
+    if (argc > 2) {
+        max_size = strtoull(argv[2], nullptr, 10);
+    }
+    if (reps == 0) {
+        reps = 1;
+    }
+
+    cout << "benchmark,size,reps,ns_per_op,stddev_ns,min_ns,throughput,unit"
+         << endl;
+    for (size_t size = 10000; size <= max_size; size *= 10) {
+        run_size(size, reps);
+    }
+
+    cerr << "checksum " << sink << endl;
+    return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ *  scalebench.cpp
+ *
+ *  Author: Jazmin Ortiz
+ *
+ *  End to end scaling benchmark of the whole pipeline, run on traces made by
+ *  TraceGenerator at every power of ten from 10^6 accesses up to
+ *  max_accesses, and at 1, 2, 4, ... threads up to max_threads. The stages
+ *  are the ones postcluto and the loaders go through:
+ *
+ *      load              TraceSet::readInParallel of the text trace
+ *      rank              TraceSet::rank_LBAs of the top_k hottest LBAs
+ *      pairs             FrequentPairs::fillInFrequentMatrix over them
+ *      parse             ClusterParse::readIn and formatOutput of a canned
+ *                        CLUTO tree over the top_k LBAs
+ *      change_locations  TraceSet::change_locations with the cluster order
+ *      seek              TraceSet::total_seek_distance
+ *
+ *  and a last pipeline line holds the wall time of the whole configuration.
+ *  FrequentPairs, ClusterParse and change_locations have no threaded
+ *  versions, so only load, rank and seek should scale with the threads. Every
+ *  result is a single comma separated line of the form
+ *
+ *      stage,size,threads,seconds,throughput,unit,peak_rss_MB,baseline_ratio
+ *
+ *  Each configuration runs in its own child process, so that peak_rss_MB is
+ *  the peak resident set size of that configuration alone (up to the end of
+ *  the stage) and a configuration that runs out of memory does not stop the
+ *  ones after it.
+ *
+ *  The output of one run can be kept as a baseline,
+ *
+ *      scale-bench 100000000 > bench/scale-baseline.csv
+ *
+ *  and given to a later run, which fills in baseline_ratio (seconds over the
+ *  baseline's seconds) for every stage in both, and reports each stage that
+ *  is more than tolerance slower on stderr. Stages that took less than 50 ms
+ *  in the baseline are too noisy to be flagged. The exit status is 1 if any
+ *  stage regressed.
+ *
+ *  Usage: scale-bench [max_accesses] [max_threads] [baseline] [tolerance]
+ *
+ *  max_accesses is 10^7 by default, the full range of 10^9 needs about 160 GB
+ *  of memory and 10 GB of disk for the trace. max_threads is every hardware
+ *  thread by default (or if it is 0), and tolerance is 0.2.
+ */
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "trace_set/TraceSet.hpp"
+#include "trace_set/TraceGenerator.hpp"
+#include "trace_set/MemoryStats.hpp"
+#include "frequent_pairs/FrequentPairs.hpp"
+#include "cluster_parse/ClusterParse.hpp"
+#include "bench/BenchUtil.hpp"
+
+using namespace std;
+
+// Number of hot LBAs that are paired and clustered, as a run of CLUTO would.
+static const size_t TOP_K = 1000;
+
+// Baseline stages faster than this are not flagged.
+static const double MIN_BASELINE_SECONDS = 0.05;
+
+/* Returns the key of a stage in the baseline. */
+static string baseline_key(const string& stage, size_t size, unsigned threads)
+{
+    return stage + "," + to_string(size) + "," + to_string(threads);
+}
+
+/* Reads the seconds of every stage from a previous output of scale-bench,
+ *     the header and any line that does not parse are skipped. */
+static map<string, double> read_baseline(const string& filename)
+{
+    map<string, double> baseline;
+    ifstream in(filename);
+    string line;
+    while (getline(in, line)) {
+        stringstream fields(line);
+        string stage, size, threads, seconds;
+        if (getline(fields, stage, ',') && getline(fields, size, ',') &&
+            getline(fields, threads, ',') && getline(fields, seconds, ',')) {
+            char* end = nullptr;
+            double value = strtod(seconds.c_str(), &end);
+            if (end != seconds.c_str()) {
+                baseline[stage + "," + size + "," + threads] = value;
+            }
+        }
+    }
+    return baseline;
+}
+
+/*
+ * class: StageReporter
+ *
+ * Prints the result lines of one configuration and compares each with the
+ * baseline.
+ */
+class StageReporter {
+public:
+    StageReporter(size_t size, unsigned threads,
+                  const map<string, double>& baseline, double tolerance)
+        : size_(size), threads_(threads), baseline_(baseline),
+          tolerance_(tolerance), regressions_(0) {}
+
+    /* Prints the line of a stage that did ops operations in seconds. */
+    void report(const string& stage, double seconds, size_t ops,
+                const string& unit)
+    {
+        cout << stage << "," << size_ << "," << threads_ << "," << seconds
+             << "," << ops / 1e6 / seconds << "," << unit << ","
+             << MemoryStats::peak_rss_bytes() / 1e6 << ",";
+
+        map<string, double>::const_iterator found =
+            baseline_.find(baseline_key(stage, size_, threads_));
+        if (found != baseline_.end() && found->second > 0) {
+            double ratio = seconds / found->second;
+            cout << ratio;
+            if (ratio > 1 + tolerance_ &&
+                found->second >= MIN_BASELINE_SECONDS) {
+                cerr << "REGRESSION " << stage << " size " << size_
+                     << " threads " << threads_ << ": " << seconds
+                     << " s, baseline " << found->second << " s" << endl;
+                ++regressions_;
+            }
+        }
+        cout << endl;
+    }
+
+    /* Returns the number of stages that regressed. */
+    size_t regressions() const { return regressions_; }
+
+private:
+    size_t size_;
+    unsigned threads_;
+    const map<string, double>& baseline_;
+    double tolerance_;
+    size_t regressions_;
+};
+
+/* Runs the pipeline once on the trace in trace_name, which has size
+ *     accesses, and returns the number of stages that regressed. */
+static size_t run_pipeline(const string& trace_name, const string& tree_name,
+                           size_t size, unsigned threads,
+                           const map<string, double>& baseline,
+                           double tolerance)
+{
+    StageReporter reporter(size, threads, baseline, tolerance);
+    TimePoint pipeline_start = chrono::steady_clock::now();
+
+    TraceSet trace;
+    TimePoint start = chrono::steady_clock::now();
+    trace.readInParallel(trace_name, threads);
+    reporter.report("load", seconds_since(start), size, "Maccesses/s");
+
+    start = chrono::steady_clock::now();
+    vector<size_t> hot = trace.rank_LBAs(TOP_K, threads);
+    reporter.report("rank", seconds_since(start), size, "Maccesses/s");
+
+    // FrequentPairs keeps its own copy of the trace, which is not timed.
+    FrequentPairs pairs;
+    vector<TraceSet::Line>& sequence = trace.get_Sequence();
+    pairs.get_Sequence().reserve(sequence.size());
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        pairs.get_Sequence().push_back(sequence[i].LBA);
+    }
+    for (size_t i = 0; i < hot.size(); ++i) {
+        pairs.insert_Frequent_LBA(to_string(hot[i]));
+    }
+    start = chrono::steady_clock::now();
+    vector<vector<float>> matrix = pairs.fillInFrequentMatrix();
+    reporter.report("pairs", seconds_since(start), size, "Maccesses/s");
+
+    // The canned tree has TOP_K leaves, leaf i stands for hot[i].
+    start = chrono::steady_clock::now();
+    ClusterParse cluster;
+    ifstream tree(tree_name);
+    cluster.readIn(tree, false);
+    vector<size_t> order = cluster.formatOutput(hot);
+    reporter.report("parse", seconds_since(start), 2 * hot.size() - 1,
+                    "Mnodes/s");
+
+    // change_locations shifts the locations of the whole trace and not just
+    // of the TOP_K LBAs it moves, so it is measured per access like the
+    // stages around it.
+    start = chrono::steady_clock::now();
+    trace.change_locations(order, 0);
+    reporter.report("change_locations", seconds_since(start), size,
+                    "Maccesses/s");
+
+    start = chrono::steady_clock::now();
+    size_t distance = trace.total_seek_distance(threads);
+    reporter.report("seek", seconds_since(start), size, "Maccesses/s");
+
+    reporter.report("pipeline", seconds_since(pipeline_start), size,
+                    "Maccesses/s");
+
+    // Keeps the results live so that no stage can be optimized away.
+    cerr << "size " << size << " threads " << threads << " seek distance "
+         << distance << " matrix " << matrix.size() << endl;
+    return reporter.regressions();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t max_accesses = 10000000;
+    unsigned max_threads = thread::hardware_concurrency();
+    string baseline_name;
+    double tolerance = 0.2;
+    if (argc > 1) {
+        max_accesses = strtoull(argv[1], nullptr, 10);
+    }
+    if (argc > 2 && strtoul(argv[2], nullptr, 10) != 0) {
+        max_threads = strtoul(argv[2], nullptr, 10);
+    }
+    if (argc > 3) {
+        baseline_name = argv[3];
+    }
+    if (argc > 4) {
+        tolerance = strtod(argv[4], nullptr);
+    }
+    if (max_threads == 0) {
+        max_threads = 1;
+    }
+
+    map<string, double> baseline;
+    if (!baseline_name.empty()) {
+        baseline = read_baseline(baseline_name);
+        if (baseline.empty()) {
+            cerr << "No baseline read from " << baseline_name << endl;
+        }
+    }
+
+    // 1, 2, 4, ... threads, and max_threads itself if it is not a power of
+    // two.
+    vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    string trace_name = "scale-bench.trace";
+    string tree_name = "scale-bench.tree";
+    write_cluto_tree(tree_name, TOP_K);
+
+    cout << "stage,size,threads,seconds,throughput,unit,peak_rss_MB,"
+         << "baseline_ratio" << endl;
+
+    size_t regressions = 0;
+    for (size_t size = 1000000; size <= max_accesses; size *= 10) {
+        // The LBA space grows with the trace so that it stays dense enough
+        // for a TraceSet that is not dictionary encoded.
+        TraceGenerator::Options options;
+        options.num_accesses = size;
+        options.LBA_space = size;
+        options.hot_set_size = size / 100;
+        options.phase_length = size / 4;
+        TraceGenerator generator(options);
+        if (!generator.write_text(trace_name)) {
+            cerr << "Could not write " << trace_name << endl;
+            return 1;
+        }
+
+        for (size_t t = 0; t < thread_counts.size(); ++t) {
+            unsigned threads = thread_counts[t];
+            pid_t child = fork();
+            if (child == 0) {
+                size_t found = run_pipeline(trace_name, tree_name, size,
+                                            threads, baseline, tolerance);
+                _exit(found == 0 ? 0 : 1);
+            }
+
+            int status = 0;
+            if (child < 0 || waitpid(child, &status, 0) != child) {
+                cerr << "Could not run size " << size << " threads "
+                     << threads << endl;
+                ++regressions;
+            }
+            else if (!WIFEXITED(status)) {
+                cerr << "FAILED size " << size << " threads " << threads
+                     << ", the run was killed (out of memory?)" << endl;
+                ++regressions;
+            }
+            else if (WEXITSTATUS(status) != 0) {
+                ++regressions;
+            }
+        }
+    }
+
+    remove(trace_name.c_str());
+    remove(tree_name.c_str());
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,585 @@
+/*
+ *  tracebench.cpp
+ *
+ *  Author: Jazmin Ortiz
+ *
+ *  Benchmarks for the TraceSet hot paths. Each benchmark prints a single
+ *  comma separated line of the form
+ *
+ *      benchmark,size,seconds,throughput,unit
+ *
+ *  so that runs before and after a change can be compared with diff or
+ *  loaded into a spreadsheet.
+ *
+ *  Usage: trace-bench [num_accesses]
+ */
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "trace_set/TraceSet.hpp"
+#include "trace_set/SeekKernel.hpp"
+#include "trace_set/LocationTree.hpp"
+#include "trace_set/FrequencyRank.hpp"
+#include "trace_set/LayoutOptimizer.hpp"
+#include "trace_set/SeekCost.hpp"
+#include "trace_set/SeekHistogram.hpp"
+#include "trace_set/TraceSnapshot.hpp"
+#include "trace_set/CacheModel.hpp"
+#include "bench/BenchUtil.hpp"
+
+using namespace std;
+
+/* A seek cost behind a virtual call, to compare with the inlined models. */
+class VirtualSeekCost {
+public:
+    virtual ~VirtualSeekCost() {}
+    virtual double operator()(size_t distance) const = 0;
+};
+
+class VirtualLinearSeek : public VirtualSeekCost {
+public:
+    double operator()(size_t distance) const { return LinearSeek()(distance); }
+};
+
+class VirtualSqrtLinearSeek : public VirtualSeekCost {
+public:
+    explicit VirtualSqrtLinearSeek(const SqrtLinearSeek& model) : model_(model) {}
+    double operator()(size_t distance) const { return model_(distance); }
+private:
+    SqrtLinearSeek model_;
+};
+
+/* Prints one result line. */
+static void report(const string& name, size_t size, double seconds,
+                   double throughput, const string& unit)
+{
+    cout << name << "," << size << "," << seconds << "," << throughput
+         << "," << unit << endl;
+}
+
+/* Returns the bytes a seek scan reads per access of sequence when the key of
+ *     each access is key_bytes of a stream and the location of key k is
+ *     location_bytes at offset k * location_bytes of a table: the whole
+ *     stream, plus every 64 byte cache line of the table that holds a
+ *     location the trace reads. */
+static double scan_bytes_per_access(const vector<TraceSet::Line>& sequence,
+                                    size_t key_bytes, size_t location_bytes)
+{
+    const size_t CACHE_LINE = 64;
+    vector<bool> touched;
+    size_t num_lines = 0;
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        size_t line = sequence[i].LBA * location_bytes / CACHE_LINE;
+        if (line >= touched.size()) {
+            touched.resize(line + 1, false);
+        }
+        if (!touched[line]) {
+            touched[line] = true;
+            ++num_lines;
+        }
+    }
+    return static_cast<double>(sequence.size() * key_bytes +
+                               num_lines * CACHE_LINE) /
+           static_cast<double>(sequence.size());
+}
+
+/* Writes a trace of num_accesses LBAs, drawn from a skewed distribution over
+ *     a million LBAs, to the file called filename and returns its size in
+ *     bytes. */
+static size_t write_trace(const string& filename, size_t num_accesses)
+{
+    mt19937_64 generator(2015);
+    ofstream out(filename);
+    for (size_t i = 0; i < num_accesses; ++i) {
+        size_t r = generator() % 1000000;
+        out << (r * r) / 1000000 << "\n";
+    }
+    out.close();
+
+    ifstream in(filename, ios::binary | ios::ate);
+    return static_cast<size_t>(in.tellg());
+}
+
+int main(int argc, char* argv[])
+{
+    size_t num_accesses = 10000000;
+    if (argc > 1) {
+        num_accesses = strtoull(argv[1], nullptr, 10);
+    }
+
+    string filename = "trace-bench.tmp";
+    size_t bytes = write_trace(filename, num_accesses);
+
+    cout << "benchmark,size,seconds,throughput,unit" << endl;
+
+    {
+        TraceSet trace;
+        ifstream in(filename);
+        TimePoint start = chrono::steady_clock::now();
+        trace.readIn(in);
+        double seconds = seconds_since(start);
+        report("readIn", num_accesses, seconds, bytes / 1e6 / seconds, "MB/s");
+    }
+
+    {
+        TraceSet trace;
+        TimePoint start = chrono::steady_clock::now();
+        trace.readInMapped(filename);
+        double seconds = seconds_since(start);
+        report("readInMapped", num_accesses, seconds, bytes / 1e6 / seconds,
+               "MB/s");
+    }
+
+    for (unsigned threads = 2; threads <= thread::hardware_concurrency();
+         threads *= 2) {
+        TraceSet trace;
+        TimePoint start = chrono::steady_clock::now();
+        trace.readInParallel(filename, threads);
+        double seconds = seconds_since(start);
+        report("readInParallel/" + to_string(threads), num_accesses, seconds,
+               bytes / 1e6 / seconds, "MB/s");
+    }
+
+    {
+        // Saving a snapshot of the parsed trace, copying it back into a
+        // TraceSet, and mapping it to score it in place.
+        string snapshot_name = "trace-bench.snap";
+        TraceSet trace;
+        trace.readInMapped(filename);
+        size_t expected = trace.total_seek_distance();
+
+        TimePoint start = chrono::steady_clock::now();
+        trace.save_snapshot(snapshot_name);
+        double seconds = seconds_since(start);
+        TraceSnapshot snapshot;
+        snapshot.open(snapshot_name, false);
+        size_t snapshot_bytes = snapshot.size();
+        snapshot.close();
+        report("snapshot/save", num_accesses, seconds,
+               snapshot_bytes / 1e6 / seconds, "MB/s");
+
+        TraceSet copy;
+        start = chrono::steady_clock::now();
+        copy.readInSnapshot(snapshot_name);
+        seconds = seconds_since(start);
+        report("snapshot/readIn", num_accesses, seconds,
+               snapshot_bytes / 1e6 / seconds, "MB/s");
+
+        start = chrono::steady_clock::now();
+        snapshot.open(snapshot_name, false);
+        size_t mapped_distance = snapshot.total_seek_distance();
+        seconds = seconds_since(start);
+        report("snapshot/openAndScan", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        snapshot.close();
+        remove(snapshot_name.c_str());
+
+        if (mapped_distance != expected ||
+            copy.total_seek_distance() != expected) {
+            cerr << "snapshot seek distances differ: " << mapped_distance
+                 << " " << expected << endl;
+            return 1;
+        }
+    }
+
+    {
+        TraceSet trace;
+        trace.readInMapped(filename);
+
+        // Reference scan over the array of structs, which is how
+        // total_seek_distance used to read the trace.
+        vector<TraceSet::Line>& sequence = trace.get_Sequence();
+        vector<TraceSet::blockLBA>& mapLBA = trace.get_mapLBA();
+        TimePoint start = chrono::steady_clock::now();
+        size_t aos_distance = 0;
+        size_t previous = mapLBA[sequence[0].LBA].location;
+        for (size_t i = 1; i < sequence.size(); ++i) {
+            size_t current = mapLBA[sequence[i].LBA].location;
+            aos_distance += current < previous ? previous - current
+                                               : current - previous;
+            previous = current;
+        }
+        double seconds = seconds_since(start);
+        report("seekScanAoS", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        report("seekScanAoS/bytes", num_accesses, seconds,
+               scan_bytes_per_access(sequence, sizeof(TraceSet::Line),
+                                     sizeof(TraceSet::blockLBA)),
+               "bytes/access");
+
+        // total_seek_distance reads the access_keys_ and key_locations_
+        // columns. The first call warms the cache, time the one after it.
+        size_t soa_distance = trace.total_seek_distance();
+        start = chrono::steady_clock::now();
+        soa_distance = trace.total_seek_distance();
+        seconds = seconds_since(start);
+        report("seekScanSoA", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        report("seekScanSoA/bytes", num_accesses, seconds,
+               scan_bytes_per_access(sequence, sizeof(size_t),
+                                     sizeof(size_t)),
+               "bytes/access");
+
+        // The same columns through each version of the loop
+        vector<size_t> keys(sequence.size());
+        vector<size_t> locations(mapLBA.size());
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            keys[i] = sequence[i].LBA;
+        }
+        for (size_t i = 0; i < mapLBA.size(); ++i) {
+            locations[i] = mapLBA[i].location;
+        }
+
+        start = chrono::steady_clock::now();
+        size_t scalar_distance = SeekKernel::distance_scalar(
+            keys.data(), keys.size(), locations.data());
+        seconds = seconds_since(start);
+        report("seekKernel/scalar", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        bool kernels_agree = scalar_distance == soa_distance;
+
+        if (SeekKernel::has_avx2()) {
+            start = chrono::steady_clock::now();
+            size_t avx2_distance = SeekKernel::distance_avx2(
+                keys.data(), keys.size(), locations.data());
+            seconds = seconds_since(start);
+            report("seekKernel/avx2", num_accesses, seconds,
+                   num_accesses / 1e6 / seconds, "Maccesses/s");
+            kernels_agree = kernels_agree && avx2_distance == soa_distance;
+        }
+
+        if (SeekKernel::has_avx512()) {
+            start = chrono::steady_clock::now();
+            size_t avx512_distance = SeekKernel::distance_avx512(
+                keys.data(), keys.size(), locations.data());
+            seconds = seconds_since(start);
+            report("seekKernel/avx512", num_accesses, seconds,
+                   num_accesses / 1e6 / seconds, "Maccesses/s");
+            kernels_agree = kernels_agree && avx512_distance == soa_distance;
+        }
+
+        for (unsigned threads = 2; threads <= thread::hardware_concurrency();
+             threads *= 2) {
+            start = chrono::steady_clock::now();
+            size_t threaded_distance = trace.total_seek_distance(threads);
+            seconds = seconds_since(start);
+            report("seekScan/" + to_string(threads), num_accesses, seconds,
+                   num_accesses / 1e6 / seconds, "Maccesses/s");
+            kernels_agree = kernels_agree && threaded_distance == soa_distance;
+        }
+
+        start = chrono::steady_clock::now();
+        trace.build_transitions();
+        seconds = seconds_since(start);
+        size_t num_transitions = trace.get_transitions().size();
+        report("buildTransitions", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+
+        // The first large allocation after build_transitions frees its
+        // hashtable pays for merging the freed nodes, so the first call is
+        // not timed.
+        size_t transition_distance = trace.transition_seek_distance();
+        start = chrono::steady_clock::now();
+        transition_distance = trace.transition_seek_distance();
+        seconds = seconds_since(start);
+        report("transitionScore", num_transitions, seconds,
+               num_transitions / 1e6 / seconds, "Mpairs/s");
+        kernels_agree = kernels_agree && transition_distance == soa_distance;
+
+        // Seek time under each cost model, each is its own instantiation of
+        // seek_time. The same curve behind a virtual call is the cost the
+        // templates avoid.
+        start = chrono::steady_clock::now();
+        double linear_time = trace.seek_time(LinearSeek());
+        seconds = seconds_since(start);
+        report("seekTime/linear", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        kernels_agree = kernels_agree &&
+                        linear_time == static_cast<double>(soa_distance);
+
+        SqrtLinearSeek curve(1.0, 0.01, 0.00001, 10000);
+        start = chrono::steady_clock::now();
+        double curve_time = trace.seek_time(curve);
+        seconds = seconds_since(start);
+        report("seekTime/sqrt", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+
+        // The model is picked at run time so the call cannot be resolved
+        // by the compiler.
+        VirtualLinearSeek virtual_linear;
+        VirtualSqrtLinearSeek virtual_curve(curve);
+        const VirtualSeekCost& virtual_cost = argc > 99
+            ? static_cast<const VirtualSeekCost&>(virtual_linear)
+            : static_cast<const VirtualSeekCost&>(virtual_curve);
+        start = chrono::steady_clock::now();
+        double virtual_time = trace.seek_time(
+            [&virtual_cost](size_t distance) { return virtual_cost(distance); });
+        seconds = seconds_since(start);
+        report("seekTime/sqrtVirtual", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        kernels_agree = kernels_agree && virtual_time == curve_time;
+
+        vector<TableSeek::Point> profile;
+        for (size_t distance = 1; distance <= 1000000; distance *= 4) {
+            TableSeek::Point point;
+            point.distance = distance;
+            point.time = curve(distance);
+            profile.push_back(point);
+        }
+        TableSeek table(profile);
+        start = chrono::steady_clock::now();
+        double table_time = trace.seek_time(table);
+        seconds = seconds_since(start);
+        report("seekTime/table", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        kernels_agree = kernels_agree && table_time > 0;
+
+        // The histogram is counted in the same pass as the total
+        start = chrono::steady_clock::now();
+        SeekHistogram histogram;
+        size_t histogram_distance = trace.total_seek_distance(1, &histogram);
+        seconds = seconds_since(start);
+        report("seekHistogram/1", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        kernels_agree = kernels_agree && histogram_distance == soa_distance &&
+                        histogram.total() == soa_distance;
+
+        // Seek distance of every window of 100000 accesses
+        start = chrono::steady_clock::now();
+        vector<TraceSet::Window> windows =
+            trace.window_seek_distance(100000, 0);
+        seconds = seconds_since(start);
+        report("windowSeek/100000", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        size_t window_total = 0;
+        for (size_t w = 0; w < windows.size(); ++w) {
+            window_total += windows[w].total_seek;
+        }
+        kernels_agree = kernels_agree && window_total == soa_distance;
+
+        // Seek distance and service time in one pass, against the two
+        // separate scans it replaces.
+        DiskTiming timing;
+        timing.rotational_latency = 4.17;
+        timing.transfer_per_block = 0.02;
+        start = chrono::steady_clock::now();
+        ServiceEstimate estimate = trace.service_time(curve, timing);
+        seconds = seconds_since(start);
+        report("serviceTime/fused", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        kernels_agree = kernels_agree && estimate.seek_distance == soa_distance;
+
+        start = chrono::steady_clock::now();
+        size_t separate_distance = trace.total_seek_distance();
+        double separate_time = trace.seek_time(curve);
+        seconds = seconds_since(start);
+        report("serviceTime/separate", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        kernels_agree = kernels_agree && separate_distance == soa_distance &&
+                        separate_time > 0;
+
+        // Seek distance behind a buffer cache of 100000 LBAs, a tenth of the
+        // LBAs of the trace, for each policy.
+        LRUCache lru(100000);
+        start = chrono::steady_clock::now();
+        size_t lru_distance = trace.cached_seek_distance(lru);
+        seconds = seconds_since(start);
+        report("cachedSeek/lru", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+
+        ClockCache clock(100000);
+        start = chrono::steady_clock::now();
+        size_t clock_distance = trace.cached_seek_distance(clock);
+        seconds = seconds_since(start);
+        report("cachedSeek/clock", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+
+        ARCCache arc(100000);
+        start = chrono::steady_clock::now();
+        size_t arc_distance = trace.cached_seek_distance(arc);
+        seconds = seconds_since(start);
+        report("cachedSeek/arc", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+        report("cachedSeek/arcHitRate", num_accesses, seconds,
+               static_cast<double>(arc.hits()) / num_accesses, "fraction");
+        kernels_agree = kernels_agree && lru_distance <= soa_distance &&
+                        clock_distance <= soa_distance &&
+                        arc_distance <= soa_distance;
+
+        // Swap pairs of LBAs without committing, each delta only reads the
+        // accesses of the two LBAs.
+        mt19937_64 swaps(2015);
+        size_t num_swaps = 100000;
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < num_swaps; ++i) {
+            trace.seek_delta_swap(swaps() % 1000000, swaps() % 1000000,
+                                  false);
+        }
+        seconds = seconds_since(start);
+        report("seekDeltaSwap", num_swaps, seconds,
+               num_swaps / 1e6 / seconds, "Mswaps/s");
+
+        if (aos_distance != soa_distance || !kernels_agree) {
+            cerr << "seek distances differ: " << aos_distance << " "
+                 << soa_distance << endl;
+            return 1;
+        }
+    }
+
+    {
+        // Counting and ranking every LBA of the trace, the old way sorted
+        // the whole trace.
+        TraceSet trace;
+        trace.readInMapped(filename);
+        vector<size_t> accesses;
+        vector<TraceSet::Line>& sequence = trace.get_Sequence();
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            accesses.push_back(sequence[i].LBA);
+        }
+
+        TimePoint start = chrono::steady_clock::now();
+        vector<size_t> sorted(accesses);
+        sort(sorted.begin(), sorted.end());
+        vector<FrequencyRank::Count> sorted_counts;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            if (sorted_counts.empty() || sorted_counts.back().LBA != sorted[i]) {
+                FrequencyRank::Count counted;
+                counted.LBA = sorted[i];
+                counted.count = 0;
+                sorted_counts.push_back(counted);
+            }
+            ++sorted_counts.back().count;
+        }
+        FrequencyRank::rank(sorted_counts, 0);
+        double seconds = seconds_since(start);
+        report("rankLBAs/sort", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+
+        for (unsigned threads = 1; threads <= thread::hardware_concurrency();
+             threads *= 2) {
+            start = chrono::steady_clock::now();
+            vector<FrequencyRank::Count> counts =
+                FrequencyRank::count(accesses, threads);
+            FrequencyRank::rank(counts, 0);
+            seconds = seconds_since(start);
+            report("rankLBAs/" + to_string(threads), num_accesses, seconds,
+                   num_accesses / 1e6 / seconds, "Maccesses/s");
+
+            if (counts.size() != sorted_counts.size() ||
+                counts.front().LBA != sorted_counts.front().LBA) {
+                cerr << "rankings differ" << endl;
+                return 1;
+            }
+        }
+
+        start = chrono::steady_clock::now();
+        vector<FrequencyRank::Count> top = FrequencyRank::count(accesses, 0);
+        FrequencyRank::rank(top, 1000);
+        seconds = seconds_since(start);
+        report("rankLBAs/top1000", num_accesses, seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+    }
+
+    {
+        // Moves 1000 LBAs of the trace to the front, the old way (shifting
+        // locations_ and fixing every location) and with change_locations.
+        TraceSet old_way;
+        TraceSet new_way;
+        old_way.readInMapped(filename);
+        new_way.readInMapped(filename);
+
+        vector<size_t> hot;
+        vector<TraceSet::Line>& sequence = new_way.get_Sequence();
+        for (size_t i = 0; i < sequence.size() && hot.size() < 1000; ++i) {
+            if (find(hot.begin(), hot.end(), sequence[i].LBA) == hot.end()) {
+                hot.push_back(sequence[i].LBA);
+            }
+        }
+
+        TimePoint start = chrono::steady_clock::now();
+        old_way.remove_LBA_locations(hot);
+        vector<TraceSet::LBA_location> moved(hot.size());
+        for (size_t i = 0; i < hot.size(); ++i) {
+            moved[i].LBA = hot[i];
+            moved[i].used = true;
+        }
+        vector<TraceSet::LBA_location>& locations = old_way.get_locations();
+        locations.insert(locations.begin(), moved.begin(), moved.end());
+        old_way.fix_locations();
+        double seconds = seconds_since(start);
+        report("changeLocations/shift", hot.size(), seconds,
+               locations.size() / 1e6 / seconds, "Mlocations/s");
+
+        start = chrono::steady_clock::now();
+        new_way.change_locations(hot, 0);
+        seconds = seconds_since(start);
+        report("changeLocations/tree", hot.size(), seconds,
+               locations.size() / 1e6 / seconds, "Mlocations/s");
+
+        // Moving without writing the vectors back
+        LocationTree tree(new_way.get_locations(), new_way.get_mapLBA());
+        start = chrono::steady_clock::now();
+        tree.move_to(hot, 500);
+        seconds = seconds_since(start);
+        report("locationTree/move", hot.size(), seconds,
+               hot.size() / 1e6 / seconds, "MLBAs/s");
+
+        if (old_way.total_seek_distance() != new_way.total_seek_distance()) {
+            cerr << "change_locations differs" << endl;
+            return 1;
+        }
+
+        // Moving 8 of the LBAs now at the front back and forth by 100
+        // locations, which only writes back the slots in between.
+        size_t num_near = min<size_t>(8, hot.size());
+        vector<size_t> near(hot.begin(), hot.begin() + num_near);
+        const size_t num_moves = 1000;
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < num_moves; ++i) {
+            new_way.change_locations(near, i % 2 == 0 ? 100 : 0);
+        }
+        seconds = seconds_since(start);
+        report("changeLocations/near", num_moves, seconds,
+               num_moves / 1e6 / seconds, "Mcalls/s");
+    }
+
+    {
+        // Annealing the order of the 1000 most accessed LBAs, each step is
+        // scored by its change in seek distance.
+        TraceSet trace;
+        trace.readInMapped(filename);
+        vector<size_t> hot = trace.rank_LBAs(1000, 0);
+
+        TimePoint start = chrono::steady_clock::now();
+        LayoutOptimizer optimizer(trace, hot, 0);
+        double seconds = seconds_since(start);
+        report("layoutOptimizer/build", hot.size(), seconds,
+               num_accesses / 1e6 / seconds, "Maccesses/s");
+
+        LayoutOptimizer::Options options;
+        options.iterations = 200000;
+        start = chrono::steady_clock::now();
+        optimizer.optimize(options);
+        seconds = seconds_since(start);
+        report("layoutOptimizer/anneal", options.iterations, seconds,
+               optimizer.proposed() / 1e6 / seconds, "Msteps/s");
+
+        if (optimizer.best_seek_distance() > optimizer.initial_seek_distance()) {
+            cerr << "annealing made the layout worse" << endl;
+            return 1;
+        }
+    }
+
+    remove(filename.c_str());
+
+    return 0;
+}
@@ -191,6 +191,14 @@ size_t ClusterParse::getRoot(){
     return numNodes_; 
 }
 
+/*  Returns the bytes held by the vector of nodes. */
+vector<MemoryStats::Container> ClusterParse::memory_usage() const{
+    vector<MemoryStats::Container> containers = {
+        {"clusterTree_", MemoryStats::vector_bytes(clusterTree_)}
+    };
+    return containers;
+}
+
 /*  Inserts a node, based on the line read in from a cluto output record.
  *     NOTE:  Should check for a valid parent value before it is added. */
 void ClusterParse::insert(size_t child, size_t parent){ 
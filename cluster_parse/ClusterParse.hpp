@@ -33,6 +33,8 @@
 #include <string>
 #include <vector>
 
+#include "../trace_set/MemoryStats.hpp"
+
 class ClusterParse{
 
 public:
@@ -91,6 +93,9 @@ public:
     /* Returns the root of the tree. */ 
     std::size_t getRoot(); 
 
+    /* Returns the bytes held by clusterTree_. */
+    std::vector<MemoryStats::Container> memory_usage() const;
+
 ///Printing and I/O functions///
 
     /* Uses the helper functions above to appropriately insert
@@ -607,6 +607,16 @@ TEST(formatfunctions, small)
 
 
 
+/* Checks that memory_usage counts the vector of nodes. */
+TEST(memory_usage, clusterTree){
+    ClusterParse test = balancedTree();
+    vector<MemoryStats::Container> containers = test.memory_usage();
+    assert(containers.size() == 1);
+    assert(containers[0].bytes >= (test.getRoot() + 1) *
+                                   sizeof(ClusterParse::Node));
+    assert(MemoryStats::total(containers) == containers[0].bytes);
+}
+
 //--------------------------------------------------
 //           RUNNING THE TESTS
 //--------------------------------------------------
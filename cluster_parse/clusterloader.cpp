@@ -15,6 +15,7 @@
 #include <fstream>
 
 #include "ClusterParse.hpp"
+#include "../trace_set/MemoryStats.hpp"
 
 using namespace std;
 
@@ -47,8 +48,13 @@ int main()
 
     // Reads in the user input file.
     cluster.readIn(clutoFile, false); 
+
+    // Prints the memory held by the tree on stderr.
+    MemoryStats::print(cerr, cluster.memory_usage());
   }
 
+  MemoryStats::print(cerr);
+
   return 0;
   
 }
@@ -13,6 +13,7 @@
 #include <unordered_map>
 
 #include "FrequentPairs.hpp"
+#include "../trace_set/BinaryTrace.hpp"
 
 using namespace std;
 
@@ -67,6 +68,25 @@ vector<size_t>& FrequentPairs::get_FrequentLBAs()
 
 }
 
+/**
+ * function: memory_usage()
+ *
+ * FrequentLBAsTable_ is counted as its array of buckets and its nodes.
+ */
+vector<MemoryStats::Container> FrequentPairs::memory_usage() const
+{
+  vector<MemoryStats::Container> containers = {
+    {"Sequence_", MemoryStats::vector_bytes(Sequence_)},
+    {"FrequentLBAsTable_ buckets",
+     MemoryStats::bucket_bytes(FrequentLBAsTable_)},
+    {"FrequentLBAsTable_ nodes", MemoryStats::node_bytes(FrequentLBAsTable_)},
+    {"FrequentLBAs_", MemoryStats::vector_bytes(FrequentLBAs_)}
+  };
+
+  return containers;
+
+}
+
 /**
  * function: readInSequence(ifstream& inputstream)
  *
@@ -107,6 +127,30 @@ void FrequentPairs::readInSequence(fstream& inputstream)
   inputstream.close();
 }
 
+/**
+ * function: readInBinarySequence(string filename)
+ *
+ * Maps a binary trace file and appends every LBA it decodes to the
+ * Sequence_ data member, using the access count in the header to allocate
+ * Sequence_ once.
+ */
+bool FrequentPairs::readInBinarySequence(string filename)
+{
+
+  BinaryTrace trace;
+
+  if (!trace.open(filename)) {
+
+    return false;
+
+  }
+
+  Sequence_.reserve(Sequence_.size() + trace.header().num_accesses);
+
+  return trace.for_each_LBA([this](size_t LBA) { Sequence_.push_back(LBA); });
+
+}
+
 /**
  * function: ReadInFrequentLBAs(std::ifstream& inputstream)
  *
@@ -172,7 +216,7 @@ void FrequentPairs::readInFrequentLBAs(fstream& inputstream)
 void FrequentPairs::createAsciiMatrix(string matrix_file_to_load)
 {
 
-  vector< vector<size_t> > adjacency_matrix = fillInFrequentMatrix();
+  vector< vector<float> > adjacency_matrix = fillInFrequentMatrix();
 
   // The total number of LBAs which can be seen as the size of the
   // first row of the matrix since this is an n by n matrix of LBAs.
@@ -211,18 +255,16 @@ void FrequentPairs::createAsciiMatrix(string matrix_file_to_load)
 void FrequentPairs::createMappingFile(string LBA_mapping_file)
 {
 
-  size_t num_LBAs = FrequentLBAs.size();
+  size_t num_LBAs = FrequentLBAs_.size();
 
   fstream mapping_file(LBA_mapping_file);
 
   for (size_t i = 0; i < num_LBAs; ++i) {
 
-    mapping_file << FrequentLBAs_[i] << endl;;
+    mapping_file << FrequentLBAs_[i] << endl;
 
     }
 
-  return mapping_file
-
 }
 
 /**
@@ -243,14 +285,14 @@ void FrequentPairs::createMappingFile(string LBA_mapping_file)
  * pair in the adjacency matrix.
  *
  */
-vector< vector<size_t> > FrequentPairs::fillInFrequentMatrix()
+vector< vector<float> > FrequentPairs::fillInFrequentMatrix()
 {
 
   // The matrix will be an n by n matrix where n is the number of LBAs in
   // FrequentLBAs_, so here we create a varaiable which is the number of LBAs.
   size_t num_LBAs = FrequentLBAs_.size();
 
-  vector< vector<size_t> > adjacency_matrix(num_LBAs, vector<float>(num_LBAs));
+  vector< vector<float> > adjacency_matrix(num_LBAs, vector<float>(num_LBAs));
 
   // Loop through and set all size_ts to 0 in adjacency matrix so that we
   // can later increment these values to reflect the number of times frequent
@@ -17,6 +17,8 @@
 #include <fstream>
 #include <string>
 
+#include "../trace_set/MemoryStats.hpp"
+
 class FrequentPairs{
 
 public:
@@ -52,6 +54,14 @@ public:
    */
   std::vector<size_t>& get_FrequentLBAs();
 
+  /**
+   * function: memory_usage()
+   *
+   * Returns the bytes held by Sequence_, the buckets and nodes of
+   * FrequentLBAsTable_ and FrequentLBAs_.
+   */
+  std::vector<MemoryStats::Container> memory_usage() const;
+
   /**
    * function: readInSequence(std::ifstream& inputstream)
    *
@@ -61,6 +71,16 @@ public:
    */
   void readInSequence(std::fstream& inputstream);
 
+  /**
+   * function: readInBinarySequence(string filename)
+   *
+   * Reads in a binary trace file written by trace-convert (see
+   * trace_set/BinaryTrace.hpp) and appends each LBA in it to the Sequence_
+   * data member without any text parsing. Returns false if the file is not a
+   * binary trace or is corrupt.
+   */
+  bool readInBinarySequence(std::string filename);
+
   /**
    * function: ReadInFrequentLBAs(ifstream& inputstream)
    *
@@ -7,9 +7,11 @@
  */
 
 #include "FrequentPairs.hpp"
+#include "../trace_set/BinaryTrace.hpp"
 #include "gtest/gtest.h"
 
 #include <memory>
+#include <cstdio>
 
 using namespace std;
 
@@ -566,6 +568,38 @@ TEST(readInSequence, small_backward)
     }
 }
 
+TEST(readInBinarySequence, matches_readInSequence)
+{
+
+    FrequentPairs expected;
+    fstream sequence;
+
+    sequence.open("gtest_smallSequence2.txt");
+    expected.readInSequence(sequence);
+
+    // Write the same sequence as a binary trace
+    vector<size_t>& expected_sequence = expected.get_Sequence();
+    string fileName = "gtest_binarySequence.bin";
+    BinaryTraceWriter writer(fileName);
+    for (size_t i = 0; i < expected_sequence.size(); ++i) {
+        writer.append(expected_sequence[i]);
+    }
+    bool closed = writer.close();
+    assert(closed);
+
+    FrequentPairs test;
+    bool loaded = test.readInBinarySequence(fileName);
+    remove(fileName.c_str());
+    assert(loaded);
+
+    vector<size_t>& test_sequence = test.get_Sequence();
+    assert(test_sequence == expected_sequence);
+
+    // A text file is not a binary trace
+    loaded = test.readInBinarySequence("gtest_smallSequence1.txt");
+    assert(!loaded);
+}
+
 TEST(readFrequentLBAs, small_backwards)
 {
 
@@ -611,6 +645,26 @@ TEST(createAsciiMatrix, small)
 }
 */
 
+TEST(memory_usage, counts_containers)
+{
+    FrequentPairs test;
+    vector<size_t>& sequence = test.get_Sequence();
+    for (size_t i = 0; i < 100; ++i) {
+        sequence.push_back(i);
+    }
+    for (size_t i = 0; i < 10; ++i) {
+        test.insert_Frequent_LBA(to_string(i * 3));
+    }
+
+    vector<MemoryStats::Container> containers = test.memory_usage();
+    assert(containers.size() == 4);
+    assert(containers[0].bytes == sequence.capacity() * sizeof(size_t));
+    assert(containers[1].bytes ==
+           test.get_FrequentLBAsTable().bucket_count() * sizeof(void*));
+    assert(containers[2].bytes >= 10 * 2 * sizeof(size_t));
+    assert(containers[3].bytes >= 10 * sizeof(size_t));
+}
+
 //--------------------------------------------------
 //           RUNNING THE TESTS
 //--------------------------------------------------
@@ -12,6 +12,8 @@
 
 
 #include "FrequentPairs.hpp"
+#include "../trace_set/BinaryTrace.hpp"
+#include "../trace_set/MemoryStats.hpp"
 
 using namespace std;
 
@@ -77,13 +79,29 @@ int main()
 
     FrequentPairs frequentpairs;
 
-    frequentpairs.readInSequence(tracefile);
+    // Binary traces written by trace-convert are loaded without parsing
+    // any text.
+    if (BinaryTrace::is_binary_trace(file_to_load)) {
+
+      frequentpairs.readInBinarySequence(file_to_load);
+
+    } else {
+
+      frequentpairs.readInSequence(tracefile);
+
+    }
+
     frequentpairs.readInFrequentLBAs(frequentLBAs);
 
     frequentpairs.createAsciiMatrix(adjacency_matrix_file);
 
+    // Prints the memory held by each data member on stderr.
+    MemoryStats::print(cerr, frequentpairs.memory_usage());
+
   }
 
+  MemoryStats::print(cerr);
+
   return 0;
 
 }
@@ -7,11 +7,18 @@
  */
 
 #include <string>
+#include <cstring>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include "cluster_parse/ClusterParse.hpp"
 #include "trace_set/TraceSet.hpp"
+#include "trace_set/BinaryTrace.hpp"
+#include "trace_set/PlacementStrategy.hpp"
+#include "trace_set/LayoutOptimizer.hpp"
+#include "trace_set/MemoryStats.hpp"
 
 using namespace std;
 
@@ -20,6 +27,8 @@ int main( int argc, char *argv[]){
     string clutoName; 
     string traceName; 
     bool initialDistance = false; 
+    bool compareStrategies = false; 
+    double annealSeconds = 0; 
     for (int i = 1; i < argc; ++i){
         if (i + 1 != argc){
             cout << argv[i] << endl; 
@@ -39,6 +48,13 @@ int main( int argc, char *argv[]){
                 initialDistance = true; 
                 cout << "set initialDistance to " << endl; 
             }
+            if (!strcmp(argv[i], "-a")){
+                annealSeconds = atof(argv[i + 1]); 
+                cout << "set annealSeconds to " << annealSeconds << endl; 
+            }
+        }
+        if (!strcmp(argv[i], "-s")){
+            compareStrategies = true; 
         }
     }
     ifstream clutoFile(clutoName);
@@ -62,16 +78,64 @@ int main( int argc, char *argv[]){
          *      that we request/require/desire, we move on and create
          *     a TraceSet. */ 
         TraceSet trace; 
-        /* We read in our trace file. */ 
-        trace.readIn(traceFile); 
+        /* We read in our trace file, binary traces written by trace-convert
+         *     are loaded without parsing any text. */ 
+        if (BinaryTrace::is_binary_trace(traceName)){
+            trace.readInBinary(traceName); 
+        }
+        else{
+            trace.readIn(traceFile); 
+        }
         if(initialDistance){
             cout << "total initial seek distance is: " << 
                          trace.total_seek_distance() << endl; 
         }
-        //We change the locations within the tracefile. 
-        trace.change_locations(LBAList, 0);
-        cout << "total seek distance is: " << trace.total_seek_distance() << endl;
+        /* With -a the cluster order is improved by simulated annealing
+         *     for the given number of seconds on every core before it is 
+         *     used. */ 
+        if (annealSeconds > 0){
+            LayoutOptimizer optimizer(trace, LBAList, 0); 
+            LayoutOptimizer::Options options; 
+            options.iterations = 0; 
+            options.seconds = annealSeconds; 
+            LBAList = optimizer.optimize(options); 
+            cout << "annealed seek distance from " 
+                 << optimizer.initial_seek_distance() << " to " 
+                 << optimizer.best_seek_distance() << endl; 
+        }
+        /* With -s the cluster order is compared with the other placement
+         *     strategies, each given as many hot LBAs as the cluster tree 
+         *     has leaves, and the seek distance of each is printed as 
+         *     strategy,seek_distance without changing the trace. */ 
+        if (compareStrategies){
+            PlacementStats stats = 
+                PlacementStrategy::collect(trace, LBAList.size(), 0); 
+            ClusterPlacement cluster_order(LBAList); 
+            FrequencyPlacement frequency; 
+            OrganPipePlacement organ_pipe; 
+            vector<const PlacementStrategy*> strategies; 
+            strategies.push_back(&cluster_order); 
+            strategies.push_back(&frequency); 
+            strategies.push_back(&organ_pipe); 
+
+            cout << "strategy,seek_distance" << endl; 
+            for (size_t i = 0; i < strategies.size(); ++i){
+                vector<size_t> placed = strategies[i]->place(stats); 
+                vector<size_t> whole(1, placed.size()); 
+                cout << strategies[i]->name() << "," 
+                     << trace.sweep_seek_distance(placed, whole, 0)[0] << endl; 
+            }
+        }
+        else{
+            //We change the locations within the tracefile. 
+            trace.change_locations(LBAList, 0);
+            cout << "total seek distance is: " << trace.total_seek_distance() << endl;
+        }
+        /* The memory held by the tree and the trace goes to stderr. */ 
+        MemoryStats::print(cerr, cluster.memory_usage()); 
+        MemoryStats::print(cerr, trace.memory_usage()); 
     }
+    MemoryStats::print(cerr); 
     return 0; 
 }
 
@@ -0,0 +1,213 @@
+/*
+* BinaryTrace.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the BinaryTrace and BinaryTraceWriter classes, which read
+* and write the compact binary version of a trace file.
+*
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "BinaryTrace.hpp"
+
+using namespace std;
+
+// The first four bytes of every binary trace file
+static const char MAGIC[4] = {'L', 'B', 'A', 'T'};
+
+// Number of encoded bytes that BinaryTraceWriter collects before writing
+static const size_t BUFFER_SIZE = 1 << 20;
+
+// Definition for the static data member
+const uint32_t BinaryTrace::VERSION;
+
+// Default constructor for BinaryTrace
+BinaryTrace::BinaryTrace()
+{
+  memset(&header_, 0, sizeof(header_));
+}
+
+/**
+ * function: open(const string& filename)
+ *
+ * Maps the file and copies its header, rejecting files that are too small to
+ * hold a header, do not start with the magic bytes or were written with a
+ * different version of the format.
+ */
+bool BinaryTrace::open(const string& filename)
+{
+  memset(&header_, 0, sizeof(header_));
+
+  if (!file_.open(filename) || file_.size() < sizeof(Header)) {
+    file_.close();
+    return false;
+  }
+
+  memcpy(&header_, file_.begin(), sizeof(Header));
+
+  if (memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header_.version != VERSION) {
+    memset(&header_, 0, sizeof(header_));
+    file_.close();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * function: header()
+ *
+ * Returns the header of the mapped file.
+ */
+const BinaryTrace::Header& BinaryTrace::header() const
+{
+  return header_;
+}
+
+/**
+ * function: size()
+ *
+ * Returns the number of bytes in the mapped file.
+ */
+size_t BinaryTrace::size() const
+{
+  return file_.size();
+}
+
+/**
+ * function: is_binary_trace(const string& filename)
+ *
+ * Reads the first four bytes of the file and compares them to the magic bytes.
+ */
+bool BinaryTrace::is_binary_trace(const string& filename)
+{
+  ifstream in(filename, ios::binary);
+  char magic[4];
+
+  if (!in.read(magic, sizeof(magic))) {
+    return false;
+  }
+
+  return memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Constructor for BinaryTraceWriter which counts the distinct LBAs
+BinaryTraceWriter::BinaryTraceWriter(const string& filename):
+  BinaryTraceWriter(filename, true)
+{
+  // Do nothing here
+}
+
+// Constructor for BinaryTraceWriter, a zeroed header is written as a
+// placeholder and is overwritten by close().
+BinaryTraceWriter::BinaryTraceWriter(const string& filename,
+                                     bool count_unique):
+  out_{filename, ios::binary | ios::trunc},
+  previous_{0},
+  count_unique_{count_unique}
+{
+  memset(&header_, 0, sizeof(header_));
+  memcpy(header_.magic, MAGIC, sizeof(MAGIC));
+  header_.version = BinaryTrace::VERSION;
+
+  buffer_.reserve(BUFFER_SIZE + 16);
+
+  out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+}
+
+// Destructor for BinaryTraceWriter
+BinaryTraceWriter::~BinaryTraceWriter()
+{
+  close();
+}
+
+/**
+ * function: is_open()
+ *
+ * Returns true if the output file is open.
+ */
+bool BinaryTraceWriter::is_open() const
+{
+  return out_.is_open();
+}
+
+/**
+ * function: append(size_t LBA)
+ *
+ * Zigzag encodes the difference between LBA and the previous LBA, adds it to
+ * the buffer as a varint and updates the header.
+ */
+void BinaryTraceWriter::append(size_t LBA)
+{
+  uint64_t difference = static_cast<uint64_t>(LBA) -
+                        static_cast<uint64_t>(previous_);
+  uint64_t encoded = (difference << 1) ^
+                     static_cast<uint64_t>(static_cast<int64_t>(difference) >> 63);
+
+  while (encoded >= 0x80) {
+    buffer_.push_back(static_cast<unsigned char>(encoded | 0x80));
+    encoded >>= 7;
+  }
+  buffer_.push_back(static_cast<unsigned char>(encoded));
+
+  if (buffer_.size() >= BUFFER_SIZE) {
+    out_.write(reinterpret_cast<const char*>(buffer_.data()),
+               static_cast<streamsize>(buffer_.size()));
+    buffer_.clear();
+  }
+
+  ++header_.num_accesses;
+  if (LBA > header_.max_LBA) {
+    header_.max_LBA = LBA;
+  }
+  if (count_unique_ && seen_.insert(LBA).second) {
+    ++header_.unique_LBAs;
+  }
+
+  previous_ = LBA;
+}
+
+/**
+ * function: close()
+ *
+ * Flushes the buffer, then seeks back to the start of the file to replace the
+ * placeholder header with the final one.
+ */
+bool BinaryTraceWriter::close()
+{
+  if (!out_.is_open()) {
+    return true;
+  }
+
+  out_.write(reinterpret_cast<const char*>(buffer_.data()),
+             static_cast<streamsize>(buffer_.size()));
+  buffer_.clear();
+
+  out_.seekp(0);
+  out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+
+  bool succeeded = static_cast<bool>(out_);
+  out_.close();
+
+  seen_.clear();
+
+  return succeeded;
+}
+
+/**
+ * function: header()
+ *
+ * Returns the header for the accesses appended so far.
+ */
+const BinaryTrace::Header& BinaryTraceWriter::header() const
+{
+  return header_;
+}
@@ -0,0 +1,209 @@
+/**
+* BinaryTrace.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This file contains two small classes for a compact binary version of the one
+* LBA per line text traces, so that repeated experiments on the same trace do
+* not have to parse decimal text every time:
+*
+* (1) BinaryTraceWriter, which is given the LBAs of a trace one at a time and
+* writes them to a binary trace file.
+*
+* (2) BinaryTrace, which memory maps a binary trace file and decodes the LBAs
+* in it in order.
+*
+* A binary trace file starts with a fixed size Header that holds the number of
+* accesses in the trace, the largest LBA in the trace and the number of
+* distinct LBAs in the trace. The header is followed by one entry per access,
+* each entry is the difference between that LBA and the LBA before it (the
+* first is the difference from 0), zigzag encoded so that small negative
+* differences are small numbers, and written as a varint of 7 bits per byte
+* with the high bit set on every byte but the last. Consecutive accesses
+* usually land near one another, so most entries take one to three bytes.
+*
+* NOTE: The header is written in the byte order of the machine that wrote the
+* file, binary traces should be converted on the machine that uses them.
+*
+*/
+
+#ifndef BINARYTRACE_HPP_INCLUDED
+#define BINARYTRACE_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "MappedTrace.hpp"
+
+class BinaryTrace{
+
+public:
+
+  /// The version of the format written by BinaryTraceWriter, a file with a
+  /// different version is rejected by open().
+  static const std::uint32_t VERSION = 1;
+
+  /// The most bytes an entry can take, a varint of 7 bits per byte holds a
+  /// 64 bit difference in 10 bytes. Longer entries are rejected as corrupt.
+  static const unsigned MAX_VARINT_BYTES = 10;
+
+  /*
+   * struct: Header
+   *
+   * The fixed size header at the start of every binary trace file.
+   */
+  struct Header {
+
+    char magic[4];                // Always "LBAT"
+
+    std::uint32_t version;        // The version of the format, see VERSION
+
+    std::uint64_t num_accesses;   // Number of accesses in the trace
+
+    std::uint64_t max_LBA;        // Largest LBA in the trace
+
+    std::uint64_t unique_LBAs;    // Number of distinct LBAs in the trace, 0
+                                  // if the writer did not count them
+
+  };
+
+  ///<Constructor creates a BinaryTrace which has no file mapped.
+  BinaryTrace();
+
+  /// Maps the binary trace file called filename and reads its header. Returns
+  /// false if the file could not be mapped or is not a binary trace of the
+  /// current version.
+  bool open(const std::string& filename);
+
+  /// Returns the header of the mapped file.
+  const Header& header() const;
+
+  /// Returns the size of the mapped file in bytes.
+  std::size_t size() const;
+
+  /// Calls callback(LBA) for every access in the trace in order. Returns
+  /// false if the file is corrupt, that is if it ends in the middle of an
+  /// entry, before the number of accesses in the header, or has an entry
+  /// longer than MAX_VARINT_BYTES or too large for 64 bits, in which case
+  /// callback has only been called for the accesses before that entry.
+  template <typename Callback>
+  bool for_each_LBA(Callback callback) const;
+
+  /// Returns true if the file called filename starts with the magic bytes of
+  /// a binary trace, this is used by the loaders to decide whether a trace
+  /// file is text or binary.
+  static bool is_binary_trace(const std::string& filename);
+
+private:
+
+  MappedTrace file_;          // The mapped binary trace file.
+
+  Header header_;             // Copy of the header at the start of file_.
+
+};
+
+class BinaryTraceWriter{
+
+public:
+
+  ///<Constructor which creates (or truncates) the file called filename,
+  ///<is_open() can be used to check if this succeeded.
+  explicit BinaryTraceWriter(const std::string& filename);
+
+  ///<Constructor which does the same, but only counts the distinct LBAs for
+  ///<the header if count_unique is true. Counting keeps every distinct LBA in
+  ///<a hashtable, which is too large for traces generated with billions of
+  ///<accesses.
+  BinaryTraceWriter(const std::string& filename, bool count_unique);
+
+  ///<Destructor, finishes the file if close() has not been called.
+  ~BinaryTraceWriter();
+
+  /// Returns true if the output file is open.
+  bool is_open() const;
+
+  /// Adds the next access of the trace to the file.
+  void append(std::size_t LBA);
+
+  /// Writes the remaining buffered entries and the final header, and closes
+  /// the file. Returns false if any write failed.
+  bool close();
+
+  /// Returns the header that describes the accesses appended so far.
+  const BinaryTrace::Header& header() const;
+
+private:
+
+  // A BinaryTraceWriter owns its file, so it cannot be copied.
+  BinaryTraceWriter(const BinaryTraceWriter&);
+  BinaryTraceWriter& operator=(const BinaryTraceWriter&);
+
+  std::ofstream out_;                     // The binary trace file
+
+  BinaryTrace::Header header_;            // Header that is being filled in
+
+  std::size_t previous_;                  // The last LBA that was appended
+
+  bool count_unique_;                     // True if unique_LBAs is counted
+
+  std::unordered_set<std::size_t> seen_;  // Every distinct LBA appended, used
+                                          // to fill in unique_LBAs
+
+  std::vector<unsigned char> buffer_;     // Encoded entries not yet written
+
+};
+
+/**
+ * function: for_each_LBA(Callback callback)
+ *
+ * Decodes the varint after the header one entry at a time, undoes the zigzag
+ * encoding and adds the difference to the previous LBA. Decoding stops early
+ * if the file ends in the middle of an entry, or if an entry does not end
+ * within MAX_VARINT_BYTES, so that the shift never reaches 64 bits. The last
+ * byte of a full length entry holds only the top bit of the value.
+ */
+template <typename Callback>
+bool BinaryTrace::for_each_LBA(Callback callback) const
+{
+  if (file_.size() < sizeof(Header)) {
+    return false;
+  }
+
+  const unsigned char* scan =
+      reinterpret_cast<const unsigned char*>(file_.begin()) + sizeof(Header);
+  const unsigned char* end =
+      reinterpret_cast<const unsigned char*>(file_.end());
+
+  std::uint64_t LBA = 0;
+  for (std::uint64_t i = 0; i < header_.num_accesses; ++i) {
+
+    std::uint64_t encoded = 0;
+    unsigned shift = 0;
+    unsigned char byte;
+    do {
+      if (scan == end || shift >= 7 * MAX_VARINT_BYTES) {
+        return false;
+      }
+      byte = *scan++;
+      if (shift == 7 * (MAX_VARINT_BYTES - 1) && (byte & 0x7e) != 0) {
+        return false;
+      }
+      encoded |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+
+    // Undo the zigzag encoding, the arithmetic wraps around just as it did
+    // when the difference was taken.
+    LBA += (encoded >> 1) ^ (~(encoded & 1) + 1);
+
+    callback(static_cast<std::size_t>(LBA));
+  }
+
+  return true;
+}
+
+#endif // BINARYTRACE_HPP_INCLUDED
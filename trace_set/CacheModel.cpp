@@ -0,0 +1,267 @@
+/*
+* CacheModel.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of CacheSlots and of the parts of the cache models that are
+* not on the path of every access.
+*
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CacheModel.hpp"
+#include "MemoryStats.hpp"
+
+using namespace std;
+
+// Definitions for the static data members
+const uint32_t CacheSlots::NONE;
+const size_t LRUCache::MAX_CAPACITY;
+
+/*
+ * function: clamp_capacity(size_t capacity)
+ */
+static size_t clamp_capacity(size_t capacity)
+{
+  return capacity < LRUCache::MAX_CAPACITY ? capacity
+                                           : LRUCache::MAX_CAPACITY;
+}
+
+// Constructor for CacheSlots
+CacheSlots::CacheSlots():
+  free_{NONE}
+{
+  // Do nothing here
+}
+
+/**
+ * function: reset(size_t num_lists, size_t num_slots, size_t num_keys)
+ *
+ * The slots of the entries are chained into the free list in order, and the
+ * head of every list points at itself.
+ */
+void CacheSlots::reset(size_t num_lists, size_t num_slots, size_t num_keys)
+{
+  slots_.assign(num_lists + num_slots, Slot());
+  for (size_t i = 0; i < num_lists; ++i) {
+    slots_[i].prev = static_cast<uint32_t>(i);
+    slots_[i].next = static_cast<uint32_t>(i);
+    slots_[i].list = static_cast<uint32_t>(i);
+  }
+  for (size_t i = num_lists; i < slots_.size(); ++i) {
+    slots_[i].next = i + 1 < slots_.size() ? static_cast<uint32_t>(i + 1)
+                                           : NONE;
+  }
+  free_ = num_slots == 0 ? NONE : static_cast<uint32_t>(num_lists);
+
+  lengths_.assign(num_lists, 0);
+  slot_of_key_.assign(num_keys, NONE);
+}
+
+/**
+ * function: memory_usage()
+ */
+size_t CacheSlots::memory_usage() const
+{
+  return MemoryStats::vector_bytes(slots_) +
+         MemoryStats::vector_bytes(lengths_) +
+         MemoryStats::vector_bytes(slot_of_key_);
+}
+
+// Constructor for LRUCache
+LRUCache::LRUCache(size_t capacity):
+  capacity_{clamp_capacity(capacity)}
+{
+  clear(0);
+}
+
+/**
+ * function: clear(size_t num_keys)
+ */
+void LRUCache::clear(size_t num_keys)
+{
+  slots_.reset(1, capacity_, num_keys);
+  hits_ = 0;
+  misses_ = 0;
+}
+
+/**
+ * function: capacity()
+ */
+size_t LRUCache::capacity() const
+{
+  return capacity_;
+}
+
+/**
+ * function: hits()
+ */
+size_t LRUCache::hits() const
+{
+  return hits_;
+}
+
+/**
+ * function: misses()
+ */
+size_t LRUCache::misses() const
+{
+  return misses_;
+}
+
+/**
+ * function: memory_usage()
+ */
+size_t LRUCache::memory_usage() const
+{
+  return slots_.memory_usage();
+}
+
+// Constructor for ClockCache
+ClockCache::ClockCache(size_t capacity):
+  capacity_{clamp_capacity(capacity)}
+{
+  clear(0);
+}
+
+/**
+ * function: clear(size_t num_keys)
+ *
+ * The frames are filled in order as keys come in, so only the room for them
+ * is reserved here.
+ */
+void ClockCache::clear(size_t num_keys)
+{
+  keys_.clear();
+  keys_.reserve(capacity_);
+  referenced_.clear();
+  referenced_.reserve(capacity_);
+  frame_of_key_.assign(num_keys, CacheSlots::NONE);
+  hand_ = 0;
+  hits_ = 0;
+  misses_ = 0;
+}
+
+/**
+ * function: capacity()
+ */
+size_t ClockCache::capacity() const
+{
+  return capacity_;
+}
+
+/**
+ * function: hits()
+ */
+size_t ClockCache::hits() const
+{
+  return hits_;
+}
+
+/**
+ * function: misses()
+ */
+size_t ClockCache::misses() const
+{
+  return misses_;
+}
+
+/**
+ * function: memory_usage()
+ */
+size_t ClockCache::memory_usage() const
+{
+  return MemoryStats::vector_bytes(keys_) +
+         MemoryStats::vector_bytes(referenced_) +
+         MemoryStats::vector_bytes(frame_of_key_);
+}
+
+// Constructor for ARCCache
+ARCCache::ARCCache(size_t capacity):
+  capacity_{clamp_capacity(capacity)}
+{
+  clear(0);
+}
+
+/**
+ * function: clear(size_t num_keys)
+ *
+ * T1 and T2 hold at most capacity keys between them, and so do B1 and B2.
+ */
+void ARCCache::clear(size_t num_keys)
+{
+  slots_.reset(NUM_LISTS, 2 * capacity_, num_keys);
+  target_ = 0;
+  hits_ = 0;
+  misses_ = 0;
+}
+
+/**
+ * function: capacity()
+ */
+size_t ARCCache::capacity() const
+{
+  return capacity_;
+}
+
+/**
+ * function: hits()
+ */
+size_t ARCCache::hits() const
+{
+  return hits_;
+}
+
+/**
+ * function: misses()
+ */
+size_t ARCCache::misses() const
+{
+  return misses_;
+}
+
+/**
+ * function: target()
+ */
+size_t ARCCache::target() const
+{
+  return target_;
+}
+
+/**
+ * function: memory_usage()
+ */
+size_t ARCCache::memory_usage() const
+{
+  return slots_.memory_usage();
+}
+
+/**
+ * function: replace(bool ghost_of_T2)
+ *
+ * REPLACE in the paper: T1 gives up its least recent key if it is larger
+ * than its target (or as large, for a hit on a ghost of T2), otherwise T2
+ * does. It is only called when the cache is full, so one of them has a key.
+ */
+void ARCCache::replace(bool ghost_of_T2)
+{
+  size_t T1_length = slots_.length(T1);
+  if (T1_length != 0 &&
+      (T1_length > target_ || (ghost_of_T2 && T1_length == target_))) {
+    demote(T1, B1);
+  }
+  else {
+    demote(T2, B2);
+  }
+}
+
+/**
+ * function: demote(List from, List to)
+ */
+void ARCCache::demote(List from, List to)
+{
+  slots_.move_to_front(slots_.back(from), to);
+}
@@ -0,0 +1,483 @@
+/**
+* CacheModel.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This file contains the buffer cache models used by
+* TraceSet::cached_seek_distance, which puts a simulated cache in front of the
+* disk so that only the accesses that miss the cache move the head. Repeated
+* reads of hot LBAs are mostly served by the page cache or the controller
+* cache, so the seeks of the misses are closer to what the disk does than the
+* seeks of every access.
+*
+* (1) LRUCache evicts the least recently used entry.
+*
+* (2) ClockCache approximates LRU with one referenced bit per entry and a
+* hand that sweeps over the entries, clearing the bits, until it finds one
+* that was not referenced since the last sweep.
+*
+* (3) ARCCache is the Adaptive Replacement Cache of Megiddo and Modha, which
+* splits the cache into entries seen once (T1) and entries seen at least
+* twice (T2), and keeps the keys recently evicted from each (B1 and B2) as
+* ghosts, without their data. A hit on a ghost tells it which of the two
+* lists should have been larger, and it moves the target size of T1 that way,
+* so it adapts between recency and frequency and is not flushed by scans.
+*
+* Every model holds at most capacity keys and has an inline access(key),
+* which returns true on a hit and otherwise inserts the key, evicting another
+* if the cache is full. Keys are the indices TraceSet gives its LBAs (the LBA,
+* or its ID in a dictionary encoded trace), so the entry of each key is found
+* in a table indexed by the key instead of a hashtable, and each access takes
+* constant time. The entries are linked into lists by 32 bit indices, so a
+* cache of millions of entries and a trace of billions of keys stay small.
+* Models are given to TraceSet as template parameters, like the seek cost
+* models in SeekCost.hpp, so access() is inlined into the scan.
+*
+*/
+
+#ifndef CACHEMODEL_HPP_INCLUDED
+#define CACHEMODEL_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CacheSlots{
+
+public:
+
+  /// Index that stands for no slot.
+  static const std::uint32_t NONE = 0xffffffff;
+
+  ///<Constructor creates an empty pool with no slots and no lists.
+  CacheSlots();
+
+  /// Empties the pool and makes room for num_slots entries in num_lists
+  /// lists, and for keys below num_keys (larger keys grow the table).
+  void reset(std::size_t num_lists, std::size_t num_slots,
+             std::size_t num_keys);
+
+  /// Returns the slot that holds key, or NONE if it is in no list.
+  std::uint32_t find(std::size_t key) const
+  {
+    return key < slot_of_key_.size() ? slot_of_key_[key] : NONE;
+  }
+
+  /// Returns the list that the slot is in.
+  std::uint32_t list_of(std::uint32_t slot) const
+  {
+    return slots_[slot].list;
+  }
+
+  /// Returns the key held by the slot.
+  std::size_t key_of(std::uint32_t slot) const
+  {
+    return slots_[slot].key;
+  }
+
+  /// Returns the number of entries in the list.
+  std::size_t length(std::uint32_t list) const
+  {
+    return lengths_[list];
+  }
+
+  /// Returns the slot at the back (the least recent end) of a list that is
+  /// not empty.
+  std::uint32_t back(std::uint32_t list) const
+  {
+    return slots_[list].prev;
+  }
+
+  /// Puts key at the front of the list in a free slot.
+  void push_front(std::uint32_t list, std::size_t key);
+
+  /// Moves the slot to the front of the list, which may be its own list.
+  void move_to_front(std::uint32_t slot, std::uint32_t list);
+
+  /// Takes the slot out of its list and frees it.
+  void remove(std::uint32_t slot);
+
+  /// Returns the bytes held by the pool.
+  std::size_t memory_usage() const;
+
+private:
+
+  /*
+   * struct: Slot
+   *
+   * One entry of a circular doubly linked list. The first num_lists slots
+   * are the heads of the lists and hold no key.
+   */
+  struct Slot {
+
+    std::size_t key;            // Key of the entry
+
+    std::uint32_t prev;         // Slot before this one in its list
+
+    std::uint32_t next;         // Slot after this one in its list, or the
+                                // next free slot
+
+    std::uint32_t list;         // List the slot is in
+
+  };
+
+  // Takes the slot out of its list without freeing it.
+  void unlink(std::uint32_t slot);
+
+  // Links the slot in at the front of the list.
+  void link_front(std::uint32_t slot, std::uint32_t list);
+
+  std::vector<Slot> slots_;                 // Heads of the lists, then the
+                                            // entries
+
+  std::vector<std::size_t> lengths_;        // Entries in each list
+
+  std::vector<std::uint32_t> slot_of_key_;  // Slot of each key, or NONE
+
+  std::uint32_t free_;                      // First free slot, or NONE
+
+};
+
+class LRUCache{
+
+public:
+
+  ///<Constructor which makes an empty cache of the given number of entries,
+  ///<clamped to MAX_CAPACITY. A cache of 0 entries misses every access.
+  explicit LRUCache(std::size_t capacity);
+
+  /// The largest capacity of a cache.
+  static const std::size_t MAX_CAPACITY = 0x7ffffff0;
+
+  /// Empties the cache and clears its counts, with room for keys below
+  /// num_keys.
+  void clear(std::size_t num_keys);
+
+  /// Returns true if key is in the cache. Otherwise inserts it, evicting the
+  /// least recently used key if the cache is full, and returns false.
+  bool access(std::size_t key);
+
+  /// Returns the capacity of the cache.
+  std::size_t capacity() const;
+
+  /// Returns the number of hits since the last clear.
+  std::size_t hits() const;
+
+  /// Returns the number of misses since the last clear.
+  std::size_t misses() const;
+
+  /// Returns the bytes held by the cache.
+  std::size_t memory_usage() const;
+
+private:
+
+  std::size_t capacity_;      // Most keys in the cache
+
+  CacheSlots slots_;          // The cache, one list in recency order
+
+  std::size_t hits_;          // Hits since the last clear
+
+  std::size_t misses_;        // Misses since the last clear
+
+};
+
+class ClockCache{
+
+public:
+
+  ///<Constructor which makes an empty cache of the given number of entries,
+  ///<clamped to LRUCache::MAX_CAPACITY.
+  explicit ClockCache(std::size_t capacity);
+
+  /// Empties the cache and clears its counts, with room for keys below
+  /// num_keys.
+  void clear(std::size_t num_keys);
+
+  /// Returns true if key is in the cache and marks it referenced. Otherwise
+  /// inserts it in place of the first unreferenced key after the hand if
+  /// the cache is full, and returns false.
+  bool access(std::size_t key);
+
+  /// Returns the capacity of the cache.
+  std::size_t capacity() const;
+
+  /// Returns the number of hits since the last clear.
+  std::size_t hits() const;
+
+  /// Returns the number of misses since the last clear.
+  std::size_t misses() const;
+
+  /// Returns the bytes held by the cache.
+  std::size_t memory_usage() const;
+
+private:
+
+  std::size_t capacity_;                      // Most keys in the cache
+
+  std::vector<std::size_t> keys_;             // Key in each frame
+
+  std::vector<std::uint8_t> referenced_;      // Referenced bit of each frame
+
+  std::vector<std::uint32_t> frame_of_key_;   // Frame of each key, or NONE
+
+  std::size_t hand_;                          // Next frame the hand checks
+
+  std::size_t hits_;                          // Hits since the last clear
+
+  std::size_t misses_;                        // Misses since the last clear
+
+};
+
+class ARCCache{
+
+public:
+
+  ///<Constructor which makes an empty cache of the given number of entries,
+  ///<clamped to LRUCache::MAX_CAPACITY. It remembers as many ghosts.
+  explicit ARCCache(std::size_t capacity);
+
+  /// Empties the cache and the ghosts, clears the counts and sets the target
+  /// size of T1 back to 0, with room for keys below num_keys.
+  void clear(std::size_t num_keys);
+
+  /// Returns true if key is in the cache. Otherwise inserts it, as ARC
+  /// does, and returns false.
+  bool access(std::size_t key);
+
+  /// Returns the capacity of the cache.
+  std::size_t capacity() const;
+
+  /// Returns the number of hits since the last clear.
+  std::size_t hits() const;
+
+  /// Returns the number of misses since the last clear.
+  std::size_t misses() const;
+
+  /// Returns the current target size of T1.
+  std::size_t target() const;
+
+  /// Returns the bytes held by the cache.
+  std::size_t memory_usage() const;
+
+private:
+
+  // The lists of ARC, the first two are in the cache and the last two are
+  // ghosts.
+  enum List { T1, T2, B1, B2, NUM_LISTS };
+
+  // Evicts the back of T1 into B1 or the back of T2 into B2, the one ARC
+  // picks for a miss on key. ghost_of_T2 is true if key is in B2.
+  void replace(bool ghost_of_T2);
+
+  // Moves the back of the from list into the front of the to list.
+  void demote(List from, List to);
+
+  std::size_t capacity_;      // Most keys in T1 and T2
+
+  std::size_t target_;        // Target size of T1, ARC's p
+
+  CacheSlots slots_;          // The four lists
+
+  std::size_t hits_;          // Hits since the last clear
+
+  std::size_t misses_;        // Misses since the last clear
+
+};
+
+/**
+ * function: push_front(std::uint32_t list, std::size_t key)
+ */
+inline void CacheSlots::push_front(std::uint32_t list, std::size_t key)
+{
+  std::uint32_t slot = free_;
+  free_ = slots_[slot].next;
+
+  slots_[slot].key = key;
+  link_front(slot, list);
+
+  if (key >= slot_of_key_.size()) {
+    slot_of_key_.resize(key + 1, NONE);
+  }
+  slot_of_key_[key] = slot;
+}
+
+/**
+ * function: move_to_front(std::uint32_t slot, std::uint32_t list)
+ */
+inline void CacheSlots::move_to_front(std::uint32_t slot, std::uint32_t list)
+{
+  unlink(slot);
+  link_front(slot, list);
+}
+
+/**
+ * function: remove(std::uint32_t slot)
+ */
+inline void CacheSlots::remove(std::uint32_t slot)
+{
+  unlink(slot);
+  slot_of_key_[slots_[slot].key] = NONE;
+  slots_[slot].next = free_;
+  free_ = slot;
+}
+
+/**
+ * function: unlink(std::uint32_t slot)
+ */
+inline void CacheSlots::unlink(std::uint32_t slot)
+{
+  Slot& entry = slots_[slot];
+  slots_[entry.prev].next = entry.next;
+  slots_[entry.next].prev = entry.prev;
+  --lengths_[entry.list];
+}
+
+/**
+ * function: link_front(std::uint32_t slot, std::uint32_t list)
+ */
+inline void CacheSlots::link_front(std::uint32_t slot, std::uint32_t list)
+{
+  Slot& entry = slots_[slot];
+  entry.list = list;
+  entry.prev = list;
+  entry.next = slots_[list].next;
+  slots_[entry.next].prev = slot;
+  slots_[list].next = slot;
+  ++lengths_[list];
+}
+
+/**
+ * function: access(size_t key)
+ */
+inline bool LRUCache::access(std::size_t key)
+{
+  std::uint32_t slot = slots_.find(key);
+  if (slot != CacheSlots::NONE) {
+    slots_.move_to_front(slot, 0);
+    ++hits_;
+    return true;
+  }
+
+  ++misses_;
+  if (capacity_ == 0) {
+    return false;
+  }
+  if (slots_.length(0) == capacity_) {
+    slots_.remove(slots_.back(0));
+  }
+  slots_.push_front(0, key);
+  return false;
+}
+
+/**
+ * function: access(size_t key)
+ *
+ * New keys start unreferenced, so a key that is never read again is the
+ * first to go once the hand comes around.
+ */
+inline bool ClockCache::access(std::size_t key)
+{
+  if (key < frame_of_key_.size() && frame_of_key_[key] != CacheSlots::NONE) {
+    referenced_[frame_of_key_[key]] = 1;
+    ++hits_;
+    return true;
+  }
+
+  ++misses_;
+  if (capacity_ == 0) {
+    return false;
+  }
+  if (key >= frame_of_key_.size()) {
+    frame_of_key_.resize(key + 1, CacheSlots::NONE);
+  }
+
+  std::size_t frame;
+  if (keys_.size() < capacity_) {
+    frame = keys_.size();
+    keys_.push_back(key);
+    referenced_.push_back(0);
+  }
+  else {
+    while (referenced_[hand_] != 0) {
+      referenced_[hand_] = 0;
+      hand_ = hand_ + 1 == capacity_ ? 0 : hand_ + 1;
+    }
+    frame = hand_;
+    hand_ = hand_ + 1 == capacity_ ? 0 : hand_ + 1;
+    frame_of_key_[keys_[frame]] = CacheSlots::NONE;
+    keys_[frame] = key;
+  }
+  frame_of_key_[key] = static_cast<std::uint32_t>(frame);
+  return false;
+}
+
+/**
+ * function: access(size_t key)
+ *
+ * The four cases of ARC(c) in the paper, with the sizes of the lists kept by
+ * the slots, so that every case takes constant time.
+ */
+inline bool ARCCache::access(std::size_t key)
+{
+  std::uint32_t slot = slots_.find(key);
+  std::uint32_t list = slot == CacheSlots::NONE
+                       ? static_cast<std::uint32_t>(NUM_LISTS)
+                       : slots_.list_of(slot);
+
+  // Case I: a hit in T1 or T2, the key has now been seen twice
+  if (list == T1 || list == T2) {
+    slots_.move_to_front(slot, T2);
+    ++hits_;
+    return true;
+  }
+
+  ++misses_;
+  if (capacity_ == 0) {
+    return false;
+  }
+
+  // Case II: a ghost of T1, so T1 should have been larger
+  if (list == B1) {
+    std::size_t step = slots_.length(B2) / slots_.length(B1);
+    target_ += step > 1 ? step : 1;
+    if (target_ > capacity_) {
+      target_ = capacity_;
+    }
+    replace(false);
+    slots_.move_to_front(slot, T2);
+    return false;
+  }
+
+  // Case III: a ghost of T2, so T2 should have been larger
+  if (list == B2) {
+    std::size_t step = slots_.length(B1) / slots_.length(B2);
+    step = step > 1 ? step : 1;
+    target_ = target_ > step ? target_ - step : 0;
+    replace(true);
+    slots_.move_to_front(slot, T2);
+    return false;
+  }
+
+  // Case IV: a key seen for the first time in a while
+  std::size_t L1 = slots_.length(T1) + slots_.length(B1);
+  std::size_t total = L1 + slots_.length(T2) + slots_.length(B2);
+  if (L1 == capacity_) {
+    if (slots_.length(T1) < capacity_) {
+      slots_.remove(slots_.back(B1));
+      replace(false);
+    }
+    else {
+      slots_.remove(slots_.back(T1));
+    }
+  }
+  else if (total >= capacity_) {
+    if (total == 2 * capacity_) {
+      slots_.remove(slots_.back(B2));
+    }
+    replace(false);
+  }
+  slots_.push_front(T1, key);
+  return false;
+}
+
+#endif // CACHEMODEL_HPP_INCLUDED
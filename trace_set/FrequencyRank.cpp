@@ -0,0 +1,195 @@
+/*
+* FrequencyRank.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the FrequencyRank class, which counts and ranks the LBAs of
+* a trace by how often they are accessed.
+*
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "FrequencyRank.hpp"
+
+using namespace std;
+
+// Number of bits of the hash used to pick the partition of a LBA
+static const unsigned PARTITION_BITS = 8;
+
+// Number of partitions the accesses are split into
+static const size_t NUM_PARTITIONS = size_t(1) << PARTITION_BITS;
+
+/*
+ * function: partition_of(size_t LBA)
+ *
+ * Multiplies by a large odd constant and keeps the top bits, so that LBAs
+ * that are close to each other land in different partitions.
+ */
+static inline size_t partition_of(size_t LBA)
+{
+  return static_cast<size_t>(
+      (static_cast<unsigned long long>(LBA) * 0x9E3779B97F4A7C15ULL) >>
+      (64 - PARTITION_BITS));
+}
+
+/**
+ * function: count(const vector<size_t>& accesses, unsigned num_threads)
+ */
+vector<FrequencyRank::Count> FrequencyRank::count(
+    const vector<size_t>& accesses, unsigned num_threads)
+{
+  return count(accesses.data(), accesses.size(), 1, num_threads);
+}
+
+/**
+ * function: count(const size_t* accesses, size_t num_accesses, size_t stride,
+ *                 unsigned num_threads)
+ *
+ * (1) Each thread makes a histogram of how many of its accesses fall in each
+ * partition.
+ *
+ * (2) The histograms give every thread the place in the partitioned array
+ * where each of its partitions starts, and each thread copies its accesses
+ * there.
+ *
+ * (3) The partitions are dealt out to the threads, which sort each one and
+ * count the runs of equal LBAs.
+ *
+ * The counts are then joined and sorted by LBA.
+ */
+vector<FrequencyRank::Count> FrequencyRank::count(
+    const size_t* accesses, size_t num_accesses, size_t stride,
+    unsigned num_threads)
+{
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+
+  size_t chunk = num_accesses / num_threads + 1;
+
+  // Step 1: histogram of partitions for each chunk
+  vector<vector<size_t> > histograms(num_threads,
+                                     vector<size_t>(NUM_PARTITIONS, 0));
+  vector<thread> workers;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    workers.push_back(thread([accesses, &histograms, chunk, num_accesses,
+                              stride, t]() {
+      size_t begin = min(num_accesses, chunk * t);
+      size_t end = min(num_accesses, begin + chunk);
+      for (size_t i = begin; i < end; ++i) {
+        ++histograms[t][partition_of(accesses[i * stride])];
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+  workers.clear();
+
+  // Step 2: where each chunk writes each partition, partitions are stored one
+  // after another and within a partition the chunks are in order.
+  vector<size_t> partition_starts(NUM_PARTITIONS + 1, 0);
+  vector<vector<size_t> > offsets(num_threads,
+                                  vector<size_t>(NUM_PARTITIONS, 0));
+  size_t position = 0;
+  for (size_t p = 0; p < NUM_PARTITIONS; ++p) {
+    partition_starts[p] = position;
+    for (unsigned t = 0; t < num_threads; ++t) {
+      offsets[t][p] = position;
+      position += histograms[t][p];
+    }
+  }
+  partition_starts[NUM_PARTITIONS] = position;
+
+  vector<size_t> partitioned(num_accesses);
+  for (unsigned t = 0; t < num_threads; ++t) {
+    workers.push_back(thread([accesses, &offsets, &partitioned, chunk,
+                              num_accesses, stride, t]() {
+      size_t begin = min(num_accesses, chunk * t);
+      size_t end = min(num_accesses, begin + chunk);
+      vector<size_t>& offset = offsets[t];
+      for (size_t i = begin; i < end; ++i) {
+        size_t LBA = accesses[i * stride];
+        partitioned[offset[partition_of(LBA)]++] = LBA;
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+  workers.clear();
+
+  // Step 3: sort and count each partition, thread t takes every num_threads
+  // partition starting at t.
+  vector<vector<Count> > partial(num_threads);
+  for (unsigned t = 0; t < num_threads; ++t) {
+    workers.push_back(thread([&partitioned, &partition_starts, &partial,
+                              num_threads, t]() {
+      for (size_t p = t; p < NUM_PARTITIONS; p += num_threads) {
+
+        vector<size_t>::iterator begin =
+            partitioned.begin() + partition_starts[p];
+        vector<size_t>::iterator end =
+            partitioned.begin() + partition_starts[p + 1];
+        sort(begin, end);
+
+        while (begin != end) {
+          vector<size_t>::iterator run_end = upper_bound(begin, end, *begin);
+          Count counted;
+          counted.LBA = *begin;
+          counted.count = static_cast<size_t>(run_end - begin);
+          partial[t].push_back(counted);
+          begin = run_end;
+        }
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+
+  vector<Count> counts;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    counts.insert(counts.end(), partial[t].begin(), partial[t].end());
+  }
+  sort(counts.begin(), counts.end(), [](const Count& a, const Count& b) {
+    return a.LBA < b.LBA;
+  });
+
+  return counts;
+}
+
+/**
+ * function: ranks_before(const Count& a, const Count& b)
+ *
+ * More accesses first, then the smaller LBA first.
+ */
+bool FrequencyRank::ranks_before(const Count& a, const Count& b)
+{
+  if (a.count != b.count) {
+    return a.count > b.count;
+  }
+  return a.LBA < b.LBA;
+}
+
+/**
+ * function: rank(vector<Count>& counts, size_t top_k)
+ *
+ * For top_k smaller than the number of LBAs, partial_sort only keeps a heap
+ * of top_k LBAs while it passes over the rest.
+ */
+void FrequencyRank::rank(vector<Count>& counts, size_t top_k)
+{
+  if (top_k == 0 || top_k >= counts.size()) {
+    sort(counts.begin(), counts.end(), ranks_before);
+    return;
+  }
+
+  partial_sort(counts.begin(), counts.begin() + top_k, counts.end(),
+               ranks_before);
+  counts.resize(top_k);
+}
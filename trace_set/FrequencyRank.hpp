@@ -0,0 +1,71 @@
+/**
+* FrequencyRank.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called FrequencyRank, which counts how many times each LBA
+* is accessed in a trace and ranks the LBAs from most to least accessed. It
+* replaces the
+*
+*     sort trace | uniq -c | sort -r
+*
+* pipeline that was used to make the list of hot LBAs given to
+* change_locations, which sorted the whole text trace several times.
+*
+* Counting is done in two parallel passes. First each thread takes a chunk of
+* the accesses and splits them into 256 partitions by the hash of the LBA, so
+* every access of a LBA ends up in the same partition. Then each thread sorts
+* some of the partitions and counts the runs of equal LBAs in them. No locks
+* are needed since no two threads write the same part of the arrays.
+*
+* Ties are broken the same way every time: LBAs with more accesses come first,
+* and LBAs with the same number of accesses are in increasing order.
+*
+*/
+
+#ifndef FREQUENCYRANK_HPP_INCLUDED
+#define FREQUENCYRANK_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <vector>
+
+class FrequencyRank{
+
+public:
+
+  /*
+   * struct: Count
+   *
+   * The number of accesses of one LBA.
+   */
+  struct Count {
+
+    std::size_t LBA;          // The LBA
+
+    std::size_t count;        // Number of times the LBA is accessed
+
+  };
+
+  /// Returns the number of accesses of every distinct LBA in accesses, in
+  /// increasing order of LBA, using num_threads threads. If num_threads is 0
+  /// the number of hardware threads is used.
+  static std::vector<Count> count(const std::vector<std::size_t>& accesses,
+                                  unsigned num_threads);
+
+  /// The same as count(accesses, num_threads) for the num_accesses LBAs
+  /// accesses[0], accesses[stride], accesses[2 * stride], ...
+  static std::vector<Count> count(const std::size_t* accesses,
+                                  std::size_t num_accesses,
+                                  std::size_t stride, unsigned num_threads);
+
+  /// Puts the top_k most accessed LBAs of counts at the front of counts in
+  /// ranked order and removes the rest. If top_k is 0 or at least the size of
+  /// counts every LBA is kept. Only the kept LBAs are fully sorted.
+  static void rank(std::vector<Count>& counts, std::size_t top_k);
+
+  /// Returns true if a should be ranked before b.
+  static bool ranks_before(const Count& a, const Count& b);
+
+};
+
+#endif // FREQUENCYRANK_HPP_INCLUDED
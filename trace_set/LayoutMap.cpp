@@ -0,0 +1,204 @@
+/*
+* LayoutMap.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the LayoutMap class, which computes the location of LBAs
+* after a change_locations call without a TraceSet, and finds the total seek
+* distance of a trace while streaming it.
+*
+*/
+
+#include <algorithm>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LayoutMap.hpp"
+#include "MappedTrace.hpp"
+#include "BinaryTrace.hpp"
+
+using namespace std;
+
+// Number of bytes read from a stream at a time by stream_seek_distance
+static const size_t READ_SIZE = 1 << 16;
+
+/*
+ * class: SeekAccumulator
+ *
+ * Adds up the seek distance of a trace one LBA at a time, only keeping the
+ * location of the previous access.
+ */
+class SeekAccumulator {
+
+public:
+
+  explicit SeekAccumulator(const LayoutMap& layout):
+    layout_(layout),
+    total_{0},
+    previous_{0},
+    first_{true}
+  {
+    // Do nothing here
+  }
+
+  void operator()(size_t LBA)
+  {
+    size_t current = layout_.location(LBA);
+
+    if (first_) {
+      first_ = false;
+    } else if (current < previous_) {
+      total_ += previous_ - current;
+    } else {
+      total_ += current - previous_;
+    }
+
+    previous_ = current;
+  }
+
+  size_t total() const
+  {
+    return total_;
+  }
+
+private:
+
+  const LayoutMap& layout_;
+  size_t total_;
+  size_t previous_;
+  bool first_;
+
+};
+
+// Default constructor for LayoutMap
+LayoutMap::LayoutMap():
+  start_{0}
+{
+  // Do nothing here
+}
+
+// Constructor for the layout produced by change_locations(LBA_vector, start)
+LayoutMap::LayoutMap(const vector<size_t>& LBA_vector, size_t start):
+  old_locations_{LBA_vector},
+  start_{start}
+{
+  for (size_t i = 0; i < LBA_vector.size(); ++i) {
+    moved_.emplace(LBA_vector[i], start + i);
+  }
+
+  sort(old_locations_.begin(), old_locations_.end());
+}
+
+/**
+ * function: location(size_t LBA)
+ *
+ * Returns the new location of a moved LBA, otherwise closes up the gap left by
+ * the moved LBAs below the LBA and makes room for them again at start_.
+ */
+size_t LayoutMap::location(size_t LBA) const
+{
+  if (!moved_.empty()) {
+    unordered_map<size_t, size_t>::const_iterator found = moved_.find(LBA);
+    if (found != moved_.end()) {
+      return found->second;
+    }
+  }
+
+  size_t below = static_cast<size_t>(
+      lower_bound(old_locations_.begin(), old_locations_.end(), LBA) -
+      old_locations_.begin());
+
+  size_t location = LBA - below;
+  if (location >= start_) {
+    location += old_locations_.size();
+  }
+
+  return location;
+}
+
+/**
+ * function: stream_seek_distance(istream& inputstream)
+ *
+ * Reads the stream in blocks and parses the LBAs with the same rules as
+ * MappedTrace::parse_LBA, keeping only the digits seen so far on the current
+ * line between blocks.
+ */
+size_t LayoutMap::stream_seek_distance(istream& inputstream) const
+{
+  SeekAccumulator accumulator(*this);
+  vector<char> block(READ_SIZE);
+
+  size_t value = 0;
+  bool has_digits = false;
+  bool line_done = false;
+
+  while (inputstream.read(block.data(), block.size()) ||
+         inputstream.gcount() > 0) {
+
+    size_t count = static_cast<size_t>(inputstream.gcount());
+    for (size_t i = 0; i < count; ++i) {
+
+      char c = block[i];
+      if (c == '\n') {
+        if (has_digits) {
+          accumulator(value);
+        }
+        value = 0;
+        has_digits = false;
+        line_done = false;
+      } else if (line_done) {
+        // Ignore the rest of the line
+      } else if (c >= '0' && c <= '9') {
+        MappedTrace::append_digit(value, static_cast<unsigned>(c - '0'));
+        has_digits = true;
+      } else if (!has_digits && (c == ' ' || c == '\t')) {
+        // Skip leading whitespace
+      } else {
+        line_done = true;
+      }
+    }
+  }
+
+  if (has_digits) {
+    accumulator(value);
+  }
+
+  return accumulator.total();
+}
+
+/**
+ * function: stream_seek_distance(const string& filename)
+ *
+ * Decodes binary traces with BinaryTrace and parses text traces in place with
+ * MappedTrace, in both cases the mapping is only read front to back. A corrupt
+ * binary trace gives 0 rather than the distance of the part before the bad
+ * entry.
+ */
+size_t LayoutMap::stream_seek_distance(const string& filename) const
+{
+  SeekAccumulator accumulator(*this);
+
+  if (BinaryTrace::is_binary_trace(filename)) {
+
+    BinaryTrace trace;
+    if (!trace.open(filename) ||
+        !trace.for_each_LBA([&accumulator](size_t LBA) { accumulator(LBA); })) {
+      return 0;
+    }
+
+  } else {
+
+    MappedTrace trace(filename);
+    if (trace.is_open()) {
+      MappedTrace::for_each_LBA(trace.begin(), trace.end(),
+                                [&accumulator](size_t LBA) {
+                                  accumulator(LBA);
+                                });
+    }
+
+  }
+
+  return accumulator.total();
+}
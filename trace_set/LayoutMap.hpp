@@ -0,0 +1,79 @@
+/**
+* LayoutMap.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called LayoutMap, which maps LBAs to locations the same way
+* a TraceSet does after change_locations, but without holding the trace. It is
+* used to find the total seek distance of a layout on traces that are too
+* large to be read into a TraceSet, by streaming the trace from a file and only
+* keeping the location of the previous access.
+*
+* A TraceSet starts with every LBA at the location equal to the LBA. After
+* change_locations(LBA_vector, start) the i-th LBA in LBA_vector is at location
+* start + i, and every other LBA x is at
+*
+*     p = x - (number of LBAs in LBA_vector whose location was below x)
+*
+* if p < start, or at p + LBA_vector.size() if p >= start, since the moved
+* LBAs are removed from the locations_ vector and inserted again at start.
+* LayoutMap stores only the moved LBAs, sorted by their old location, so the
+* location of an LBA is found with one hash lookup and one binary search, and
+* memory use depends only on the size of LBA_vector.
+*
+* NOTE: Like change_locations, this assumes that every LBA in LBA_vector
+* occurs in the trace and that no LBA is in LBA_vector twice.
+*
+*/
+
+#ifndef LAYOUTMAP_HPP_INCLUDED
+#define LAYOUTMAP_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class LayoutMap{
+
+public:
+
+  ///<Constructor creates the layout of a freshly read in trace, where each
+  ///<LBA is at the location equal to the LBA.
+  LayoutMap();
+
+  ///<Constructor creates the layout that change_locations(LBA_vector, start)
+  ///<produces on a freshly read in trace.
+  LayoutMap(const std::vector<std::size_t>& LBA_vector, std::size_t start);
+
+  /// Returns the location of the given LBA in this layout.
+  std::size_t location(std::size_t LBA) const;
+
+  /// Reads a text trace, one LBA per line, from inputstream and returns the
+  /// total seek distance of the trace in this layout. Only the previous
+  /// location is kept while reading, so the trace is never held in memory.
+  std::size_t stream_seek_distance(std::istream& inputstream) const;
+
+  /// Returns the total seek distance in this layout of the trace in the file
+  /// called filename, which can be a text trace or a binary trace written by
+  /// trace-convert. The file is memory mapped and read sequentially. Returns
+  /// 0 if the binary trace is corrupt.
+  std::size_t stream_seek_distance(const std::string& filename) const;
+
+private:
+
+  // moved_ is a hashtable where the keys are the LBAs in the LBA_vector given
+  // to the constructor and the values are their new locations.
+  std::unordered_map<std::size_t, std::size_t> moved_;
+
+  // old_locations_ is a sorted vector of the locations the LBAs in moved_
+  // had before they were moved.
+  std::vector<std::size_t> old_locations_;
+
+  // start_ is the location of the first LBA in the LBA_vector.
+  std::size_t start_;
+
+};
+
+#endif // LAYOUTMAP_HPP_INCLUDED
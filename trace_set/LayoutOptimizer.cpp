@@ -0,0 +1,617 @@
+/*
+* LayoutOptimizer.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the LayoutOptimizer class, which searches for a better
+* order of the hot LBAs by simulated annealing.
+*
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LayoutOptimizer.hpp"
+#include "LayoutMap.hpp"
+
+using namespace std;
+
+// The temperature falls from the starting temperature to this fraction of it
+// by the end of the search.
+static const double FINAL_TEMPERATURE = 1e-3;
+
+// Number of steps between checks of the clock and updates of the temperature
+static const size_t STEPS_PER_CHECK = 256;
+
+// Number of random changes used to pick the starting temperature
+static const size_t TEMPERATURE_SAMPLES = 200;
+
+/*
+ * function: next_random(unsigned long long& state)
+ *
+ * xorshift64*, which is fast and good enough to pick changes.
+ */
+static inline unsigned long long next_random(unsigned long long& state)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 2685821657736338717ULL;
+}
+
+/*
+ * function: seed_random(unsigned long long seed)
+ *
+ * Mixes the seed so nearby seeds give unrelated streams, xorshift needs a
+ * state that is not 0.
+ */
+static unsigned long long seed_random(unsigned long long seed)
+{
+  unsigned long long state = seed + 0x9E3779B97F4A7C15ULL;
+  state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  state = (state ^ (state >> 27)) * 0x94D049BB133111EBULL;
+  state ^= state >> 31;
+  return state == 0 ? 1 : state;
+}
+
+/*
+ * function: distance(long long a, long long b)
+ */
+static inline long long distance(long long a, long long b)
+{
+  return a < b ? b - a : a - b;
+}
+
+// Constructor for Options
+LayoutOptimizer::Options::Options():
+  iterations{100000}, seconds{0}, num_threads{0}, exchange_interval{10000},
+  max_window{32}, temperature{0}, seed{1}
+{
+  // Do nothing here
+}
+
+/**
+ * function: LayoutOptimizer(TraceSet& trace, const vector<size_t>& LBA_vector,
+ *                           size_t start)
+ *
+ * Each transition of the trace is sorted into one of three groups: between
+ * two hot LBAs, between a hot LBA and another LBA, whose location is taken
+ * from the LayoutMap of LBA_vector, or between two other LBAs, which never
+ * changes and is only added to fixed_distance_. The first two groups are
+ * stored as compressed lists per hot LBA, counted first and then filled in.
+ */
+LayoutOptimizer::LayoutOptimizer(TraceSet& trace,
+                                 const vector<size_t>& LBA_vector,
+                                 size_t start):
+  LBAs_(LBA_vector), start_{start}, fixed_distance_{0}, initial_cost_{0},
+  best_layout_(LBA_vector), best_cost_{0}, proposed_{0}, accepted_{0}
+{
+  size_t num_LBAs = LBAs_.size();
+  for (size_t i = 0; i < num_LBAs; ++i) {
+    index_of_[LBAs_[i]] = i;
+  }
+
+  LayoutMap layout(LBA_vector, start);
+  const vector<TraceSet::Transition>& transitions = trace.get_transitions();
+  bool dictionary = trace.is_dictionary_encoded();
+
+  // The hot index of each end of each transition, num_LBAs if not hot.
+  vector<size_t> low_index(transitions.size());
+  vector<size_t> high_index(transitions.size());
+  hot_offsets_.assign(num_LBAs + 1, 0);
+  cold_offsets_.assign(num_LBAs + 1, 0);
+
+  for (size_t i = 0; i < transitions.size(); ++i) {
+
+    size_t low = transitions[i].low;
+    size_t high = transitions[i].high;
+    if (dictionary) {
+      low = trace.get_LBA(low);
+      high = trace.get_LBA(high);
+    }
+
+    unordered_map<size_t, size_t>::const_iterator found = index_of_.find(low);
+    low_index[i] = found == index_of_.end() ? num_LBAs : found->second;
+    found = index_of_.find(high);
+    high_index[i] = found == index_of_.end() ? num_LBAs : found->second;
+
+    if (low_index[i] < num_LBAs && high_index[i] < num_LBAs) {
+      ++hot_offsets_[low_index[i] + 1];
+      ++hot_offsets_[high_index[i] + 1];
+    } else if (low_index[i] < num_LBAs) {
+      ++cold_offsets_[low_index[i] + 1];
+    } else if (high_index[i] < num_LBAs) {
+      ++cold_offsets_[high_index[i] + 1];
+    } else {
+      long long low_location = static_cast<long long>(layout.location(low));
+      long long high_location = static_cast<long long>(layout.location(high));
+      fixed_distance_ += transitions[i].count *
+        static_cast<size_t>(distance(low_location, high_location));
+    }
+  }
+
+  for (size_t i = 0; i < num_LBAs; ++i) {
+    hot_offsets_[i + 1] += hot_offsets_[i];
+    cold_offsets_[i + 1] += cold_offsets_[i];
+  }
+  hot_neighbors_.resize(hot_offsets_[num_LBAs]);
+  hot_counts_.resize(hot_offsets_[num_LBAs]);
+  cold_locations_.resize(cold_offsets_[num_LBAs]);
+  cold_counts_.resize(cold_offsets_[num_LBAs]);
+
+  vector<size_t> hot_fill(hot_offsets_.begin(), hot_offsets_.end() - 1);
+  vector<size_t> cold_fill(cold_offsets_.begin(), cold_offsets_.end() - 1);
+  for (size_t i = 0; i < transitions.size(); ++i) {
+
+    size_t low = transitions[i].low;
+    size_t high = transitions[i].high;
+    if (dictionary) {
+      low = trace.get_LBA(low);
+      high = trace.get_LBA(high);
+    }
+    size_t count = transitions[i].count;
+
+    if (low_index[i] < num_LBAs && high_index[i] < num_LBAs) {
+      hot_neighbors_[hot_fill[low_index[i]]] = high_index[i];
+      hot_counts_[hot_fill[low_index[i]]++] = count;
+      hot_neighbors_[hot_fill[high_index[i]]] = low_index[i];
+      hot_counts_[hot_fill[high_index[i]]++] = count;
+    } else if (low_index[i] < num_LBAs) {
+      cold_locations_[cold_fill[low_index[i]]] = layout.location(high);
+      cold_counts_[cold_fill[low_index[i]]++] = count;
+    } else if (high_index[i] < num_LBAs) {
+      cold_locations_[cold_fill[high_index[i]]] = layout.location(low);
+      cold_counts_[cold_fill[high_index[i]]++] = count;
+    }
+  }
+
+  vector<size_t> order(num_LBAs);
+  for (size_t i = 0; i < num_LBAs; ++i) {
+    order[i] = i;
+  }
+  initial_cost_ = order_cost(order);
+  best_cost_ = initial_cost_;
+}
+
+/**
+ * function: order_cost(const vector<size_t>& order)
+ *
+ * Adds up the transitions of every hot LBA, counting a transition between
+ * two hot LBAs only from its smaller index.
+ */
+long long LayoutOptimizer::order_cost(const vector<size_t>& order) const
+{
+  vector<size_t> slot_of(order.size());
+  for (size_t slot = 0; slot < order.size(); ++slot) {
+    slot_of[order[slot]] = slot;
+  }
+
+  long long cost = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    long long location = static_cast<long long>(start_ + slot_of[i]);
+
+    for (size_t e = hot_offsets_[i]; e < hot_offsets_[i + 1]; ++e) {
+      if (hot_neighbors_[e] > i) {
+        cost += static_cast<long long>(hot_counts_[e]) *
+          distance(static_cast<long long>(slot_of[i]),
+                   static_cast<long long>(slot_of[hot_neighbors_[e]]));
+      }
+    }
+    for (size_t e = cold_offsets_[i]; e < cold_offsets_[i + 1]; ++e) {
+      cost += static_cast<long long>(cold_counts_[e]) *
+        distance(location, static_cast<long long>(cold_locations_[e]));
+    }
+  }
+
+  return cost;
+}
+
+/**
+ * function: change_cost(const Chain& chain)
+ *
+ * Only transitions with at least one moved end change. A transition between
+ * two moved LBAs is counted from the one with the smaller index.
+ */
+long long LayoutOptimizer::change_cost(const Chain& chain) const
+{
+  long long delta = 0;
+  for (size_t c = 0; c < chain.changed.size(); ++c) {
+
+    size_t i = chain.changed[c];
+    long long old_slot = static_cast<long long>(chain.slot_of[i]);
+    long long new_slot = static_cast<long long>(chain.new_slot[i]);
+
+    for (size_t e = hot_offsets_[i]; e < hot_offsets_[i + 1]; ++e) {
+      size_t j = hot_neighbors_[e];
+      long long other_old = static_cast<long long>(chain.slot_of[j]);
+      long long other_new = other_old;
+      if (chain.stamp[j] == chain.epoch) {
+        if (j < i) {
+          continue;
+        }
+        other_new = static_cast<long long>(chain.new_slot[j]);
+      }
+      delta += static_cast<long long>(hot_counts_[e]) *
+        (distance(new_slot, other_new) - distance(old_slot, other_old));
+    }
+
+    long long old_location = old_slot + static_cast<long long>(start_);
+    long long new_location = new_slot + static_cast<long long>(start_);
+    for (size_t e = cold_offsets_[i]; e < cold_offsets_[i + 1]; ++e) {
+      long long other = static_cast<long long>(cold_locations_[e]);
+      delta += static_cast<long long>(cold_counts_[e]) *
+        (distance(new_location, other) - distance(old_location, other));
+    }
+  }
+
+  return delta;
+}
+
+/**
+ * function: propose(Chain& chain, size_t max_window)
+ *
+ * Picks one of the three kinds of change at random and marks every LBA whose
+ * slot it changes, with its new slot.
+ */
+bool LayoutOptimizer::propose(Chain& chain, size_t max_window) const
+{
+  size_t num_LBAs = chain.order.size();
+  if (num_LBAs < 2) {
+    return false;
+  }
+  if (max_window < 2) {
+    max_window = 2;
+  }
+
+  ++chain.epoch;
+  chain.changed.clear();
+
+  unsigned long long r = next_random(chain.random);
+  size_t kind = r % 3;
+  size_t first = (r >> 8) % num_LBAs;
+  size_t second = 0;
+
+  if (kind == 0) {
+    // Swap with any other slot
+    second = next_random(chain.random) % num_LBAs;
+    if (second == first) {
+      return false;
+    }
+    size_t a = chain.order[first];
+    size_t b = chain.order[second];
+    chain.stamp[a] = chain.epoch;
+    chain.new_slot[a] = second;
+    chain.changed.push_back(a);
+    chain.stamp[b] = chain.epoch;
+    chain.new_slot[b] = first;
+    chain.changed.push_back(b);
+    return true;
+  }
+
+  unsigned long long s = next_random(chain.random);
+  size_t length = 1 + s % (max_window - 1);
+
+  if (kind == 1) {
+    // Move the LBA at first by up to max_window - 1 slots
+    if ((s >> 32) & 1) {
+      second = min(num_LBAs - 1, first + length);
+    } else {
+      second = first > length ? first - length : 0;
+    }
+    if (second == first) {
+      return false;
+    }
+    size_t low = min(first, second);
+    size_t high = max(first, second);
+    for (size_t slot = low; slot <= high; ++slot) {
+      size_t i = chain.order[slot];
+      chain.stamp[i] = chain.epoch;
+      if (slot == first) {
+        chain.new_slot[i] = second;
+      } else {
+        chain.new_slot[i] = first < second ? slot - 1 : slot + 1;
+      }
+      chain.changed.push_back(i);
+    }
+    return true;
+  }
+
+  // Reverse the segment of up to max_window slots starting at first
+  second = min(num_LBAs - 1, first + length);
+  if (second == first) {
+    return false;
+  }
+  for (size_t slot = first; slot <= second; ++slot) {
+    size_t i = chain.order[slot];
+    chain.stamp[i] = chain.epoch;
+    chain.new_slot[i] = first + second - slot;
+    chain.changed.push_back(i);
+  }
+  return true;
+}
+
+/**
+ * function: reset_chain(Chain& chain, const vector<size_t>& order)
+ */
+void LayoutOptimizer::reset_chain(Chain& chain,
+                                  const vector<size_t>& order) const
+{
+  chain.order = order;
+  chain.slot_of.resize(order.size());
+  for (size_t slot = 0; slot < order.size(); ++slot) {
+    chain.slot_of[order[slot]] = slot;
+  }
+  chain.cost = order_cost(order);
+  chain.best_order = order;
+  chain.best_cost = chain.cost;
+  chain.stamp.assign(order.size(), 0);
+  chain.new_slot.assign(order.size(), 0);
+  chain.epoch = 0;
+}
+
+/**
+ * function: run_chain(Chain& chain, size_t first_step, size_t steps,
+ *                     const Options& options, double temperature,
+ *                     steady_clock::time_point begin)
+ *
+ * The temperature falls geometrically with the fraction of the search that
+ * is done, which is the larger of the fraction of the steps and the fraction
+ * of the time, so the same cooling works for either kind of limit. It and
+ * the clock are only looked at every STEPS_PER_CHECK steps. A worse change
+ * of delta is accepted with probability exp(-delta / temperature).
+ */
+void LayoutOptimizer::run_chain(Chain& chain, size_t first_step, size_t steps,
+                                const Options& options, double temperature,
+                                chrono::steady_clock::time_point begin) const
+{
+  double current = temperature;
+
+  for (size_t step = 0; step < steps; ++step) {
+
+    if (step % STEPS_PER_CHECK == 0) {
+      double done = 0;
+      if (options.iterations != 0) {
+        done = static_cast<double>(first_step + step) /
+               static_cast<double>(options.iterations);
+      }
+      if (options.seconds > 0) {
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+        if (elapsed.count() >= options.seconds) {
+          return;
+        }
+        done = max(done, elapsed.count() / options.seconds);
+      }
+      current = temperature * pow(FINAL_TEMPERATURE, min(1.0, done));
+    }
+
+    if (!propose(chain, options.max_window)) {
+      continue;
+    }
+    ++chain.proposed;
+
+    long long delta = change_cost(chain);
+    bool accept = delta <= 0;
+    if (!accept && current > 0) {
+      double uniform = static_cast<double>(next_random(chain.random) >> 11) *
+                       (1.0 / 9007199254740992.0);
+      accept = uniform < exp(-static_cast<double>(delta) / current);
+    }
+    if (!accept) {
+      continue;
+    }
+
+    ++chain.accepted;
+    for (size_t c = 0; c < chain.changed.size(); ++c) {
+      size_t i = chain.changed[c];
+      chain.slot_of[i] = chain.new_slot[i];
+      chain.order[chain.new_slot[i]] = i;
+    }
+    chain.cost += delta;
+
+    if (chain.cost < chain.best_cost) {
+      chain.best_cost = chain.cost;
+      chain.best_order = chain.order;
+    }
+  }
+}
+
+/**
+ * function: pick_temperature(size_t max_window, unsigned long long seed)
+ *
+ * Uses the average size of the change of random proposals from the best
+ * layout, so that at the start about a third of the worse changes are
+ * accepted.
+ */
+double LayoutOptimizer::pick_temperature(size_t max_window,
+                                         unsigned long long seed) const
+{
+  vector<size_t> order(LBAs_.size());
+  for (size_t slot = 0; slot < best_layout_.size(); ++slot) {
+    order[slot] = index_of_.find(best_layout_[slot])->second;
+  }
+
+  Chain chain;
+  reset_chain(chain, order);
+  chain.random = seed_random(seed);
+
+  double total = 0;
+  size_t samples = 0;
+  for (size_t s = 0; s < TEMPERATURE_SAMPLES; ++s) {
+    if (propose(chain, max_window)) {
+      total += fabs(static_cast<double>(change_cost(chain)));
+      ++samples;
+    }
+  }
+
+  if (samples == 0 || total == 0) {
+    return 1;
+  }
+  return total / static_cast<double>(samples);
+}
+
+/**
+ * function: optimize(const Options& options)
+ *
+ * Every chain starts from the best layout found so far. The chains are run
+ * exchange_interval steps at a time, one thread each, and after each round
+ * the best layout of all of them is kept and any chain whose current layout
+ * is worse continues from it. Chain c always uses seed + c, so with a step
+ * limit and no time limit the result is the same on every run.
+ */
+const vector<size_t>& LayoutOptimizer::optimize(const Options& options)
+{
+  proposed_ = 0;
+  accepted_ = 0;
+  if (options.iterations == 0 && options.seconds <= 0) {
+    return best_layout_;
+  }
+
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+  unsigned num_chains = options.num_threads;
+  if (num_chains == 0) {
+    num_chains = max(1u, thread::hardware_concurrency());
+  }
+  size_t interval = max(size_t(1), options.exchange_interval);
+
+  double temperature = options.temperature;
+  if (temperature <= 0) {
+    temperature = pick_temperature(options.max_window, options.seed);
+  }
+
+  vector<size_t> best_order(LBAs_.size());
+  for (size_t slot = 0; slot < best_layout_.size(); ++slot) {
+    best_order[slot] = index_of_.find(best_layout_[slot])->second;
+  }
+
+  vector<Chain> chains(num_chains);
+  for (unsigned c = 0; c < num_chains; ++c) {
+    reset_chain(chains[c], best_order);
+    chains[c].random = seed_random(options.seed + c);
+    chains[c].proposed = 0;
+    chains[c].accepted = 0;
+  }
+
+  size_t step = 0;
+  while (options.iterations == 0 || step < options.iterations) {
+
+    size_t steps = interval;
+    if (options.iterations != 0) {
+      steps = min(steps, options.iterations - step);
+    }
+
+    if (num_chains == 1) {
+      run_chain(chains[0], step, steps, options, temperature, begin);
+    } else {
+      vector<thread> workers;
+      for (unsigned c = 0; c < num_chains; ++c) {
+        workers.push_back(thread([this, &chains, &options, step, steps,
+                                  temperature, begin, c]() {
+          run_chain(chains[c], step, steps, options, temperature, begin);
+        }));
+      }
+      for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+      }
+    }
+    step += steps;
+
+    // Exchange: keep the best layout and restart the worse chains from it.
+    size_t best_chain = 0;
+    for (unsigned c = 1; c < num_chains; ++c) {
+      if (chains[c].best_cost < chains[best_chain].best_cost) {
+        best_chain = c;
+      }
+    }
+    if (chains[best_chain].best_cost < best_cost_) {
+      best_cost_ = chains[best_chain].best_cost;
+      best_order = chains[best_chain].best_order;
+    }
+    for (unsigned c = 0; c < num_chains; ++c) {
+      if (chains[c].cost > best_cost_) {
+        size_t proposed = chains[c].proposed;
+        size_t accepted = chains[c].accepted;
+        unsigned long long random = chains[c].random;
+        reset_chain(chains[c], best_order);
+        chains[c].proposed = proposed;
+        chains[c].accepted = accepted;
+        chains[c].random = random;
+      }
+    }
+
+    if (options.seconds > 0) {
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+      if (elapsed.count() >= options.seconds) {
+        break;
+      }
+    }
+  }
+
+  for (size_t slot = 0; slot < best_order.size(); ++slot) {
+    best_layout_[slot] = LBAs_[best_order[slot]];
+  }
+  for (unsigned c = 0; c < num_chains; ++c) {
+    proposed_ += chains[c].proposed;
+    accepted_ += chains[c].accepted;
+  }
+
+  return best_layout_;
+}
+
+/**
+ * function: seek_distance(const vector<size_t>& LBA_vector)
+ */
+size_t LayoutOptimizer::seek_distance(const vector<size_t>& LBA_vector) const
+{
+  vector<size_t> order(LBA_vector.size());
+  for (size_t slot = 0; slot < LBA_vector.size(); ++slot) {
+    order[slot] = index_of_.find(LBA_vector[slot])->second;
+  }
+
+  return fixed_distance_ + static_cast<size_t>(order_cost(order));
+}
+
+/**
+ * function: initial_seek_distance()
+ */
+size_t LayoutOptimizer::initial_seek_distance() const
+{
+  return fixed_distance_ + static_cast<size_t>(initial_cost_);
+}
+
+/**
+ * function: best_layout()
+ */
+const vector<size_t>& LayoutOptimizer::best_layout() const
+{
+  return best_layout_;
+}
+
+/**
+ * function: best_seek_distance()
+ */
+size_t LayoutOptimizer::best_seek_distance() const
+{
+  return fixed_distance_ + static_cast<size_t>(best_cost_);
+}
+
+/**
+ * function: proposed()
+ */
+size_t LayoutOptimizer::proposed() const
+{
+  return proposed_;
+}
+
+/**
+ * function: accepted()
+ */
+size_t LayoutOptimizer::accepted() const
+{
+  return accepted_;
+}
@@ -0,0 +1,200 @@
+/**
+* LayoutOptimizer.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called LayoutOptimizer, which improves an LBA_vector for
+* change_locations by simulated annealing. It starts from any order of the
+* hot LBAs, such as the frequency or cluster orders, and tries to lower the
+* total seek distance of the trace by
+*
+* (1) swapping two LBAs,
+*
+* (2) moving one LBA a few slots forward or back, or
+*
+* (3) reversing a short segment of the vector.
+*
+* Only the order of the hot LBAs changes, so every other LBA stays where
+* change_locations(LBA_vector, start) puts it. The trace is turned into the
+* table of transitions once, and each hot LBA keeps a list of its transitions
+* to other hot LBAs and to the fixed locations of the other LBAs. A proposed
+* change is then scored by its exact change in seek distance, which only
+* reads the transitions of the LBAs that moved, instead of computing
+* total_seek_distance again.
+*
+* Several independent chains are run at the same time, one per thread. Every
+* exchange_interval steps the chains stop, and the chains that are worse than
+* the best layout found so far continue from it. The search ends when either
+* the number of steps per chain or the time limit is reached.
+*
+* NOTE: Like LayoutMap, the locations are those change_locations gives on a
+* freshly read in trace, and every LBA in LBA_vector is assumed to occur in
+* the trace and to be in LBA_vector only once.
+*
+*/
+
+#ifndef LAYOUTOPTIMIZER_HPP_INCLUDED
+#define LAYOUTOPTIMIZER_HPP_INCLUDED 1
+
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "TraceSet.hpp"
+
+class LayoutOptimizer{
+
+public:
+
+  /*
+   * struct: Options
+   *
+   * How long to search and how.
+   */
+  struct Options {
+
+    std::size_t iterations;     // Steps per chain, 0 for no limit
+
+    double seconds;             // Time limit in seconds, 0 for no limit
+
+    unsigned num_threads;       // Number of chains, 0 for every hardware
+                                // thread
+
+    std::size_t exchange_interval; // Steps between exchanges of layouts
+
+    std::size_t max_window;     // Longest move or reversed segment
+
+    double temperature;         // Starting temperature, 0 to pick one from
+                                // the sizes of random changes
+
+    unsigned long long seed;    // Seed of the random numbers of chain 0,
+                                // chain c uses seed + c
+
+    ///<Constructor sets the defaults: 100000 steps, no time limit, every
+    ///<hardware thread, exchanges every 10000 steps, windows of 32 slots,
+    ///<and a picked temperature.
+    Options();
+
+  };
+
+  ///<Constructor builds the lists of transitions of the LBAs in LBA_vector,
+  ///<where the i-th LBA of LBA_vector is at location start + i.
+  LayoutOptimizer(TraceSet& trace, const std::vector<std::size_t>& LBA_vector,
+                  std::size_t start);
+
+  /// Runs the search and returns the best LBA_vector found.
+  const std::vector<std::size_t>& optimize(const Options& options);
+
+  /// Returns the total seek distance of the LBA_vector given to the
+  /// constructor.
+  std::size_t initial_seek_distance() const;
+
+  /// Returns the best LBA_vector found so far.
+  const std::vector<std::size_t>& best_layout() const;
+
+  /// Returns the total seek distance of best_layout().
+  std::size_t best_seek_distance() const;
+
+  /// Returns the total seek distance of the given order of the same LBAs,
+  /// computed from the lists of transitions.
+  std::size_t seek_distance(const std::vector<std::size_t>& LBA_vector) const;
+
+  /// Returns the number of changes proposed and accepted by the last call to
+  /// optimize, over every chain.
+  std::size_t proposed() const;
+  std::size_t accepted() const;
+
+private:
+
+  /*
+   * struct: Chain
+   *
+   * The state of one chain: order holds indices of hot LBAs by slot, and
+   * slot_of is its inverse.
+   */
+  struct Chain {
+
+    std::vector<std::size_t> order;
+    std::vector<std::size_t> slot_of;
+    long long cost;
+
+    std::vector<std::size_t> best_order;
+    long long best_cost;
+
+    std::vector<std::size_t> stamp;      // Marks the LBAs of a change
+    std::vector<std::size_t> new_slot;   // New slots of the marked LBAs
+    std::vector<std::size_t> changed;    // The marked LBAs
+    std::size_t epoch;
+
+    unsigned long long random;
+    std::size_t proposed;
+    std::size_t accepted;
+
+  };
+
+  // Returns the cost of an order of hot LBA indices, without the transitions
+  // between two other LBAs.
+  long long order_cost(const std::vector<std::size_t>& order) const;
+
+  // Returns the change in cost if the LBAs in chain.changed move to their
+  // chain.new_slot.
+  long long change_cost(const Chain& chain) const;
+
+  // Proposes one random change, marking the moved LBAs in chain. Returns
+  // false if the change does nothing.
+  bool propose(Chain& chain, std::size_t max_window) const;
+
+  // Runs up to steps steps of one chain, the first being step first_step of
+  // the search, and stops early if the time limit is reached.
+  void run_chain(Chain& chain, std::size_t first_step, std::size_t steps,
+                 const Options& options, double temperature,
+                 std::chrono::steady_clock::time_point begin) const;
+
+  // Sets up a chain at the given order of hot LBA indices.
+  void reset_chain(Chain& chain, const std::vector<std::size_t>& order) const;
+
+  // Returns the average size of the change of random proposals from the
+  // starting order.
+  double pick_temperature(std::size_t max_window, unsigned long long seed)
+      const;
+
+  // LBAs_ are the hot LBAs in the order given to the constructor, index i
+  // of the lists below is LBAs_[i].
+  std::vector<std::size_t> LBAs_;
+
+  // index_of_ is a hashtable where the keys are the hot LBAs and the values
+  // are their indices in LBAs_.
+  std::unordered_map<std::size_t, std::size_t> index_of_;
+
+  // hot_offsets_, hot_neighbors_ and hot_counts_ hold the transitions between
+  // two hot LBAs, neighbors of LBA i are at hot_offsets_[i] up to
+  // hot_offsets_[i + 1].
+  std::vector<std::size_t> hot_offsets_;
+  std::vector<std::size_t> hot_neighbors_;
+  std::vector<std::size_t> hot_counts_;
+
+  // cold_offsets_, cold_locations_ and cold_counts_ hold the transitions from
+  // a hot LBA to the fixed location of another LBA.
+  std::vector<std::size_t> cold_offsets_;
+  std::vector<std::size_t> cold_locations_;
+  std::vector<std::size_t> cold_counts_;
+
+  // start_ is the location of slot 0.
+  std::size_t start_;
+
+  // fixed_distance_ is the seek distance of transitions between two LBAs
+  // that are not hot.
+  std::size_t fixed_distance_;
+
+  long long initial_cost_;
+
+  std::vector<std::size_t> best_layout_;
+  long long best_cost_;
+
+  std::size_t proposed_;
+  std::size_t accepted_;
+
+};
+
+#endif // LAYOUTOPTIMIZER_HPP_INCLUDED
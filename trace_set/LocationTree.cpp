@@ -0,0 +1,515 @@
+/*
+* LocationTree.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the LocationTree class, a treap of runs of slots that
+* moves k LBAs in O(k log n) expected time, and writes the slots whose
+* location changed back to the locations_ vector in time proportional to how
+* many there are.
+*
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "LocationTree.hpp"
+
+using namespace std;
+
+// Index used for a missing child, parent or root
+static const size_t NONE = static_cast<size_t>(-1);
+
+// Constructor for LocationTree
+LocationTree::LocationTree(vector<TraceSet::LBA_location>& locations,
+                           vector<TraceSet::blockLBA>& mapLBA):
+  base_(locations),
+  mapLBA_(mapLBA),
+  root_{NONE},
+  seed_{0x2545F4914F6CDD1DULL}
+{
+  reset();
+}
+
+/**
+ * function: reset()
+ *
+ * Forgets every node and makes a single run of all of base_.
+ */
+void LocationTree::reset()
+{
+  nodes_.clear();
+  runs_.clear();
+  fresh_.clear();
+  root_ = NONE;
+
+  if (!base_.empty()) {
+    root_ = new_node(base_.size(), 0, 0, false);
+    runs_[0] = root_;
+  }
+}
+
+/**
+ * function: new_node(size_t weight, size_t base_start, size_t LBA,
+ *                    bool fresh)
+ *
+ * Priorities come from a xorshift generator with a fixed seed, so the shape
+ * of the tree is the same on every run.
+ */
+size_t LocationTree::new_node(size_t weight, size_t base_start, size_t LBA,
+                              bool fresh)
+{
+  seed_ ^= seed_ << 13;
+  seed_ ^= seed_ >> 7;
+  seed_ ^= seed_ << 17;
+
+  Node node;
+  node.left = NONE;
+  node.right = NONE;
+  node.parent = NONE;
+  node.weight = weight;
+  node.total = weight;
+  node.base_start = base_start;
+  node.LBA = LBA;
+  node.priority = static_cast<uint32_t>(seed_ >> 32);
+  node.fresh = fresh;
+
+  nodes_.push_back(node);
+  return nodes_.size() - 1;
+}
+
+/**
+ * function: size()
+ *
+ * Returns the number of slots in the tree.
+ */
+size_t LocationTree::size() const
+{
+  return total(root_);
+}
+
+/**
+ * function: total(size_t node)
+ *
+ * Returns 0 for a missing node.
+ */
+size_t LocationTree::total(size_t node) const
+{
+  return node == NONE ? 0 : nodes_[node].total;
+}
+
+/**
+ * function: update(size_t node)
+ *
+ * Recomputes the total of node from its weight and its children.
+ */
+void LocationTree::update(size_t node)
+{
+  nodes_[node].total = nodes_[node].weight + total(nodes_[node].left) +
+                       total(nodes_[node].right);
+}
+
+/**
+ * function: set_left(size_t node, size_t child)
+ *
+ * Makes child the left child of node.
+ */
+void LocationTree::set_left(size_t node, size_t child)
+{
+  nodes_[node].left = child;
+  if (child != NONE) {
+    nodes_[child].parent = node;
+  }
+}
+
+/**
+ * function: set_right(size_t node, size_t child)
+ *
+ * Makes child the right child of node.
+ */
+void LocationTree::set_right(size_t node, size_t child)
+{
+  nodes_[node].right = child;
+  if (child != NONE) {
+    nodes_[child].parent = node;
+  }
+}
+
+/**
+ * function: split(size_t node, size_t count, size_t& left, size_t& right)
+ *
+ * When count falls inside the run held by node, the run is cut: node keeps
+ * the first part and a new node with the rest is merged in front of node's
+ * right subtree. Fresh nodes hold one slot so they are never cut.
+ */
+void LocationTree::split(size_t node, size_t count, size_t& left,
+                         size_t& right)
+{
+  if (node == NONE) {
+    left = NONE;
+    right = NONE;
+    return;
+  }
+
+  size_t left_total = total(nodes_[node].left);
+  size_t weight = nodes_[node].weight;
+
+  if (count <= left_total) {
+
+    size_t inner_right;
+    split(nodes_[node].left, count, left, inner_right);
+    set_left(node, inner_right);
+    update(node);
+    right = node;
+
+  } else if (count >= left_total + weight) {
+
+    size_t inner_left;
+    split(nodes_[node].right, count - left_total - weight, inner_left, right);
+    set_right(node, inner_left);
+    update(node);
+    left = node;
+
+  } else {
+
+    size_t offset = count - left_total;
+    size_t rest = new_node(weight - offset, nodes_[node].base_start + offset,
+                           0, false);
+    runs_[nodes_[rest].base_start] = rest;
+
+    size_t old_right = nodes_[node].right;
+    nodes_[node].weight = offset;
+    set_right(node, NONE);
+    update(node);
+
+    if (old_right != NONE) {
+      nodes_[old_right].parent = NONE;
+    }
+    right = merge(rest, old_right);
+    left = node;
+
+  }
+
+  if (left != NONE) {
+    nodes_[left].parent = NONE;
+  }
+  if (right != NONE) {
+    nodes_[right].parent = NONE;
+  }
+}
+
+/**
+ * function: merge(size_t left, size_t right)
+ *
+ * The root with the larger priority stays on top.
+ */
+size_t LocationTree::merge(size_t left, size_t right)
+{
+  if (left == NONE) {
+    return right;
+  }
+  if (right == NONE) {
+    return left;
+  }
+
+  if (nodes_[left].priority > nodes_[right].priority) {
+    set_right(left, merge(nodes_[left].right, right));
+    update(left);
+    nodes_[left].parent = NONE;
+    return left;
+  }
+
+  set_left(right, merge(left, nodes_[right].left));
+  update(right);
+  nodes_[right].parent = NONE;
+  return right;
+}
+
+/**
+ * function: rank(size_t node)
+ *
+ * Counts the slots before node: those in its left subtree, plus for every
+ * ancestor it is to the right of, the ancestor and the ancestor's left
+ * subtree.
+ */
+size_t LocationTree::rank(size_t node) const
+{
+  size_t position = total(nodes_[node].left);
+
+  while (nodes_[node].parent != NONE) {
+    size_t parent = nodes_[node].parent;
+    if (nodes_[parent].right == node) {
+      position += total(nodes_[parent].left) + nodes_[parent].weight;
+    }
+    node = parent;
+  }
+
+  return position;
+}
+
+/**
+ * function: find_slot(size_t LBA, size_t& node, size_t& offset)
+ *
+ * A LBA that was moved into the tree without a slot in base_ is found in
+ * fresh_. Otherwise its slot in base_ is the location mapLBA_ gives it, as
+ * long as that slot is used by the LBA, and the run holding that slot is the
+ * one with the last first slot at or before it.
+ */
+bool LocationTree::find_slot(size_t LBA, size_t& node, size_t& offset) const
+{
+  unordered_map<size_t, size_t>::const_iterator found = fresh_.find(LBA);
+  if (found != fresh_.end()) {
+    node = found->second;
+    offset = 0;
+    return true;
+  }
+
+  if (LBA >= mapLBA_.size()) {
+    return false;
+  }
+
+  size_t slot = mapLBA_[LBA].location;
+  if (slot >= base_.size() || !base_[slot].used || base_[slot].LBA != LBA) {
+    return false;
+  }
+
+  map<size_t, size_t>::const_iterator run = runs_.upper_bound(slot);
+  if (run == runs_.begin()) {
+    return false;
+  }
+  --run;
+
+  node = run->second;
+  offset = slot - nodes_[node].base_start;
+
+  return offset < nodes_[node].weight;
+}
+
+/**
+ * function: location(size_t LBA)
+ *
+ * Returns the location of the slot of the LBA, or size() if it has none.
+ */
+size_t LocationTree::location(size_t LBA) const
+{
+  size_t node;
+  size_t offset;
+  if (!find_slot(LBA, node, offset)) {
+    return size();
+  }
+
+  return rank(node) + offset;
+}
+
+/**
+ * function: drop(size_t node)
+ *
+ * Removes every node in the subtree from runs_ and fresh_ so that their
+ * slots can no longer be found.
+ */
+void LocationTree::drop(size_t node)
+{
+  vector<size_t> stack;
+  if (node != NONE) {
+    stack.push_back(node);
+  }
+
+  while (!stack.empty()) {
+
+    size_t current = stack.back();
+    stack.pop_back();
+
+    if (nodes_[current].fresh) {
+      unordered_map<size_t, size_t>::iterator found =
+          fresh_.find(nodes_[current].LBA);
+      if (found != fresh_.end() && found->second == current) {
+        fresh_.erase(found);
+      }
+    } else {
+      runs_.erase(nodes_[current].base_start);
+    }
+
+    if (nodes_[current].left != NONE) {
+      stack.push_back(nodes_[current].left);
+    }
+    if (nodes_[current].right != NONE) {
+      stack.push_back(nodes_[current].right);
+    }
+  }
+}
+
+/**
+ * function: move_to(const vector<size_t>& LBA_vector, size_t start)
+ *
+ * Does the three steps of change_locations:
+ *
+ * (1) The slot of each LBA in LBA_vector is cut out of the tree. A LBA with no
+ * slot is given a fresh one.
+ *
+ * (2) remove_LBA_locations shortens locations_ by LBA_vector.size() even if
+ * fewer slots were removed, so the missing number of slots is cut off the
+ * end of the tree.
+ *
+ * (3) The cut out slots are joined in order and put back at start.
+ */
+void LocationTree::move_to(const vector<size_t>& LBA_vector, size_t start)
+{
+  vector<size_t> moved;
+  unordered_set<size_t> seen;
+  size_t removed = 0;
+
+  for (size_t i = 0; i < LBA_vector.size(); ++i) {
+
+    size_t LBA = LBA_vector[i];
+    size_t node;
+    size_t offset;
+
+    if (seen.insert(LBA).second && find_slot(LBA, node, offset)) {
+
+      size_t position = rank(node) + offset;
+
+      size_t before;
+      size_t rest;
+      size_t slot;
+      size_t after;
+      split(root_, position, before, rest);
+      split(rest, 1, slot, after);
+      root_ = merge(before, after);
+
+      moved.push_back(slot);
+      ++removed;
+
+    } else {
+
+      size_t slot = new_node(1, 0, LBA, true);
+      fresh_[LBA] = slot;
+      moved.push_back(slot);
+
+    }
+  }
+
+  if (LBA_vector.size() > removed) {
+    size_t extra = LBA_vector.size() - removed;
+    size_t keep = size() > extra ? size() - extra : 0;
+
+    size_t tail;
+    split(root_, keep, root_, tail);
+    drop(tail);
+  }
+
+  size_t inserted = NONE;
+  for (size_t i = 0; i < moved.size(); ++i) {
+    inserted = merge(inserted, moved[i]);
+  }
+
+  size_t before;
+  size_t after;
+  split(root_, min(start, size()), before, after);
+  root_ = merge(merge(before, inserted), after);
+}
+
+/**
+ * function: apply()
+ *
+ * Writes the moves back without telling the caller where.
+ */
+void LocationTree::apply()
+{
+  size_t low;
+  size_t high;
+  apply(low, high);
+}
+
+/**
+ * function: apply(size_t& low, size_t& high)
+ *
+ * A run of base_ whose first slot is at its own index in the tree has not
+ * moved, so only the slots from the first node that is not in place to the
+ * end of the last one can differ from base_. Those slots are copied out of
+ * the tree in order into a buffer, which is then written over that range of
+ * base_, and only the used slots of the range are given their index as their
+ * location in mapLBA_. So a move writes the slots from the lowest to the
+ * highest of start and the old slots of the moved LBAs, rather than all of
+ * base_. The tree only grows past base_ when more LBAs with no slot are moved
+ * than there are slots, then base_ grows with it.
+ *
+ * [low, high) is set to that range, so that the caller can update anything
+ * else indexed by the slots.
+ */
+void LocationTree::apply(size_t& low, size_t& high)
+{
+  // The nodes in order
+  vector<size_t> order;
+  vector<size_t> stack;
+  size_t node = root_;
+  while (node != NONE || !stack.empty()) {
+
+    while (node != NONE) {
+      stack.push_back(node);
+      node = nodes_[node].left;
+    }
+
+    node = stack.back();
+    stack.pop_back();
+    order.push_back(node);
+    node = nodes_[node].right;
+  }
+
+  // [low, high) is the range of slots that are not in place
+  low = NONE;
+  high = 0;
+  size_t position = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const Node& run = nodes_[order[i]];
+    if (run.fresh || run.base_start != position) {
+      if (low == NONE) {
+        low = position;
+      }
+      high = position + run.weight;
+    }
+    position += run.weight;
+  }
+
+  if (low == NONE) {
+    low = 0;
+    reset();
+    return;
+  }
+
+  vector<TraceSet::LBA_location> changed;
+  changed.reserve(high - low);
+  position = 0;
+  for (size_t i = 0; i < order.size() && position < high; ++i) {
+    const Node& run = nodes_[order[i]];
+    if (position >= low) {
+      if (run.fresh) {
+        TraceSet::LBA_location slot;
+        slot.LBA = run.LBA;
+        slot.used = true;
+        changed.push_back(slot);
+      } else {
+        changed.insert(changed.end(), base_.begin() + run.base_start,
+                       base_.begin() + run.base_start + run.weight);
+      }
+    }
+    position += run.weight;
+  }
+
+  if (base_.size() < high) {
+    base_.resize(high);
+  }
+  copy(changed.begin(), changed.end(), base_.begin() + low);
+
+  for (size_t location = low; location < high; ++location) {
+    if (base_[location].used && base_[location].LBA < mapLBA_.size()) {
+      mapLBA_[base_[location].LBA].location = location;
+    }
+  }
+
+  reset();
+}
@@ -0,0 +1,177 @@
+/**
+* LocationTree.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called LocationTree, which keeps the order of the slots of
+* the locations_ vector of a TraceSet while LBAs are moved, without shifting
+* the vector. It is used by change_locations, and by layout searches that move
+* LBAs many times and only need the resulting locations_ vector at the end.
+*
+* The slots are kept in a treap ordered by location, where each node is a run
+* of consecutive slots of the locations_ vector the tree was built from (or a
+* single slot for a LBA that was not in the vector), and every node holds the
+* number of slots in its subtree. A new tree is one node holding every slot.
+* Moving a LBA cuts its slot out of the run it is in, so moving k LBAs with
+* move_to creates at most 2k new nodes, and the location of any LBA is found
+* by walking from its node to the root, in O(log n) expected time for both.
+*
+* move_to keeps the exact behaviour of change_locations: the slots of the
+* moved LBAs are removed, the rest keep their order and the gaps between
+* them, and the moved LBAs are inserted in order at start. apply() then
+* writes the slots whose order changed back into the locations_ vector, and
+* their locations into mapLBA_, leaving every other slot alone.
+*
+* Every slot between start and the old slot of a moved LBA is shifted by
+* that move, so apply() costs as much as that range is long. A single
+* change_locations call is therefore only O(k log n) when the moved LBAs are
+* near start. Moving hot LBAs spread over the whole disk still rewrites most
+* of locations_, once per call. Moves only get cheaper when many of them are
+* made with move_to before a single apply().
+*
+* NOTE: Like change_locations, this assumes that no LBA is moved twice by the
+* same call to move_to. The vectors given to the constructor must not be
+* changed by anything but apply() while the tree is in use, and since apply()
+* changes them through references, call fix_locations() on the TraceSet
+* afterwards so that its seek distance scans see the new locations.
+*
+*/
+
+#ifndef LOCATIONTREE_HPP_INCLUDED
+#define LOCATIONTREE_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "TraceSet.hpp"
+
+class LocationTree{
+
+public:
+
+  ///<Constructor creates a tree where every slot is where it is in locations,
+  ///<mapLBA is used to find the slot of a LBA. The tree keeps references to
+  ///<both vectors, which apply() writes to.
+  LocationTree(std::vector<TraceSet::LBA_location>& locations,
+               std::vector<TraceSet::blockLBA>& mapLBA);
+
+  /// Returns the number of slots, which is the size locations_ will have
+  /// after apply().
+  std::size_t size() const;
+
+  /// Returns the location the given LBA has in the tree, or size() if the
+  /// LBA has no slot.
+  std::size_t location(std::size_t LBA) const;
+
+  /// Does what change_locations(LBA_vector, start) does to the locations_
+  /// vector, in O(k log n) expected time for k LBAs.
+  void move_to(const std::vector<std::size_t>& LBA_vector, std::size_t start);
+
+  /// Writes the range of slots that are no longer where they were in the
+  /// locations vector back into it, and the locations of the used slots of
+  /// that range into the mapLBA vector, then starts over with one node
+  /// holding every slot.
+  void apply();
+
+  /// Does the same as apply(), and sets [low, high) to the range of slots
+  /// that was written, which is empty if no slot moved.
+  void apply(std::size_t& low, std::size_t& high);
+
+private:
+
+  /*
+   * struct: Node
+   *
+   * A run of consecutive slots in the tree.
+   */
+  struct Node {
+
+    std::size_t left;         // Index in nodes_ of the left child
+
+    std::size_t right;        // Index in nodes_ of the right child
+
+    std::size_t parent;       // Index in nodes_ of the parent
+
+    std::size_t weight;       // Number of slots in this node
+
+    std::size_t total;        // Number of slots in this subtree
+
+    std::size_t base_start;   // Index in base_ of the first slot of a run
+
+    std::size_t LBA;          // The LBA of a fresh slot
+
+    std::uint32_t priority;   // Random heap priority of the treap
+
+    bool fresh;               // True if the slot is not from base_
+
+  };
+
+  // A LocationTree refers to the vectors it applies to, so it cannot be
+  // copied.
+  LocationTree(const LocationTree&);
+  LocationTree& operator=(const LocationTree&);
+
+  /// Starts over with one node holding every slot of base_.
+  void reset();
+
+  /// Adds a node with no children to nodes_ and returns its index.
+  std::size_t new_node(std::size_t weight, std::size_t base_start,
+                       std::size_t LBA, bool fresh);
+
+  /// Returns the number of slots in the subtree rooted at node.
+  std::size_t total(std::size_t node) const;
+
+  /// Recomputes the total of node from its children.
+  void update(std::size_t node);
+
+  /// Sets the left or right child of node and the parent of the child.
+  void set_left(std::size_t node, std::size_t child);
+  void set_right(std::size_t node, std::size_t child);
+
+  /// Splits the subtree rooted at node into the first count slots and the
+  /// rest, cutting a run in two if count falls inside it.
+  void split(std::size_t node, std::size_t count, std::size_t& left,
+             std::size_t& right);
+
+  /// Joins two subtrees where every slot of left comes before right, and
+  /// returns the new root.
+  std::size_t merge(std::size_t left, std::size_t right);
+
+  /// Returns the location of the first slot of node.
+  std::size_t rank(std::size_t node) const;
+
+  /// Finds the node holding the slot of the given LBA and the offset of the
+  /// slot in it, returns false if the LBA has no slot.
+  bool find_slot(std::size_t LBA, std::size_t& node,
+                 std::size_t& offset) const;
+
+  /// Forgets every node in the subtree rooted at node.
+  void drop(std::size_t node);
+
+  // base_ is the locations_ vector the tree was built from.
+  std::vector<TraceSet::LBA_location>& base_;
+
+  // mapLBA_ is the mapLBA_ vector used to find the slot in base_ of a LBA.
+  std::vector<TraceSet::blockLBA>& mapLBA_;
+
+  // nodes_ holds every node, nodes refer to each other by index.
+  std::vector<Node> nodes_;
+
+  // runs_ maps the first slot in base_ of every run in the tree to its node.
+  std::map<std::size_t, std::size_t> runs_;
+
+  // fresh_ maps each LBA with a slot that is not from base_ to its node.
+  std::unordered_map<std::size_t, std::size_t> fresh_;
+
+  // root_ is the index of the root node, or NONE if there are no slots.
+  std::size_t root_;
+
+  // seed_ is the state of the generator for the node priorities.
+  std::uint64_t seed_;
+
+};
+
+#endif // LOCATIONTREE_HPP_INCLUDED
@@ -0,0 +1,215 @@
+/*
+* MappedTrace.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the MappedTrace class, which memory maps a trace file of
+* LBAs (in decimal) so that TraceSet can parse it in place.
+*
+*/
+
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedTrace.hpp"
+
+using namespace std;
+
+// Default constructor for MappedTrace
+MappedTrace::MappedTrace():
+  fd_{-1},
+  data_{nullptr},
+  size_{0}
+{
+  // Do nothing here
+}
+
+// Constructor which maps the given file
+MappedTrace::MappedTrace(const string& filename):
+  fd_{-1},
+  data_{nullptr},
+  size_{0}
+{
+  open(filename);
+}
+
+// Destructor for MappedTrace
+MappedTrace::~MappedTrace()
+{
+  close();
+}
+
+/**
+ * function: open(const string& filename)
+ *
+ * Opens and maps the file read only. The kernel is told that the mapping will
+ * be read sequentially so that it can read ahead aggressively.
+ *
+ * NOTE: An empty file is treated as successfully opened, but since a zero
+ * length mapping is not allowed data_ is left as nullptr.
+ */
+bool MappedTrace::open(const string& filename)
+{
+  close();
+
+  fd_ = ::open(filename.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    return false;
+  }
+
+  struct stat file_info;
+  if (fstat(fd_, &file_info) != 0) {
+    close();
+    return false;
+  }
+
+  size_ = static_cast<size_t>(file_info.st_size);
+  if (size_ == 0) {
+    return true;
+  }
+
+  void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (mapping == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  madvise(mapping, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(mapping);
+
+  return true;
+}
+
+/**
+ * function: close()
+ *
+ * Unmaps the file and closes the file descriptor if a file is open.
+ */
+void MappedTrace::close()
+{
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+
+  fd_ = -1;
+  data_ = nullptr;
+  size_ = 0;
+}
+
+/**
+ * function: is_open()
+ *
+ * Returns true if a file is currently mapped.
+ */
+bool MappedTrace::is_open() const
+{
+  return fd_ >= 0;
+}
+
+/**
+ * function: begin()
+ *
+ * Returns a pointer to the first byte of the mapping.
+ */
+const char* MappedTrace::begin() const
+{
+  return data_;
+}
+
+/**
+ * function: end()
+ *
+ * Returns a pointer one past the last byte of the mapping.
+ */
+const char* MappedTrace::end() const
+{
+  return data_ + size_;
+}
+
+/**
+ * function: size()
+ *
+ * Returns the number of bytes that are mapped.
+ */
+size_t MappedTrace::size() const
+{
+  return size_;
+}
+
+/**
+ * function: find_newline(const char* begin, const char* end)
+ *
+ * Returns a pointer to the first newline in [begin, end), or end if there
+ * is none. Scans 16 bytes at a time when SSE2 is available.
+ */
+const char* MappedTrace::find_newline(const char* begin, const char* end)
+{
+#if defined(__SSE2__)
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (end - begin >= 16) {
+
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+    if (mask != 0) {
+      return begin + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+
+    begin += 16;
+  }
+#endif
+
+  const char* found = static_cast<const char*>(
+      memchr(begin, '\n', static_cast<size_t>(end - begin)));
+
+  return found == nullptr ? end : found;
+}
+
+/**
+ * function: count_lines(const char* begin, const char* end)
+ *
+ * Counts the newlines in [begin, end) 16 bytes at a time and adds one if the
+ * last line is not terminated by a newline.
+ */
+size_t MappedTrace::count_lines(const char* begin, const char* end)
+{
+  if (begin == end) {
+    return 0;
+  }
+
+  size_t lines = 0;
+  const char* scan = begin;
+
+#if defined(__SSE2__)
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (end - scan >= 16) {
+
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(scan));
+    unsigned mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    lines += static_cast<size_t>(__builtin_popcount(mask));
+
+    scan += 16;
+  }
+#endif
+
+  for (; scan != end; ++scan) {
+    if (*scan == '\n') {
+      ++lines;
+    }
+  }
+
+  if (*(end - 1) != '\n') {
+    ++lines;
+  }
+
+  return lines;
+}
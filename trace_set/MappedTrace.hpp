@@ -0,0 +1,300 @@
+/**
+* MappedTrace.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called MappedTrace, a small wrapper that memory maps a trace
+* file so that the LBAs in it can be parsed without copying the file through
+* an ifstream one char at a time.
+*
+* The trace files are in the same format that TraceSet::readIn expects, each
+* line contains a single LBA written in decimal. Newlines are found by
+* comparing 16 bytes of the mapping at a time against '\n' (using SSE2 when the
+* compiler targets it, otherwise memchr), and the digits of each line are
+* accumulated straight into a size_t so that no std::string is built per line.
+*
+* NOTE: A line with no digits in it (e.g. a blank line) is skipped, and parsing
+* of a line stops at the first character which is not a digit, so a trailing
+* '\r' or extra columns after the LBA are ignored. Traces that also give the
+* length of each request, as a second column, are read with for_each_request.
+*
+* NOTE: A value too large for a size_t throws std::out_of_range, the same
+* exception that stoull throws for it in TraceSet::readIn, so the loaders
+* agree on which traces they accept.
+*
+*/
+
+#ifndef MAPPEDTRACE_HPP_INCLUDED
+#define MAPPEDTRACE_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+class MappedTrace{
+
+public:
+
+  ///<Constructor creates a MappedTrace which has no file mapped.
+  MappedTrace();
+
+  ///<Constructor which maps the file called filename, is_open() can be used
+  ///<to check if this succeeded.
+  explicit MappedTrace(const std::string& filename);
+
+  ///<Destructor, unmaps the file if one is mapped.
+  ~MappedTrace();
+
+  /// Maps the file called filename read only, unmapping any file that was
+  /// previously mapped. Returns false if the file could not be opened or
+  /// mapped.
+  bool open(const std::string& filename);
+
+  /// Unmaps the currently mapped file.
+  void close();
+
+  /// Returns true if a file is currently mapped.
+  bool is_open() const;
+
+  /// Returns a pointer to the first byte of the mapped file.
+  const char* begin() const;
+
+  /// Returns a pointer one past the last byte of the mapped file.
+  const char* end() const;
+
+  /// Returns the size of the mapped file in bytes.
+  std::size_t size() const;
+
+  /// Returns a pointer to the first '\n' in [begin, end), or end if there is
+  /// no newline in the range.
+  static const char* find_newline(const char* begin, const char* end);
+
+  /// Returns the number of lines in [begin, end), counting a final line that
+  /// is not terminated by a newline. This is an upper bound on the number of
+  /// LBAs for_each_LBA will find and is used to reserve space before a trace
+  /// is parsed.
+  static std::size_t count_lines(const char* begin, const char* end);
+
+  /// Parses the line [begin, end) which should not contain a newline, and
+  /// sets LBA to the decimal value at its start. Returns false if the line
+  /// contains no digits, and throws std::out_of_range if the value does not
+  /// fit in a size_t.
+  static bool parse_LBA(const char* begin, const char* end, std::size_t& LBA);
+
+  /// Parses the line [begin, end) like parse_LBA, and also sets length to
+  /// the decimal value after the LBA, the number of blocks the request reads
+  /// or writes. If the line has no second value, or it is 0, length is 1.
+  /// Either value not fitting in a size_t throws std::out_of_range.
+  static bool parse_request(const char* begin, const char* end,
+                            std::size_t& LBA, std::size_t& length);
+
+  /// Appends the decimal digit to value, throwing std::out_of_range if the
+  /// result does not fit in a size_t.
+  static void append_digit(std::size_t& value, unsigned digit);
+
+  /// Calls callback(LBA) for the LBA on every line in [begin, end) in the
+  /// order that they appear.
+  template <typename Callback>
+  static void for_each_LBA(const char* begin, const char* end,
+                           Callback callback);
+
+  /// Calls callback(LBA, length) for the request on every line in
+  /// [begin, end) in the order that they appear.
+  template <typename Callback>
+  static void for_each_request(const char* begin, const char* end,
+                               Callback callback);
+
+  /// Calls callback(line_begin, line_end) for every line in [begin, end),
+  /// without the newline, including a last line with no newline.
+  template <typename Callback>
+  static void for_each_line(const char* begin, const char* end,
+                            Callback callback);
+
+private:
+
+  // A MappedTrace owns its mapping, so it cannot be copied.
+  MappedTrace(const MappedTrace&);
+  MappedTrace& operator=(const MappedTrace&);
+
+  int fd_;                    // File descriptor of the mapped file, -1 if
+                              // no file is open.
+
+  const char* data_;          // Start of the mapping, nullptr if the file is
+                              // empty or no file is open.
+
+  std::size_t size_;          // Size of the mapping in bytes.
+
+};
+
+/**
+ * function: append_digit(size_t& value, unsigned digit)
+ *
+ * Only a value above the largest size_t divided by 10 can overflow, so the
+ * common case costs one compare.
+ */
+inline void MappedTrace::append_digit(std::size_t& value, unsigned digit)
+{
+  const std::size_t limit = static_cast<std::size_t>(-1) / 10;
+
+  if (value >= limit &&
+      (value > limit || digit > static_cast<std::size_t>(-1) % 10)) {
+    throw std::out_of_range("MappedTrace::append_digit");
+  }
+
+  value = value * 10 + digit;
+}
+
+/**
+ * function: parse_LBA(const char* begin, const char* end, size_t& LBA)
+ *
+ * Skips leading spaces and tabs, then accumulates decimal digits until the
+ * first character that is not a digit.
+ */
+inline bool MappedTrace::parse_LBA(const char* begin, const char* end,
+                                   std::size_t& LBA)
+{
+  while (begin != end && (*begin == ' ' || *begin == '\t')) {
+    ++begin;
+  }
+
+  std::size_t value = 0;
+  const char* digits_start = begin;
+  while (begin != end && static_cast<unsigned char>(*begin - '0') < 10) {
+    append_digit(value, static_cast<unsigned>(*begin - '0'));
+    ++begin;
+  }
+
+  LBA = value;
+  return begin != digits_start;
+}
+
+/**
+ * function: parse_request(const char* begin, const char* end, size_t& LBA,
+ *                         size_t& length)
+ *
+ * The length is separated from the LBA by spaces, tabs or a comma.
+ */
+inline bool MappedTrace::parse_request(const char* begin, const char* end,
+                                       std::size_t& LBA, std::size_t& length)
+{
+  while (begin != end && (*begin == ' ' || *begin == '\t')) {
+    ++begin;
+  }
+
+  std::size_t value = 0;
+  const char* digits_start = begin;
+  while (begin != end && static_cast<unsigned char>(*begin - '0') < 10) {
+    append_digit(value, static_cast<unsigned>(*begin - '0'));
+    ++begin;
+  }
+  if (begin == digits_start) {
+    return false;
+  }
+  LBA = value;
+
+  while (begin != end && (*begin == ' ' || *begin == '\t' || *begin == ',')) {
+    ++begin;
+  }
+  value = 0;
+  while (begin != end && static_cast<unsigned char>(*begin - '0') < 10) {
+    append_digit(value, static_cast<unsigned>(*begin - '0'));
+    ++begin;
+  }
+
+  length = value == 0 ? 1 : value;
+  return true;
+}
+
+/**
+ * function: for_each_line(const char* begin, const char* end,
+ *                         Callback callback)
+ *
+ * The mapping is scanned 16 bytes at a time, every newline in a block shows
+ * up as a set bit in a mask, so the line boundaries in the block can be walked
+ * without looking at each byte again. The bytes after the last full block are
+ * handled with memchr.
+ */
+template <typename Callback>
+void MappedTrace::for_each_line(const char* begin, const char* end,
+                                Callback callback)
+{
+  const char* line_start = begin;
+  const char* scan = begin;
+
+#if defined(__SSE2__)
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (end - scan >= 16) {
+
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(scan));
+    unsigned mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+
+    // Each set bit in mask is the offset of a newline within the block
+    while (mask != 0) {
+      const char* line_end = scan + __builtin_ctz(mask);
+      callback(line_start, line_end);
+      line_start = line_end + 1;
+      mask &= mask - 1;
+    }
+
+    scan += 16;
+  }
+#endif
+
+  while (scan != end) {
+    const char* line_end = static_cast<const char*>(
+        std::memchr(scan, '\n', static_cast<std::size_t>(end - scan)));
+    if (line_end == nullptr) {
+      break;
+    }
+    callback(line_start, line_end);
+    line_start = line_end + 1;
+    scan = line_end + 1;
+  }
+
+  // The last line of the file may not end with a newline
+  if (line_start < end) {
+    callback(line_start, end);
+  }
+}
+
+/**
+ * function: for_each_LBA(const char* begin, const char* end, Callback callback)
+ */
+template <typename Callback>
+void MappedTrace::for_each_LBA(const char* begin, const char* end,
+                               Callback callback)
+{
+  for_each_line(begin, end, [&callback](const char* line_begin,
+                                        const char* line_end) {
+    std::size_t LBA;
+    if (parse_LBA(line_begin, line_end, LBA)) {
+      callback(LBA);
+    }
+  });
+}
+
+/**
+ * function: for_each_request(const char* begin, const char* end,
+ *                            Callback callback)
+ */
+template <typename Callback>
+void MappedTrace::for_each_request(const char* begin, const char* end,
+                                   Callback callback)
+{
+  for_each_line(begin, end, [&callback](const char* line_begin,
+                                        const char* line_end) {
+    std::size_t LBA;
+    std::size_t length;
+    if (parse_request(line_begin, line_end, LBA, length)) {
+      callback(LBA, length);
+    }
+  });
+}
+
+#endif // MAPPEDTRACE_HPP_INCLUDED
@@ -0,0 +1,176 @@
+/*
+* MemoryStats.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of MemoryStats, and the replacements of the global operator
+* new and operator delete which count the allocations of the process.
+*
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "MemoryStats.hpp"
+
+using namespace std;
+
+// Counts of the calls to the global operator new and operator delete. They
+// are updated from every thread, so they are atomic, but nothing is ordered
+// by them, so relaxed increments are enough.
+static atomic<size_t> allocations(0);
+static atomic<size_t> deallocations(0);
+static atomic<size_t> allocated_bytes(0);
+
+/*
+ * function: counted_malloc(size_t size)
+ *
+ * Counts an allocation and takes its memory from malloc, which needs at least
+ * one byte so that every new returns a distinct pointer.
+ */
+static void* counted_malloc(size_t size)
+{
+  allocations.fetch_add(1, memory_order_relaxed);
+  allocated_bytes.fetch_add(size, memory_order_relaxed);
+  return malloc(size == 0 ? 1 : size);
+}
+
+/*
+ * function: counted_free(void* pointer)
+ */
+static void counted_free(void* pointer)
+{
+  if (pointer != nullptr) {
+    deallocations.fetch_add(1, memory_order_relaxed);
+    free(pointer);
+  }
+}
+
+void* operator new(size_t size)
+{
+  void* pointer = counted_malloc(size);
+  if (pointer == nullptr) {
+    throw bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](size_t size)
+{
+  void* pointer = counted_malloc(size);
+  if (pointer == nullptr) {
+    throw bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+  return counted_malloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+  return counted_malloc(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+  counted_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  counted_free(pointer);
+}
+
+void operator delete(void* pointer, const nothrow_t&) noexcept
+{
+  counted_free(pointer);
+}
+
+void operator delete[](void* pointer, const nothrow_t&) noexcept
+{
+  counted_free(pointer);
+}
+
+/**
+ * function: total(const vector<Container>& containers)
+ */
+size_t MemoryStats::total(const vector<Container>& containers)
+{
+  size_t bytes = 0;
+  for (size_t i = 0; i < containers.size(); ++i) {
+    bytes += containers[i].bytes;
+  }
+  return bytes;
+}
+
+/**
+ * function: print(ostream& out, const vector<Container>& containers)
+ */
+void MemoryStats::print(ostream& out, const vector<Container>& containers)
+{
+  for (size_t i = 0; i < containers.size(); ++i) {
+    out << containers[i].name << ": " << containers[i].bytes << " bytes\n";
+  }
+  out << "total: " << total(containers) << " bytes" << endl;
+}
+
+/**
+ * function: num_allocations()
+ */
+size_t MemoryStats::num_allocations()
+{
+  return allocations.load(memory_order_relaxed);
+}
+
+/**
+ * function: num_deallocations()
+ */
+size_t MemoryStats::num_deallocations()
+{
+  return deallocations.load(memory_order_relaxed);
+}
+
+/**
+ * function: bytes_allocated()
+ */
+size_t MemoryStats::bytes_allocated()
+{
+  return allocated_bytes.load(memory_order_relaxed);
+}
+
+/**
+ * function: peak_rss_bytes()
+ *
+ * getrusage reports the peak in kilobytes on Linux and in bytes on macOS.
+ */
+size_t MemoryStats::peak_rss_bytes()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+/**
+ * function: print(ostream& out)
+ */
+void MemoryStats::print(ostream& out)
+{
+  out << "Peak RSS: " << peak_rss_bytes() / 1e6 << " MB, allocations: "
+      << num_allocations() << " (" << bytes_allocated() / 1e6
+      << " MB), frees: " << num_deallocations() << endl;
+}
@@ -0,0 +1,127 @@
+/**
+* MemoryStats.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This file contains MemoryStats, which reports how much memory the process
+* and its data structures use, so that a run that runs out of memory on a
+* large trace can be traced back to the structure that grew.
+*
+* (1) TraceSet, FrequentPairs and ClusterParse each have a memory_usage()
+* function that returns one MemoryStats::Container per internal container,
+* with the bytes it holds. Vectors are counted by their capacity, and a
+* hashtable is counted as two containers, its array of buckets and its nodes.
+*
+* (2) MemoryStats counts every call to operator new and operator delete in
+* the process, and reads the peak resident set size from the operating
+* system. The drivers print both with print() when they exit.
+*
+* NOTE: The size of a hashtable node is an estimate, it is taken to be the key
+* and value plus a next pointer and a cached hash, which is the larger of the
+* layouts used by libc++ and libstdc++. The allocator's own rounding and
+* headers are not counted.
+*
+*/
+
+#ifndef MEMORYSTATS_HPP_INCLUDED
+#define MEMORYSTATS_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+class MemoryStats{
+
+public:
+
+  /*
+   * struct: Container
+   *
+   * The memory held by one internal container of a data structure.
+   */
+  struct Container {
+
+    const char* name;           // Name of the data member, with " buckets"
+                                // or " nodes" for the parts of a hashtable
+
+    std::size_t bytes;          // Bytes held by the container
+
+  };
+
+  /// Returns the bytes held by a vector, which is its capacity times the
+  /// size of its elements.
+  template <typename T>
+  static std::size_t vector_bytes(const std::vector<T>& container);
+
+  /// Returns the bytes held by the array of buckets of a hashtable.
+  template <typename Key, typename Value>
+  static std::size_t bucket_bytes(
+      const std::unordered_map<Key, Value>& container);
+
+  /// Returns an estimate of the bytes held by the nodes of a hashtable.
+  template <typename Key, typename Value>
+  static std::size_t node_bytes(
+      const std::unordered_map<Key, Value>& container);
+
+  /// Returns the sum of the bytes of the containers.
+  static std::size_t total(const std::vector<Container>& containers);
+
+  /// Prints one "name: bytes" line per container followed by the total.
+  static void print(std::ostream& out,
+                    const std::vector<Container>& containers);
+
+  /// Returns the number of calls to operator new (and new[]) so far.
+  static std::size_t num_allocations();
+
+  /// Returns the number of calls to operator delete (and delete[]) so far,
+  /// not counting deletes of nullptr.
+  static std::size_t num_deallocations();
+
+  /// Returns the number of bytes asked for from operator new so far.
+  static std::size_t bytes_allocated();
+
+  /// Returns the peak resident set size of the process in bytes, or 0 if
+  /// the operating system does not report it.
+  static std::size_t peak_rss_bytes();
+
+  /// Prints the peak resident set size and the allocation counts of the
+  /// process on one line.
+  static void print(std::ostream& out);
+
+};
+
+/**
+ * function: vector_bytes(const vector<T>& container)
+ */
+template <typename T>
+std::size_t MemoryStats::vector_bytes(const std::vector<T>& container)
+{
+  return container.capacity() * sizeof(T);
+}
+
+/**
+ * function: bucket_bytes(const unordered_map<Key, Value>& container)
+ *
+ * Each bucket is a pointer into the list of nodes.
+ */
+template <typename Key, typename Value>
+std::size_t MemoryStats::bucket_bytes(
+    const std::unordered_map<Key, Value>& container)
+{
+  return container.bucket_count() * sizeof(void*);
+}
+
+/**
+ * function: node_bytes(const unordered_map<Key, Value>& container)
+ */
+template <typename Key, typename Value>
+std::size_t MemoryStats::node_bytes(
+    const std::unordered_map<Key, Value>& container)
+{
+  typedef typename std::unordered_map<Key, Value>::value_type Entry;
+  return container.size() * (sizeof(Entry) + sizeof(void*) +
+                             sizeof(std::size_t));
+}
+
+#endif // MEMORYSTATS_HPP_INCLUDED
@@ -0,0 +1,132 @@
+/*
+* PlacementStrategy.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the PlacementStrategy interface and the frequency,
+* organ-pipe and cluster strategies.
+*
+*/
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "PlacementStrategy.hpp"
+
+using namespace std;
+
+// Destructor for PlacementStrategy
+PlacementStrategy::~PlacementStrategy()
+{
+  // Do nothing here
+}
+
+/**
+ * function: collect(TraceSet& trace, size_t top_k, unsigned num_threads)
+ *
+ * Ranks the LBAs of the trace and copies the table of transitions, turning
+ * IDs back into LBAs in a dictionary encoded trace.
+ */
+PlacementStats PlacementStrategy::collect(TraceSet& trace, size_t top_k,
+                                          unsigned num_threads)
+{
+  PlacementStats stats;
+
+  stats.ranked = trace.count_LBAs(num_threads);
+  FrequencyRank::rank(stats.ranked, top_k);
+
+  stats.transitions = trace.get_transitions();
+  if (trace.is_dictionary_encoded()) {
+    for (size_t i = 0; i < stats.transitions.size(); ++i) {
+      size_t low = trace.get_LBA(stats.transitions[i].low);
+      size_t high = trace.get_LBA(stats.transitions[i].high);
+      stats.transitions[i].low = low < high ? low : high;
+      stats.transitions[i].high = low < high ? high : low;
+    }
+  }
+
+  return stats;
+}
+
+/**
+ * function: FrequencyPlacement::name()
+ */
+string FrequencyPlacement::name() const
+{
+  return "frequency";
+}
+
+/**
+ * function: FrequencyPlacement::place(const PlacementStats& stats)
+ *
+ * Returns the hot LBAs in ranked order.
+ */
+vector<size_t> FrequencyPlacement::place(const PlacementStats& stats) const
+{
+  vector<size_t> LBA_vector(stats.ranked.size());
+  for (size_t i = 0; i < stats.ranked.size(); ++i) {
+    LBA_vector[i] = stats.ranked[i].LBA;
+  }
+
+  return LBA_vector;
+}
+
+/**
+ * function: OrganPipePlacement::name()
+ */
+string OrganPipePlacement::name() const
+{
+  return "organ-pipe";
+}
+
+/**
+ * function: OrganPipePlacement::place(const PlacementStats& stats)
+ *
+ * organ-pipe.py put the LBAs at even ranks at the front of the list one at a
+ * time, and the LBAs at odd ranks at the back, which gives the even ranks in
+ * reverse followed by the odd ranks. That is written directly here instead of
+ * inserting at the front of a list.
+ */
+vector<size_t> OrganPipePlacement::place(const PlacementStats& stats) const
+{
+  size_t num_LBAs = stats.ranked.size();
+  size_t num_even = (num_LBAs + 1) / 2;
+
+  vector<size_t> LBA_vector(num_LBAs);
+  for (size_t i = 0; i < num_LBAs; ++i) {
+    if (i % 2 == 0) {
+      LBA_vector[num_even - 1 - i / 2] = stats.ranked[i].LBA;
+    } else {
+      LBA_vector[num_even + i / 2] = stats.ranked[i].LBA;
+    }
+  }
+
+  return LBA_vector;
+}
+
+// Constructor for ClusterPlacement
+ClusterPlacement::ClusterPlacement(const vector<size_t>& leaf_order):
+  leaf_order_(leaf_order)
+{
+  // Do nothing here
+}
+
+/**
+ * function: ClusterPlacement::name()
+ */
+string ClusterPlacement::name() const
+{
+  return "cluster";
+}
+
+/**
+ * function: ClusterPlacement::place(const PlacementStats& stats)
+ *
+ * The order comes from the cluster tree, which was built from the trace
+ * beforehand, so the statistics are not needed.
+ */
+vector<size_t> ClusterPlacement::place(const PlacementStats&) const
+{
+  return leaf_order_;
+}
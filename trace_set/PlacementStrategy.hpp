@@ -0,0 +1,113 @@
+/**
+* PlacementStrategy.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This file contains PlacementStrategy, an interface for the ways of choosing
+* which LBAs to move to the front of the disk and in what order, which is the
+* LBA_vector given to TraceSet::change_locations, and three strategies:
+*
+* (1) FrequencyPlacement, which puts the hot LBAs in order from most to least
+* accessed.
+*
+* (2) OrganPipePlacement, which puts the most accessed LBA in the middle and
+* the others alternately before and after it, so the hot LBAs are in the order
+* ..., 5th, 3rd, 1st, 2nd, 4th, ... This is what organ-pipe.py did to a ranked
+* list.
+*
+* (3) ClusterPlacement, which uses the order of the leaves of the CLUTO
+* cluster tree, as given by ClusterParse::formatOutput.
+*
+* Every strategy is given the same PlacementStats of a trace, so new
+* strategies can be compared with these in one program, without writing the
+* LBA lists out to text files.
+*
+*/
+
+#ifndef PLACEMENTSTRATEGY_HPP_INCLUDED
+#define PLACEMENTSTRATEGY_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "TraceSet.hpp"
+#include "FrequencyRank.hpp"
+
+/*
+ * struct: PlacementStats
+ *
+ * The statistics of a trace that strategies choose placements from.
+ */
+struct PlacementStats {
+
+  // The hot LBAs of the trace from most to least accessed, with their counts.
+  std::vector<FrequencyRank::Count> ranked;
+
+  // The table of transitions of the trace, with low and high holding LBAs
+  // even when the TraceSet is dictionary encoded.
+  std::vector<TraceSet::Transition> transitions;
+
+};
+
+class PlacementStrategy{
+
+public:
+
+  ///<Destructor.
+  virtual ~PlacementStrategy();
+
+  /// Returns the name of the strategy.
+  virtual std::string name() const = 0;
+
+  /// Returns the LBAs to pass to change_locations, in order.
+  virtual std::vector<std::size_t> place(const PlacementStats& stats) const = 0;
+
+  /// Collects the statistics of the trace, keeping the top_k most accessed
+  /// LBAs as the hot LBAs (every LBA if top_k is 0). The accesses are counted
+  /// with num_threads threads, or every hardware thread if num_threads is 0.
+  static PlacementStats collect(TraceSet& trace, std::size_t top_k,
+                                unsigned num_threads);
+
+};
+
+class FrequencyPlacement : public PlacementStrategy{
+
+public:
+
+  std::string name() const;
+
+  std::vector<std::size_t> place(const PlacementStats& stats) const;
+
+};
+
+class OrganPipePlacement : public PlacementStrategy{
+
+public:
+
+  std::string name() const;
+
+  std::vector<std::size_t> place(const PlacementStats& stats) const;
+
+};
+
+class ClusterPlacement : public PlacementStrategy{
+
+public:
+
+  ///<Constructor which takes the LBAs in the order of the leaves of the
+  ///<cluster tree.
+  explicit ClusterPlacement(const std::vector<std::size_t>& leaf_order);
+
+  std::string name() const;
+
+  std::vector<std::size_t> place(const PlacementStats& stats) const;
+
+private:
+
+  // leaf_order_ is the order of the LBAs in the cluster tree.
+  std::vector<std::size_t> leaf_order_;
+
+};
+
+#endif // PLACEMENTSTRATEGY_HPP_INCLUDED
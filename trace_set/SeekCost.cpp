@@ -0,0 +1,103 @@
+/*
+* SeekCost.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the seek cost models that are not fully inline.
+*
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SeekCost.hpp"
+
+using namespace std;
+
+// Constructor for SqrtLinearSeek
+SqrtLinearSeek::SqrtLinearSeek(double settle, double sqrt_scale,
+                               double linear_scale, size_t knee):
+  settle_{settle}, sqrt_scale_{sqrt_scale}, linear_scale_{linear_scale},
+  knee_{knee}, knee_time_{settle + sqrt_scale * sqrt(static_cast<double>(knee))}
+{
+  // Do nothing here
+}
+
+// Constructor for TableSeek
+TableSeek::TableSeek()
+{
+  // Do nothing here
+}
+
+// Constructor for TableSeek
+TableSeek::TableSeek(const vector<Point>& points):
+  points_(points)
+{
+  sort_points();
+}
+
+/**
+ * function: read(istream& inputstream)
+ */
+bool TableSeek::read(istream& inputstream)
+{
+  points_.clear();
+
+  string line;
+  while (getline(inputstream, line)) {
+
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == string::npos || line[first] == '#') {
+      continue;
+    }
+
+    istringstream fields(line);
+    Point point;
+    if (!(fields >> point.distance >> point.time)) {
+      points_.clear();
+      return false;
+    }
+    points_.push_back(point);
+  }
+
+  sort_points();
+  return true;
+}
+
+/**
+ * function: points()
+ */
+const vector<TableSeek::Point>& TableSeek::points() const
+{
+  return points_;
+}
+
+/**
+ * function: sort_points()
+ *
+ * Points at distance 0 are dropped, since a seek of distance 0 takes no
+ * time, and if a distance is given twice the first one read is kept.
+ */
+void TableSeek::sort_points()
+{
+  stable_sort(points_.begin(), points_.end(),
+              [](const Point& a, const Point& b) {
+                return a.distance < b.distance;
+              });
+
+  vector<Point> kept;
+  for (size_t i = 0; i < points_.size(); ++i) {
+    if (points_[i].distance == 0) {
+      continue;
+    }
+    if (kept.empty() || kept.back().distance != points_[i].distance) {
+      kept.push_back(points_[i]);
+    }
+  }
+  points_.swap(kept);
+}
@@ -0,0 +1,193 @@
+/**
+* SeekCost.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This file contains the seek cost models used by TraceSet::seek_time and
+* TraceSet::transition_seek_time, which turn the distance of each seek into
+* an estimated time instead of adding up the distances:
+*
+* (1) LinearSeek, where the time is the distance, so the total is the total
+* seek distance.
+*
+* (2) SqrtLinearSeek, where short seeks take a settle time plus a time that
+* grows with the square root of the distance, since the arm spends most of a
+* short seek speeding up and slowing down, and seeks longer than the knee
+* grow linearly, since the arm spends most of a long seek coasting.
+*
+* (3) TableSeek, which interpolates between the (distance, time) points of a
+* profile measured on a drive.
+*
+* DiskTiming adds the rotational latency and transfer time of each request to
+* the seek time, for traces that give the length of each request.
+*
+* Every model is a class with an inline operator() that takes a distance and
+* returns a time, and every model gives a seek of distance 0 a time of 0. The
+* models are given to TraceSet as template parameters, so each model gets its
+* own copy of the scanning loop with the cost inlined in it, and there is no
+* virtual call for each access. New models only need the same operator().
+*
+*/
+
+#ifndef SEEKCOST_HPP_INCLUDED
+#define SEEKCOST_HPP_INCLUDED 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <istream>
+#include <vector>
+
+class LinearSeek{
+
+public:
+
+  /// Returns the distance.
+  double operator()(std::size_t distance) const
+  {
+    return static_cast<double>(distance);
+  }
+
+};
+
+class SqrtLinearSeek{
+
+public:
+
+  ///<Constructor which takes the settle time added to every seek, the
+  ///<factor of the square root of the distance up to knee, and the time per
+  ///<unit of distance beyond knee.
+  SqrtLinearSeek(double settle, double sqrt_scale, double linear_scale,
+                 std::size_t knee);
+
+  /// Returns the time of a seek of the given distance.
+  double operator()(std::size_t distance) const
+  {
+    if (distance == 0) {
+      return 0;
+    }
+    if (distance <= knee_) {
+      return settle_ + sqrt_scale_ * std::sqrt(static_cast<double>(distance));
+    }
+    return knee_time_ + linear_scale_ * static_cast<double>(distance - knee_);
+  }
+
+private:
+
+  double settle_;           // Time added to every seek
+  double sqrt_scale_;       // Factor of the square root of the distance
+  double linear_scale_;     // Time per unit of distance beyond the knee
+  std::size_t knee_;        // Distance where seeks become linear
+  double knee_time_;        // Time of a seek of distance knee_
+
+};
+
+class TableSeek{
+
+public:
+
+  /*
+   * struct: Point
+   *
+   * One measured seek of a drive profile.
+   */
+  struct Point {
+
+    std::size_t distance;     // Distance of the seek
+
+    double time;              // Time it took
+
+  };
+
+  ///<Constructor creates an empty table, where every seek takes no time.
+  TableSeek();
+
+  ///<Constructor which takes the points of a profile, in any order.
+  explicit TableSeek(const std::vector<Point>& points);
+
+  /// Reads a profile from inputstream, one "distance time" pair per line,
+  /// skipping empty lines and lines starting with #. Returns false, and
+  /// leaves the table empty, if a line cannot be read.
+  bool read(std::istream& inputstream);
+
+  /// Returns the points of the table, sorted by distance.
+  const std::vector<Point>& points() const;
+
+  /// Returns the time of a seek of the given distance. Between two points the
+  /// time is interpolated, below the first point (or with only one point) it
+  /// is the time of the first point, and beyond the last point it grows with
+  /// the slope of the last two points.
+  double operator()(std::size_t distance) const
+  {
+    if (distance == 0 || points_.empty()) {
+      return 0;
+    }
+    if (distance <= points_.front().distance || points_.size() == 1) {
+      return points_.front().time;
+    }
+
+    std::vector<Point>::const_iterator above = std::upper_bound(
+        points_.begin(), points_.end(), distance,
+        [](std::size_t d, const Point& point) { return d < point.distance; });
+    if (above == points_.end()) {
+      --above;
+    }
+    std::vector<Point>::const_iterator below = above - 1;
+
+    double slope = (above->time - below->time) /
+                   static_cast<double>(above->distance - below->distance);
+    return below->time +
+           slope * (static_cast<double>(distance) -
+                    static_cast<double>(below->distance));
+  }
+
+private:
+
+  // Sorts points_ and keeps one point per distance.
+  void sort_points();
+
+  std::vector<Point> points_;   // The profile, sorted by distance
+
+};
+
+/*
+ * struct: DiskTiming
+ *
+ * The parts of the time of a request that do not depend on the seek, used
+ * with a seek cost model by TraceSet::service_time. The times are in the
+ * same unit as the seek cost model.
+ */
+struct DiskTiming {
+
+  double rotational_latency;    // Average wait for the first block to come
+                                // under the head, half a rotation
+
+  double transfer_per_block;    // Time to read or write one block
+
+};
+
+/*
+ * struct: ServiceEstimate
+ *
+ * The seek distance and the estimated time of a trace, found in one pass by
+ * TraceSet::service_time.
+ */
+struct ServiceEstimate {
+
+  std::size_t seek_distance;    // The same value as total_seek_distance()
+
+  double seek_time;             // Time spent seeking
+
+  double rotation_time;         // Time spent waiting for the disk to turn
+
+  double transfer_time;         // Time spent reading and writing blocks
+
+  /// Returns the total service time of the trace.
+  double total_time() const
+  {
+    return seek_time + rotation_time + transfer_time;
+  }
+
+};
+
+#endif // SEEKCOST_HPP_INCLUDED
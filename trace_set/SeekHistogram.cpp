@@ -0,0 +1,209 @@
+/*
+* SeekHistogram.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the SeekHistogram class, which counts seek distances in
+* log-linear buckets.
+*
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "SeekHistogram.hpp"
+
+using namespace std;
+
+const unsigned SeekHistogram::NUM_LOG2_BUCKETS;
+const unsigned SeekHistogram::SUB_BITS;
+const size_t SeekHistogram::SUB_BUCKETS;
+const size_t SeekHistogram::NUM_FINE_BUCKETS;
+
+// Constructor for SeekHistogram
+SeekHistogram::SeekHistogram():
+  counts_(NUM_FINE_BUCKETS, 0), count_{0}, total_{0}, max_{0}
+{
+  // Do nothing here
+}
+
+/**
+ * function: merge(const SeekHistogram& other)
+ */
+void SeekHistogram::merge(const SeekHistogram& other)
+{
+  for (size_t i = 0; i < NUM_FINE_BUCKETS; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  total_ += other.total_;
+  if (other.max_ > max_) {
+    max_ = other.max_;
+  }
+}
+
+/**
+ * function: count()
+ */
+size_t SeekHistogram::count() const
+{
+  return count_;
+}
+
+/**
+ * function: total()
+ */
+size_t SeekHistogram::total() const
+{
+  return total_;
+}
+
+/**
+ * function: max()
+ */
+size_t SeekHistogram::max() const
+{
+  return max_;
+}
+
+/**
+ * function: mean()
+ */
+double SeekHistogram::mean() const
+{
+  if (count_ == 0) {
+    return 0;
+  }
+  return static_cast<double>(total_) / static_cast<double>(count_);
+}
+
+/**
+ * function: fine_low(size_t bucket)
+ *
+ * Above SUB_BUCKETS, bucket SUB_BUCKETS + k * SUB_BUCKETS + sub holds the
+ * distances whose top SUB_BITS + 1 bits are SUB_BUCKETS + sub, followed by
+ * k more bits.
+ */
+size_t SeekHistogram::fine_low(size_t bucket)
+{
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+  size_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+  return (SUB_BUCKETS + sub) << shift;
+}
+
+/**
+ * function: fine_high(size_t bucket)
+ *
+ * Written as low plus width minus one, since the high end of the last bucket
+ * is the largest size_t.
+ */
+size_t SeekHistogram::fine_high(size_t bucket)
+{
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+  return fine_low(bucket) + ((size_t(1) << shift) - 1);
+}
+
+/**
+ * function: log2_bucket_low(unsigned bucket)
+ */
+size_t SeekHistogram::log2_bucket_low(unsigned bucket)
+{
+  return bucket == 0 ? 0 : size_t(1) << (bucket - 1);
+}
+
+/**
+ * function: log2_bucket_high(unsigned bucket)
+ */
+size_t SeekHistogram::log2_bucket_high(unsigned bucket)
+{
+  if (bucket == 0) {
+    return 0;
+  }
+  return log2_bucket_low(bucket) + (log2_bucket_low(bucket) - 1);
+}
+
+/**
+ * function: log2_bucket_count(unsigned bucket)
+ *
+ * The fine buckets never straddle a power of two, so the count is the sum of
+ * the fine buckets between the low and high ends of the log2 bucket.
+ */
+size_t SeekHistogram::log2_bucket_count(unsigned bucket) const
+{
+  if (bucket >= NUM_LOG2_BUCKETS) {
+    return 0;
+  }
+
+  size_t first = fine_bucket(log2_bucket_low(bucket));
+  size_t last = fine_bucket(log2_bucket_high(bucket));
+
+  size_t bucket_count = 0;
+  for (size_t i = first; i <= last; ++i) {
+    bucket_count += counts_[i];
+  }
+  return bucket_count;
+}
+
+/**
+ * function: fraction_below(size_t limit)
+ *
+ * The bucket that holds limit is assumed to have its seeks spread evenly
+ * over its distances.
+ */
+double SeekHistogram::fraction_below(size_t limit) const
+{
+  if (count_ == 0 || limit == 0) {
+    return 0;
+  }
+
+  size_t limit_bucket = fine_bucket(limit);
+  double below = 0;
+  for (size_t i = 0; i < limit_bucket; ++i) {
+    below += static_cast<double>(counts_[i]);
+  }
+
+  size_t low = fine_low(limit_bucket);
+  double width = static_cast<double>(fine_high(limit_bucket) - low) + 1;
+  below += static_cast<double>(counts_[limit_bucket]) *
+           static_cast<double>(limit - low) / width;
+
+  return below / static_cast<double>(count_);
+}
+
+/**
+ * function: quantile(double q)
+ *
+ * Finds the bucket holding the seek of rank ceil(q * count()) and returns
+ * its middle, never more than the longest distance counted.
+ */
+size_t SeekHistogram::quantile(double q) const
+{
+  if (count_ == 0) {
+    return 0;
+  }
+
+  double wanted = ceil(q * static_cast<double>(count_));
+  size_t rank = wanted < 1 ? 1 : static_cast<size_t>(wanted);
+  if (rank > count_) {
+    rank = count_;
+  }
+
+  size_t seen = 0;
+  for (size_t i = 0; i < NUM_FINE_BUCKETS; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      size_t low = fine_low(i);
+      size_t middle = low + (fine_high(i) - low) / 2;
+      return middle < max_ ? middle : max_;
+    }
+  }
+
+  return max_;
+}
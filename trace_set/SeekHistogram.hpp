@@ -0,0 +1,128 @@
+/**
+* SeekHistogram.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called SeekHistogram, which counts the seek distances of a
+* trace by size, so a layout can be judged by how many seeks are short and
+* how long the longest ones are, not only by the total seek distance.
+*
+* Distances are counted in log-linear buckets: distances below 16 each have
+* their own bucket, and every power of two range [2^k, 2^(k+1)) above that is
+* split into 16 buckets of equal width. Adding a distance takes a count of
+* leading zeros, a shift and an increment, and any quantile can be estimated
+* from the counts to within 1/32 of its value. The log2 buckets, where
+* bucket 0 holds the seeks of distance 0 and bucket b > 0 holds the distances
+* in [2^(b-1), 2^b), are sums of the fine buckets.
+*
+* Histograms of different parts of a trace are combined with merge, which
+* adds the counts, so partitions of a trace can be counted on their own
+* threads.
+*
+*/
+
+#ifndef SEEKHISTOGRAM_HPP_INCLUDED
+#define SEEKHISTOGRAM_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <vector>
+
+class SeekHistogram{
+
+public:
+
+  /// Number of log2 buckets, one for 0 and one per bit of a distance.
+  static const unsigned NUM_LOG2_BUCKETS = 65;
+
+  ///<Constructor creates an empty histogram.
+  SeekHistogram();
+
+  /// Counts one seek of the given distance.
+  void add(std::size_t distance)
+  {
+    ++counts_[fine_bucket(distance)];
+    ++count_;
+    total_ += distance;
+    if (distance > max_) {
+      max_ = distance;
+    }
+  }
+
+  /// Adds the counts of other to this histogram.
+  void merge(const SeekHistogram& other);
+
+  /// Returns the number of seeks counted.
+  std::size_t count() const;
+
+  /// Returns the sum of the distances counted, taken modulo 2^64 like
+  /// total_seek_distance().
+  std::size_t total() const;
+
+  /// Returns the longest distance counted.
+  std::size_t max() const;
+
+  /// Returns the mean distance, or 0 if no seeks were counted.
+  double mean() const;
+
+  /// Returns the number of seeks in the given log2 bucket.
+  std::size_t log2_bucket_count(unsigned bucket) const;
+
+  /// Returns the smallest distance in the given log2 bucket.
+  static std::size_t log2_bucket_low(unsigned bucket);
+
+  /// Returns the largest distance in the given log2 bucket.
+  static std::size_t log2_bucket_high(unsigned bucket);
+
+  /// Returns the fraction of the seeks whose distance is less than limit.
+  /// The answer is exact if limit is below 16 or is a multiple of 1/16 of
+  /// the power of two below it, otherwise it is estimated.
+  double fraction_below(std::size_t limit) const;
+
+  /// Returns an estimate of the q-quantile of the distances, for q between 0
+  /// and 1, such as 0.99 for the p99 seek. The estimate is the middle of the
+  /// bucket that holds the quantile, so it is exact below 16 and off by at
+  /// most 1/32 of its value above that. Returns 0 if no seeks were counted.
+  std::size_t quantile(double q) const;
+
+  /// Number of fine buckets in each power of two range, as a number of
+  /// bits. The distances below SUB_BUCKETS each have their own bucket.
+  static const unsigned SUB_BITS = 4;
+  static const std::size_t SUB_BUCKETS = std::size_t(1) << SUB_BITS;
+
+  /// Returns the fine bucket a distance is counted in.
+  static std::size_t fine_bucket(std::size_t distance)
+  {
+    if (distance < SUB_BUCKETS) {
+      return distance;
+    }
+    unsigned top_bit =
+        63 - static_cast<unsigned>(__builtin_clzll(
+                 static_cast<unsigned long long>(distance)));
+    std::size_t sub = (distance >> (top_bit - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + (top_bit - SUB_BITS) * SUB_BUCKETS + sub;
+  }
+
+private:
+
+  // The loops of SeekKernel::distance count seeks straight into counts_
+  friend class SeekKernel;
+
+  // Number of fine buckets, the distances below SUB_BUCKETS and then
+  // SUB_BUCKETS for each of the remaining powers of two.
+  static const std::size_t NUM_FINE_BUCKETS =
+      SUB_BUCKETS + (64 - SUB_BITS) * SUB_BUCKETS;
+
+  // Returns the smallest distance in a fine bucket.
+  static std::size_t fine_low(std::size_t bucket);
+
+  // Returns the largest distance in a fine bucket.
+  static std::size_t fine_high(std::size_t bucket);
+
+  std::vector<std::size_t> counts_;   // Number of seeks in each fine bucket
+  std::size_t count_;                 // Number of seeks
+  std::size_t total_;                 // Sum of the distances
+  std::size_t max_;                   // Longest distance
+
+};
+
+#endif // SEEKHISTOGRAM_HPP_INCLUDED
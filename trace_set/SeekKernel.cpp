@@ -0,0 +1,721 @@
+/*
+* SeekKernel.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the SeekKernel class. The vector versions are compiled
+* with the target attribute rather than with -mavx2, so that only these
+* functions use the wider instructions and the rest of the program still runs
+* on any x86-64 CPU.
+*
+*/
+
+#include <cstddef>
+
+#include "SeekKernel.hpp"
+#include "SeekHistogram.hpp"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define SEEKKERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/*
+ * struct: NoCounter
+ *
+ * Counts nothing, the loops of distance() without a histogram are compiled
+ * with it and so have no code for counting at all.
+ */
+struct NoCounter {
+
+  static const bool COUNTS = false;
+
+  void add(size_t)
+  {
+  }
+
+  void add_bucket(size_t)
+  {
+  }
+
+  void add_longest(size_t)
+  {
+  }
+
+};
+
+/*
+ * struct: BucketCounter
+ *
+ * Counts every distance into the fine buckets of a SeekHistogram as the loop
+ * finds it, a count of leading zeros, a shift and an increment, and keeps the
+ * longest distance.
+ */
+struct BucketCounter {
+
+  static const bool COUNTS = true;
+
+  size_t* counts;
+  size_t longest;
+
+  void add(size_t distance)
+  {
+    ++counts[SeekHistogram::fine_bucket(distance)];
+    add_longest(distance);
+  }
+
+  // Counts a seek whose bucket the loop has already found
+  void add_bucket(size_t bucket)
+  {
+    ++counts[bucket];
+  }
+
+  void add_longest(size_t distance)
+  {
+    longest = distance > longest ? distance : longest;
+  }
+
+};
+
+// The type of every version of the loop
+typedef size_t (*SeekFunction)(const size_t*, size_t, size_t, const size_t*);
+
+// The type of every version of the loop that also counts a histogram
+typedef size_t (*CountFunction)(const size_t*, size_t, size_t, const size_t*,
+                                BucketCounter&);
+
+/*
+ * function: distance_scalar_loop(const size_t* keys, size_t key_stride,
+ *                                size_t num_accesses,
+ *                                const size_t* locations, Counter& counter)
+ *
+ * Walks the accesses in order keeping the previous location. Since the
+ * locations are size_ts the smaller location is subtracted from the larger.
+ */
+template <typename Counter>
+static size_t distance_scalar_loop(const size_t* keys, size_t key_stride,
+                                   size_t num_accesses,
+                                   const size_t* locations, Counter& counter)
+{
+  if (num_accesses < 2) {
+    return 0;
+  }
+
+  // A copy the increments of the counts cannot alias, so it stays in
+  // registers
+  Counter local = counter;
+
+  size_t total_distance = 0;
+  size_t current_location = locations[keys[0]];
+  size_t next_location;
+  for (size_t i = 1; i < num_accesses; ++i) {
+
+    keys += key_stride;
+    next_location = locations[*keys];
+
+    size_t distance = current_location < next_location
+                          ? next_location - current_location
+                          : current_location - next_location;
+    total_distance += distance;
+    local.add(distance);
+
+    current_location = next_location;
+  }
+
+  counter = local;
+  return total_distance;
+}
+
+/**
+ * function: distance_scalar(const size_t* keys, size_t num_accesses,
+ *                           const size_t* locations)
+ */
+size_t SeekKernel::distance_scalar(const size_t* keys, size_t num_accesses,
+                                   const size_t* locations)
+{
+  return distance_scalar(keys, 1, num_accesses, locations);
+}
+
+/**
+ * function: distance_scalar(const size_t* keys, size_t key_stride,
+ *                           size_t num_accesses, const size_t* locations)
+ */
+size_t SeekKernel::distance_scalar(const size_t* keys, size_t key_stride,
+                                   size_t num_accesses,
+                                   const size_t* locations)
+{
+  NoCounter counter;
+  return distance_scalar_loop(keys, key_stride, num_accesses, locations,
+                              counter);
+}
+
+/*
+ * function: count_scalar(const size_t* keys, size_t key_stride,
+ *                        size_t num_accesses, const size_t* locations,
+ *                        BucketCounter& counter)
+ */
+static size_t count_scalar(const size_t* keys, size_t key_stride,
+                           size_t num_accesses, const size_t* locations,
+                           BucketCounter& counter)
+{
+  return distance_scalar_loop(keys, key_stride, num_accesses, locations,
+                              counter);
+}
+
+#ifdef SEEKKERNEL_X86
+
+/*
+ * function: load_keys_avx2(const size_t* keys)
+ *
+ * Returns keys[0], keys[STRIDE], keys[2*STRIDE] and keys[3*STRIDE]. With a
+ * stride of 2 the keys are the even elements of two loads, which unpacklo
+ * gives in the order 0, 4, 2, 6 and the permute puts back in order.
+ */
+template <size_t STRIDE>
+__attribute__((target("avx2")))
+static inline __m256i load_keys_avx2(const size_t* keys)
+{
+  if (STRIDE == 1) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+  }
+
+  __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+  __m256i high =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + 4));
+  return _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(low, high), 0xd8);
+}
+
+/*
+ * function: count_lanes_avx2(Counter& counter, __m256i lanes, bool buckets)
+ *
+ * Gives counter the 4 lanes, as buckets if buckets is true and otherwise as
+ * distances. The lanes are moved out of the vector 128 bits at a time, since
+ * a store of the whole vector followed by loads of its lanes waits for the
+ * store to reach the cache on every block.
+ */
+template <typename Counter>
+__attribute__((target("avx2")))
+static inline void count_lanes_avx2(Counter& counter, __m256i lanes,
+                                    bool buckets)
+{
+  __m128i halves[2] = {_mm256_castsi256_si128(lanes),
+                       _mm256_extracti128_si256(lanes, 1)};
+  for (int half = 0; half < 2; ++half) {
+    size_t values[2] = {static_cast<size_t>(_mm_cvtsi128_si64(halves[half])),
+                        static_cast<size_t>(_mm_extract_epi64(halves[half],
+                                                              1))};
+    for (int value = 0; value < 2; ++value) {
+      if (buckets) {
+        counter.add_bucket(values[value]);
+      } else {
+        counter.add(values[value]);
+      }
+    }
+  }
+}
+
+/*
+ * function: distance_avx2_loop(const size_t* keys, size_t num_accesses,
+ *                              const size_t* locations, Counter& counter)
+ *
+ * Gathers the locations of accesses i to i+3, and builds the locations of
+ * accesses i-1 to i+2 by rotating them one lane and putting the last location
+ * of the previous block in the first lane. AVX2 has no unsigned 64 bit
+ * compare, so both sides are flipped into signed order to find which is
+ * larger, and the difference is negated where it went below zero. With a
+ * stride of 2 the loads of a block reach one element past its last key, so
+ * the vector loop stops one access earlier. A counter that counts is given
+ * the 4 distances of a block by count_lanes_avx2.
+ */
+template <size_t STRIDE, typename Counter>
+__attribute__((target("avx2")))
+static size_t distance_avx2_loop(const size_t* keys, size_t num_accesses,
+                                 const size_t* locations, Counter& counter)
+{
+  if (num_accesses < 2) {
+    return 0;
+  }
+
+  const size_t overrun = STRIDE == 1 ? 0 : 1;
+  const long long* base = reinterpret_cast<const long long*>(locations);
+  const __m256i sign = _mm256_set1_epi64x(
+      static_cast<long long>(1ULL << 63));
+
+  __m256i sums = _mm256_setzero_si256();
+  __m256i carry = _mm256_set1_epi64x(
+      static_cast<long long>(locations[keys[0]]));
+
+  Counter local = counter;
+
+  size_t i = 1;
+  for (; i + 4 + overrun <= num_accesses; i += 4) {
+
+    __m256i indices = load_keys_avx2<STRIDE>(keys + i * STRIDE);
+    __m256i current = _mm256_i64gather_epi64(base, indices, 8);
+
+    // previous = {carry[3], current[0], current[1], current[2]}
+    __m256i rotated = _mm256_permute4x64_epi64(current, 0x93);
+    __m256i previous = _mm256_blend_epi32(rotated, carry, 0x03);
+
+    __m256i difference = _mm256_sub_epi64(current, previous);
+    __m256i below = _mm256_cmpgt_epi64(_mm256_xor_si256(previous, sign),
+                                       _mm256_xor_si256(current, sign));
+    __m256i distance = _mm256_sub_epi64(_mm256_xor_si256(difference, below),
+                                        below);
+
+    sums = _mm256_add_epi64(sums, distance);
+    carry = _mm256_permute4x64_epi64(current, 0xff);
+
+    if (Counter::COUNTS) {
+      count_lanes_avx2(local, distance, false);
+    }
+  }
+
+  alignas(32) size_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sums);
+  size_t total_distance = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+  total_distance += distance_scalar_loop(keys + (i - 1) * STRIDE, STRIDE,
+                                         num_accesses - i + 1, locations,
+                                         local);
+  counter = local;
+  return total_distance;
+}
+
+/**
+ * function: distance_avx2(const size_t* keys, size_t num_accesses,
+ *                         const size_t* locations)
+ */
+size_t SeekKernel::distance_avx2(const size_t* keys, size_t num_accesses,
+                                 const size_t* locations)
+{
+  return distance_avx2(keys, 1, num_accesses, locations);
+}
+
+/*
+ * function: stride_avx2(const size_t* keys, size_t key_stride,
+ *                       size_t num_accesses, const size_t* locations,
+ *                       Counter& counter)
+ *
+ * Picks the AVX2 loop for the stride, or the portable loop for a stride with
+ * no vector loop.
+ */
+template <typename Counter>
+static size_t stride_avx2(const size_t* keys, size_t key_stride,
+                          size_t num_accesses, const size_t* locations,
+                          Counter& counter)
+{
+  if (key_stride == 1) {
+    return distance_avx2_loop<1>(keys, num_accesses, locations, counter);
+  }
+  if (key_stride == 2) {
+    return distance_avx2_loop<2>(keys, num_accesses, locations, counter);
+  }
+  return distance_scalar_loop(keys, key_stride, num_accesses, locations,
+                              counter);
+}
+
+/**
+ * function: distance_avx2(const size_t* keys, size_t key_stride,
+ *                         size_t num_accesses, const size_t* locations)
+ */
+size_t SeekKernel::distance_avx2(const size_t* keys, size_t key_stride,
+                                 size_t num_accesses, const size_t* locations)
+{
+  NoCounter counter;
+  return stride_avx2(keys, key_stride, num_accesses, locations, counter);
+}
+
+/*
+ * function: count_avx2(const size_t* keys, size_t key_stride,
+ *                      size_t num_accesses, const size_t* locations,
+ *                      BucketCounter& counter)
+ */
+static size_t count_avx2(const size_t* keys, size_t key_stride,
+                         size_t num_accesses, const size_t* locations,
+                         BucketCounter& counter)
+{
+  return stride_avx2(keys, key_stride, num_accesses, locations, counter);
+}
+
+/*
+ * function: load_keys_avx512(const size_t* keys)
+ *
+ * Returns keys[0], keys[STRIDE], ..., keys[7*STRIDE]. With a stride of 2 the
+ * keys are the even elements of two loads, picked out with one permute.
+ */
+template <size_t STRIDE>
+__attribute__((target("avx512f,avx512cd")))
+static inline __m512i load_keys_avx512(const size_t* keys)
+{
+  if (STRIDE == 1) {
+    return _mm512_loadu_si512(keys);
+  }
+
+  const __m512i even = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+  return _mm512_permutex2var_epi64(_mm512_loadu_si512(keys), even,
+                                   _mm512_loadu_si512(keys + 8));
+}
+
+/*
+ * function: fine_buckets_avx512(__m512i distances)
+ *
+ * Returns SeekHistogram::fine_bucket of each lane. With top the highest set
+ * bit of a distance of at least SUB_BUCKETS, 63 - its count of leading
+ * zeros, the bucket is (top - SUB_BITS + 1) * SUB_BUCKETS plus the SUB_BITS
+ * bits below top.
+ */
+__attribute__((target("avx512f,avx512cd")))
+static inline __m512i fine_buckets_avx512(__m512i distances)
+{
+  const long long SUB_BITS = SeekHistogram::SUB_BITS;
+  const long long SUB_BUCKETS = SeekHistogram::SUB_BUCKETS;
+
+  __m512i zeros = _mm512_lzcnt_epi64(distances);
+  __m512i power = _mm512_sub_epi64(_mm512_set1_epi64(64 - SUB_BITS), zeros);
+  __m512i sub = _mm512_and_si512(
+      _mm512_srlv_epi64(distances,
+                        _mm512_sub_epi64(power, _mm512_set1_epi64(1))),
+      _mm512_set1_epi64(SUB_BUCKETS - 1));
+  __m512i buckets = _mm512_add_epi64(_mm512_slli_epi64(power, SUB_BITS), sub);
+
+  __mmask8 small = _mm512_cmplt_epu64_mask(distances,
+                                           _mm512_set1_epi64(SUB_BUCKETS));
+  return _mm512_mask_blend_epi64(small, buckets, distances);
+}
+
+/*
+ * function: distance_avx512_loop(const size_t* keys, size_t num_accesses,
+ *                                const size_t* locations, Counter& counter)
+ *
+ * The same as distance_avx2_loop with 8 lanes, AVX-512 has unsigned min and
+ * max so the absolute difference is just max - min. A counter that counts is
+ * given the buckets of the 8 distances of a block, found together by
+ * fine_buckets_avx512, and the longest distance is kept per lane.
+ */
+// Some versions of GCC wrongly warn that the placeholder vectors used inside
+// the AVX-512 intrinsics may be uninitialized.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+template <size_t STRIDE, typename Counter>
+__attribute__((target("avx512f,avx512cd")))
+static size_t distance_avx512_loop(const size_t* keys, size_t num_accesses,
+                                   const size_t* locations, Counter& counter)
+{
+  if (num_accesses < 2) {
+    return 0;
+  }
+
+  const size_t overrun = STRIDE == 1 ? 0 : 1;
+  __m512i sums = _mm512_setzero_si512();
+  __m512i carry = _mm512_set1_epi64(
+      static_cast<long long>(locations[keys[0]]));
+
+  Counter local = counter;
+  __m512i longest = _mm512_setzero_si512();
+
+  size_t i = 1;
+  for (; i + 8 + overrun <= num_accesses; i += 8) {
+
+    __m512i indices = load_keys_avx512<STRIDE>(keys + i * STRIDE);
+    __m512i current = _mm512_i64gather_epi64(indices, locations, 8);
+
+    // previous = {carry[7], current[0], ..., current[6]}
+    __m512i previous = _mm512_alignr_epi64(current, carry, 7);
+
+    __m512i distance = _mm512_sub_epi64(_mm512_max_epu64(current, previous),
+                                        _mm512_min_epu64(current, previous));
+
+    sums = _mm512_add_epi64(sums, distance);
+    carry = current;
+
+    if (Counter::COUNTS) {
+      __m512i buckets = fine_buckets_avx512(distance);
+      count_lanes_avx2(local, _mm512_castsi512_si256(buckets), true);
+      count_lanes_avx2(local, _mm512_extracti64x4_epi64(buckets, 1), true);
+      longest = _mm512_max_epu64(longest, distance);
+    }
+  }
+
+  alignas(64) size_t lanes[8];
+  _mm512_store_si512(lanes, sums);
+  size_t total_distance = 0;
+  for (size_t lane = 0; lane < 8; ++lane) {
+    total_distance += lanes[lane];
+  }
+
+  if (Counter::COUNTS) {
+    _mm512_store_si512(lanes, longest);
+    for (size_t lane = 0; lane < 8; ++lane) {
+      local.add_longest(lanes[lane]);
+    }
+  }
+
+  total_distance += distance_scalar_loop(keys + (i - 1) * STRIDE, STRIDE,
+                                         num_accesses - i + 1, locations,
+                                         local);
+  counter = local;
+  return total_distance;
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * function: distance_avx512(const size_t* keys, size_t num_accesses,
+ *                           const size_t* locations)
+ */
+size_t SeekKernel::distance_avx512(const size_t* keys, size_t num_accesses,
+                                   const size_t* locations)
+{
+  return distance_avx512(keys, 1, num_accesses, locations);
+}
+
+/*
+ * function: stride_avx512(const size_t* keys, size_t key_stride,
+ *                         size_t num_accesses, const size_t* locations,
+ *                         Counter& counter)
+ *
+ * Picks the AVX-512 loop for the stride, or the portable loop for a stride
+ * with no vector loop.
+ */
+template <typename Counter>
+static size_t stride_avx512(const size_t* keys, size_t key_stride,
+                            size_t num_accesses, const size_t* locations,
+                            Counter& counter)
+{
+  if (key_stride == 1) {
+    return distance_avx512_loop<1>(keys, num_accesses, locations, counter);
+  }
+  if (key_stride == 2) {
+    return distance_avx512_loop<2>(keys, num_accesses, locations, counter);
+  }
+  return distance_scalar_loop(keys, key_stride, num_accesses, locations,
+                              counter);
+}
+
+/**
+ * function: distance_avx512(const size_t* keys, size_t key_stride,
+ *                           size_t num_accesses, const size_t* locations)
+ */
+size_t SeekKernel::distance_avx512(const size_t* keys, size_t key_stride,
+                                   size_t num_accesses,
+                                   const size_t* locations)
+{
+  NoCounter counter;
+  return stride_avx512(keys, key_stride, num_accesses, locations, counter);
+}
+
+/*
+ * function: count_avx512(const size_t* keys, size_t key_stride,
+ *                        size_t num_accesses, const size_t* locations,
+ *                        BucketCounter& counter)
+ */
+static size_t count_avx512(const size_t* keys, size_t key_stride,
+                           size_t num_accesses, const size_t* locations,
+                           BucketCounter& counter)
+{
+  return stride_avx512(keys, key_stride, num_accesses, locations, counter);
+}
+
+/**
+ * function: has_avx2()
+ *
+ * Asks the CPU through CPUID whether it supports AVX2.
+ */
+bool SeekKernel::has_avx2()
+{
+  return __builtin_cpu_supports("avx2");
+}
+
+/**
+ * function: has_avx512()
+ *
+ * Asks the CPU through CPUID whether it supports AVX-512F and AVX-512CD,
+ * which every CPU with AVX-512 has.
+ */
+bool SeekKernel::has_avx512()
+{
+  return __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("avx512cd");
+}
+
+#else
+
+// Without x86-64 the vector versions are never selected, they fall back to
+// the scalar loop so that the class has the same interface everywhere.
+
+size_t SeekKernel::distance_avx2(const size_t* keys, size_t num_accesses,
+                                 const size_t* locations)
+{
+  return distance_scalar(keys, num_accesses, locations);
+}
+
+size_t SeekKernel::distance_avx2(const size_t* keys, size_t key_stride,
+                                 size_t num_accesses, const size_t* locations)
+{
+  return distance_scalar(keys, key_stride, num_accesses, locations);
+}
+
+size_t SeekKernel::distance_avx512(const size_t* keys, size_t num_accesses,
+                                   const size_t* locations)
+{
+  return distance_scalar(keys, num_accesses, locations);
+}
+
+size_t SeekKernel::distance_avx512(const size_t* keys, size_t key_stride,
+                                   size_t num_accesses,
+                                   const size_t* locations)
+{
+  return distance_scalar(keys, key_stride, num_accesses, locations);
+}
+
+static size_t count_avx2(const size_t* keys, size_t key_stride,
+                         size_t num_accesses, const size_t* locations,
+                         BucketCounter& counter)
+{
+  return count_scalar(keys, key_stride, num_accesses, locations, counter);
+}
+
+static size_t count_avx512(const size_t* keys, size_t key_stride,
+                           size_t num_accesses, const size_t* locations,
+                           BucketCounter& counter)
+{
+  return count_scalar(keys, key_stride, num_accesses, locations, counter);
+}
+
+bool SeekKernel::has_avx2()
+{
+  return false;
+}
+
+bool SeekKernel::has_avx512()
+{
+  return false;
+}
+
+#endif // SEEKKERNEL_X86
+
+/*
+ * function: select_kernel()
+ *
+ * Returns the widest version of the loop the CPU supports.
+ */
+static SeekFunction select_kernel()
+{
+  if (SeekKernel::has_avx512()) {
+    return static_cast<SeekFunction>(&SeekKernel::distance_avx512);
+  }
+  if (SeekKernel::has_avx2()) {
+    return static_cast<SeekFunction>(&SeekKernel::distance_avx2);
+  }
+  return static_cast<SeekFunction>(&SeekKernel::distance_scalar);
+}
+
+/*
+ * function: kernel()
+ *
+ * Returns the version of the loop chosen by select_kernel, which only runs
+ * once.
+ */
+static SeekFunction kernel()
+{
+  static const SeekFunction selected = select_kernel();
+
+  return selected;
+}
+
+/*
+ * function: select_count_kernel()
+ *
+ * Returns the widest version of the counting loop the CPU supports.
+ */
+static CountFunction select_count_kernel()
+{
+  if (SeekKernel::has_avx512()) {
+    return &count_avx512;
+  }
+  if (SeekKernel::has_avx2()) {
+    return &count_avx2;
+  }
+  return &count_scalar;
+}
+
+/*
+ * function: count_kernel()
+ *
+ * Returns the version of the counting loop chosen by select_count_kernel,
+ * which only runs once.
+ */
+static CountFunction count_kernel()
+{
+  static const CountFunction selected = select_count_kernel();
+
+  return selected;
+}
+
+/**
+ * function: distance(const size_t* keys, size_t num_accesses,
+ *                    const size_t* locations)
+ */
+size_t SeekKernel::distance(const size_t* keys, size_t num_accesses,
+                            const size_t* locations)
+{
+  return kernel()(keys, 1, num_accesses, locations);
+}
+
+/**
+ * function: distance(const size_t* keys, size_t key_stride,
+ *                    size_t num_accesses, const size_t* locations,
+ *                    SeekHistogram* histogram)
+ *
+ * With a histogram the counting version of the loop increments the fine
+ * buckets of the histogram directly, and the number of seeks, their sum and
+ * the longest are added to it at the end.
+ */
+size_t SeekKernel::distance(const size_t* keys, size_t key_stride,
+                            size_t num_accesses, const size_t* locations,
+                            SeekHistogram* histogram)
+{
+  if (histogram == nullptr) {
+    return kernel()(keys, key_stride, num_accesses, locations);
+  }
+
+  if (num_accesses < 2) {
+    return 0;
+  }
+
+  BucketCounter counter;
+  counter.counts = histogram->counts_.data();
+  counter.longest = histogram->max_;
+
+  size_t total_distance = count_kernel()(keys, key_stride, num_accesses,
+                                         locations, counter);
+
+  histogram->count_ += num_accesses - 1;
+  histogram->total_ += total_distance;
+  histogram->max_ = counter.longest;
+
+  return total_distance;
+}
+
+/**
+ * function: name()
+ *
+ * Returns the name of the version of the loop used by distance().
+ */
+const char* SeekKernel::name()
+{
+  if (has_avx512()) {
+    return "avx512";
+  }
+  if (has_avx2()) {
+    return "avx2";
+  }
+  return "scalar";
+}
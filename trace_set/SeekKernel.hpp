@@ -0,0 +1,123 @@
+/**
+* SeekKernel.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called SeekKernel, which holds the inner loop of
+* TraceSet::total_seek_distance. The loop is given the column of keys of the
+* accesses in a trace and the column of locations of those keys, and adds up
+* the absolute difference of the locations of every pair of consecutive
+* accesses.
+*
+* There are three versions of the loop:
+*
+* (1) distance_scalar, which works everywhere.
+*
+* (2) distance_avx2, which gathers the locations of 4 consecutive accesses at
+* a time and keeps 4 partial sums.
+*
+* (3) distance_avx512, which does the same with 8 accesses at a time.
+*
+* distance() picks the widest version the CPU running the program supports the
+* first time it is called, so a binary built on one machine runs on any other.
+* The sums are taken modulo 2^64, the same as the scalar loop, so all versions
+* return exactly the same value no matter the order the partial sums are added.
+*
+* Every version can also read the keys key_stride size_ts apart rather than
+* next to each other, so that keys can be read in place from an array of
+* structs such as the Lines of a Sequence_. The vector versions load two
+* whole vectors of Lines and keep every other element, so reading the keys
+* that way costs them little. TraceSet keeps a column of its keys, so it
+* reads them with a stride of 1.
+*
+* distance() can also count every seek into a SeekHistogram while it adds
+* them up. Each version of the loop is compiled a second time with the
+* counting inlined: the AVX-512 loop finds the buckets of its 8 distances with
+* a vector count of leading zeros, the others a lane at a time, and each seek
+* is one increment of the histogram. That costs about a quarter more than the
+* plain loop when the locations do not fit in the cache, and up to three
+* quarters more when they do.
+*
+*/
+
+#ifndef SEEKKERNEL_HPP_INCLUDED
+#define SEEKKERNEL_HPP_INCLUDED 1
+
+#include <cstddef>
+
+class SeekHistogram;
+
+class SeekKernel{
+
+public:
+
+  /// Returns the sum of |locations[keys[i]] - locations[keys[i-1]]| over
+  /// 0 < i < num_accesses, using the fastest version of the loop the CPU
+  /// supports.
+  static std::size_t distance(const std::size_t* keys,
+                              std::size_t num_accesses,
+                              const std::size_t* locations);
+
+  /// Returns the sum of |locations[keys[i * key_stride]] -
+  /// locations[keys[(i-1) * key_stride]]| over 0 < i < num_accesses, and if
+  /// histogram is not nullptr also counts every seek into it in the same
+  /// pass over the keys. Nothing past keys[(num_accesses-1) * key_stride] is
+  /// read.
+  static std::size_t distance(const std::size_t* keys,
+                              std::size_t key_stride,
+                              std::size_t num_accesses,
+                              const std::size_t* locations,
+                              SeekHistogram* histogram);
+
+  /// The portable version of distance().
+  static std::size_t distance_scalar(const std::size_t* keys,
+                                     std::size_t num_accesses,
+                                     const std::size_t* locations);
+
+  /// The portable version of distance() with the keys key_stride apart.
+  static std::size_t distance_scalar(const std::size_t* keys,
+                                     std::size_t key_stride,
+                                     std::size_t num_accesses,
+                                     const std::size_t* locations);
+
+  /// The AVX2 version of distance(), must only be called if has_avx2().
+  static std::size_t distance_avx2(const std::size_t* keys,
+                                   std::size_t num_accesses,
+                                   const std::size_t* locations);
+
+  /// The AVX2 version of distance() with the keys key_stride apart, must
+  /// only be called if has_avx2(). Strides other than 1 and 2 use the
+  /// portable loop.
+  static std::size_t distance_avx2(const std::size_t* keys,
+                                   std::size_t key_stride,
+                                   std::size_t num_accesses,
+                                   const std::size_t* locations);
+
+  /// The AVX-512 version of distance(), must only be called if
+  /// has_avx512().
+  static std::size_t distance_avx512(const std::size_t* keys,
+                                     std::size_t num_accesses,
+                                     const std::size_t* locations);
+
+  /// The AVX-512 version of distance() with the keys key_stride apart, must
+  /// only be called if has_avx512(). Strides other than 1 and 2 use the
+  /// portable loop.
+  static std::size_t distance_avx512(const std::size_t* keys,
+                                     std::size_t key_stride,
+                                     std::size_t num_accesses,
+                                     const std::size_t* locations);
+
+  /// Returns true if distance_avx2 was compiled in and the CPU supports it.
+  static bool has_avx2();
+
+  /// Returns true if distance_avx512 was compiled in and the CPU supports
+  /// AVX-512F and AVX-512CD.
+  static bool has_avx512();
+
+  /// Returns the name of the version distance() uses, "avx512", "avx2" or
+  /// "scalar".
+  static const char* name();
+
+};
+
+#endif // SEEKKERNEL_HPP_INCLUDED
@@ -0,0 +1,404 @@
+/*
+* TraceGenerator.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the TraceGenerator class, which makes synthetic traces
+* from a seed.
+*
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "TraceGenerator.hpp"
+#include "BinaryTrace.hpp"
+
+using namespace std;
+
+// Definition for the static data member
+const uint64_t TraceGenerator::MAX_LBA_SPACE;
+
+/*
+ * function: greatest_common_divisor(uint64_t a, uint64_t b)
+ */
+static uint64_t greatest_common_divisor(uint64_t a, uint64_t b)
+{
+  while (b != 0) {
+    uint64_t remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
+}
+
+/*
+ * function: coprime_at_least(uint64_t value, uint64_t modulus)
+ *
+ * Returns the smallest number at least value (and at least 1) that has no
+ * common factor with modulus.
+ */
+static uint64_t coprime_at_least(uint64_t value, uint64_t modulus)
+{
+  if (value == 0) {
+    value = 1;
+  }
+  while (greatest_common_divisor(value, modulus) != 1) {
+    ++value;
+  }
+  return value;
+}
+
+/*
+ * function: mix(uint64_t value)
+ *
+ * The output function of splitmix64, which turns consecutive states into
+ * unrelated numbers.
+ */
+static uint64_t mix(uint64_t value)
+{
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+// Multiplier that scatters the ranks of the hot set over the hot set itself,
+// so that the hottest LBAs are not next to each other on the disk.
+static const uint64_t RANK_SCATTER = 2654435761ULL;
+
+// Constructor for TraceGenerator
+TraceGenerator::TraceGenerator(const Options& options):
+  options_(options)
+{
+  if (options_.LBA_space == 0) {
+    options_.LBA_space = 1;
+  }
+  if (options_.LBA_space > MAX_LBA_SPACE) {
+    options_.LBA_space = MAX_LBA_SPACE;
+  }
+  if (options_.hot_set_size > options_.LBA_space) {
+    options_.hot_set_size = options_.LBA_space;
+  }
+  if (options_.hot_set_size > (1ULL << 32)) {
+    options_.hot_set_size = 1ULL << 32;
+  }
+  if (options_.run_length == 0) {
+    options_.run_length = 1;
+  }
+  if (options_.scan_length == 0) {
+    options_.scan_length = 1;
+  }
+  options_.stride %= options_.LBA_space;
+  if (options_.stride == 0) {
+    options_.stride = 1 % options_.LBA_space;
+  }
+
+  double* fractions[3] = {&options_.hot_fraction,
+                          &options_.sequential_fraction,
+                          &options_.strided_fraction};
+  double total_fraction = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    if (!(*fractions[i] > 0)) {
+      *fractions[i] = 0;
+    }
+    total_fraction += *fractions[i];
+  }
+  if (options_.hot_set_size == 0) {
+    total_fraction -= options_.hot_fraction;
+    options_.hot_fraction = 0;
+  }
+  if (total_fraction > 1) {
+    for (size_t i = 0; i < 3; ++i) {
+      *fractions[i] /= total_fraction;
+    }
+    total_fraction = 1;
+  }
+
+  // A run or scan makes many accesses, so it is started less often than a
+  // single hot or cold access, in proportion to its length.
+  double weights[4] = {
+    options_.hot_fraction,
+    options_.sequential_fraction / static_cast<double>(options_.run_length),
+    options_.strided_fraction / static_cast<double>(options_.scan_length),
+    1 - total_fraction
+  };
+  double total_weight = weights[0] + weights[1] + weights[2] + weights[3];
+  double limit = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    limit += weights[i] / total_weight;
+    burst_limits_[i] = limit;
+  }
+
+  spread_ = 1;
+  if (options_.hot_set_size != 0) {
+    spread_ = coprime_at_least(options_.LBA_space / options_.hot_set_size,
+                               options_.LBA_space);
+  }
+
+  build_zipf_table();
+  restart();
+}
+
+/**
+ * function: options()
+ */
+const TraceGenerator::Options& TraceGenerator::options() const
+{
+  return options_;
+}
+
+/**
+ * function: restart()
+ */
+void TraceGenerator::restart()
+{
+  state_ = options_.seed;
+  position_ = 0;
+  phase_ = 0;
+  hot_offset_ = phase_offset(0);
+  burst_left_ = 0;
+  burst_LBA_ = 0;
+  burst_step_ = 1;
+}
+
+/**
+ * function: next()
+ *
+ * A run or scan in progress is continued, otherwise the kind of the next
+ * access is drawn. Runs and scans wrap around the end of the LBA space.
+ */
+uint64_t TraceGenerator::next()
+{
+  if (options_.phase_length != 0) {
+    uint64_t phase = position_ / options_.phase_length;
+    if (phase != phase_) {
+      phase_ = phase;
+      hot_offset_ = phase_offset(phase);
+    }
+  }
+  ++position_;
+
+  if (burst_left_ == 0) {
+    double choice = random_unit();
+    if (choice < burst_limits_[HOT]) {
+      uint64_t rank = zipf_rank();
+      uint64_t scattered = rank * RANK_SCATTER % options_.hot_set_size;
+      return (hot_offset_ + scattered * spread_) % options_.LBA_space;
+    }
+    if (choice < burst_limits_[SEQUENTIAL]) {
+      burst_left_ = options_.run_length;
+      burst_step_ = 1 % options_.LBA_space;
+    }
+    else if (choice < burst_limits_[STRIDED]) {
+      burst_left_ = options_.scan_length;
+      burst_step_ = options_.stride;
+    }
+    else {
+      return random_below(options_.LBA_space);
+    }
+    burst_LBA_ = random_below(options_.LBA_space);
+  }
+
+  --burst_left_;
+  uint64_t LBA = burst_LBA_;
+  burst_LBA_ += burst_step_;
+  if (burst_LBA_ >= options_.LBA_space) {
+    burst_LBA_ -= options_.LBA_space;
+  }
+  return LBA;
+}
+
+/**
+ * function: hot_LBA(uint64_t rank, uint64_t phase)
+ *
+ * The same placement of the hot set that next() uses. RANK_SCATTER is odd
+ * and prime, so it only has common factors with hot set sizes that it
+ * divides, which are too large to matter.
+ */
+uint64_t TraceGenerator::hot_LBA(uint64_t rank, uint64_t phase) const
+{
+  if (options_.hot_set_size == 0) {
+    return 0;
+  }
+  uint64_t scattered = rank % options_.hot_set_size * RANK_SCATTER %
+                       options_.hot_set_size;
+  return (phase_offset(phase) + scattered * spread_) % options_.LBA_space;
+}
+
+/**
+ * function: write_text(const string& filename)
+ *
+ * The digits of each LBA are written straight into a large buffer, which is
+ * written out whenever it is full, so that no stream formatting is done per
+ * access.
+ */
+bool TraceGenerator::write_text(const string& filename)
+{
+  ofstream out(filename, ios::binary | ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  const size_t BUFFER_SIZE = 1 << 20;
+  vector<char> buffer(BUFFER_SIZE + 32);
+  size_t used = 0;
+
+  generate([&](uint64_t LBA) {
+    char digits[20];
+    size_t num_digits = 0;
+    do {
+      digits[num_digits++] = static_cast<char>('0' + LBA % 10);
+      LBA /= 10;
+    } while (LBA != 0);
+    while (num_digits != 0) {
+      buffer[used++] = digits[--num_digits];
+    }
+    buffer[used++] = '\n';
+
+    if (used >= BUFFER_SIZE) {
+      out.write(buffer.data(), static_cast<streamsize>(used));
+      used = 0;
+    }
+  });
+  out.write(buffer.data(), static_cast<streamsize>(used));
+
+  out.close();
+  return !out.fail();
+}
+
+/**
+ * function: write_binary(const string& filename, bool count_unique)
+ */
+bool TraceGenerator::write_binary(const string& filename, bool count_unique)
+{
+  BinaryTraceWriter writer(filename, count_unique);
+  if (!writer.is_open()) {
+    return false;
+  }
+
+  generate([&writer](uint64_t LBA) { writer.append(LBA); });
+
+  return writer.close();
+}
+
+/**
+ * function: random()
+ *
+ * splitmix64, which passes the usual statistical tests and needs one add and
+ * a few multiplies per number.
+ */
+uint64_t TraceGenerator::random()
+{
+  state_ += 0x9e3779b97f4a7c15ULL;
+  return mix(state_);
+}
+
+/**
+ * function: random_below(uint64_t bound)
+ *
+ * The bias of taking the remainder is at most bound / 2^64, which is below
+ * 2^-16 for every LBA space.
+ */
+uint64_t TraceGenerator::random_below(uint64_t bound)
+{
+  return random() % bound;
+}
+
+/**
+ * function: random_unit()
+ *
+ * Uses the top 53 bits, as many as a double holds.
+ */
+double TraceGenerator::random_unit()
+{
+  return static_cast<double>(random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * function: build_zipf_table()
+ *
+ * Vose's alias method: every column of the table holds the chance of one rank
+ * scaled so that the average column is 1. Columns below 1 are filled up with
+ * the excess of a column above 1, which becomes their alias, until every
+ * column is full. Drawing a rank then takes one random column and one coin.
+ */
+void TraceGenerator::build_zipf_table()
+{
+  size_t size = static_cast<size_t>(options_.hot_set_size);
+  alias_.assign(size, 0);
+  threshold_.assign(size, 0);
+  if (size == 0) {
+    return;
+  }
+
+  vector<double> scaled(size);
+  double total = 0;
+  for (size_t i = 0; i < size; ++i) {
+    scaled[i] = pow(static_cast<double>(i + 1), -options_.zipf_exponent);
+    total += scaled[i];
+  }
+
+  vector<uint32_t> small;
+  vector<uint32_t> large;
+  for (size_t i = 0; i < size; ++i) {
+    scaled[i] *= static_cast<double>(size) / total;
+    if (scaled[i] < 1) {
+      small.push_back(static_cast<uint32_t>(i));
+    }
+    else {
+      large.push_back(static_cast<uint32_t>(i));
+    }
+  }
+
+  while (!small.empty() && !large.empty()) {
+    uint32_t less = small.back();
+    uint32_t more = large.back();
+    small.pop_back();
+
+    threshold_[less] = static_cast<uint32_t>(scaled[less] * 4294967296.0);
+    alias_[less] = more;
+
+    scaled[more] -= 1 - scaled[less];
+    if (scaled[more] < 1) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+
+  // What is left is full up to rounding, so it is its own alias.
+  for (size_t i = 0; i < small.size(); ++i) {
+    alias_[small[i]] = small[i];
+  }
+  for (size_t i = 0; i < large.size(); ++i) {
+    alias_[large[i]] = large[i];
+  }
+}
+
+/**
+ * function: zipf_rank()
+ *
+ * The top 32 bits of one random number pick the column and the bottom 32
+ * bits are the coin.
+ */
+uint64_t TraceGenerator::zipf_rank()
+{
+  uint64_t bits = random();
+  uint64_t column = ((bits >> 32) * options_.hot_set_size) >> 32;
+  uint32_t coin = static_cast<uint32_t>(bits);
+  return coin < threshold_[column] ? column : alias_[column];
+}
+
+/**
+ * function: phase_offset(uint64_t phase)
+ *
+ * Each phase gets its own offset, mixed from the seed and the phase so that
+ * it does not depend on the accesses drawn before it.
+ */
+uint64_t TraceGenerator::phase_offset(uint64_t phase) const
+{
+  return mix(options_.seed ^ mix(phase + 0x632be59bd9b4e019ULL)) %
+         options_.LBA_space;
+}
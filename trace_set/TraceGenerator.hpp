@@ -0,0 +1,187 @@
+/**
+* TraceGenerator.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called TraceGenerator, which makes synthetic traces of any
+* size with a known amount of locality, so that benchmarks and scaling tests
+* do not need production traces. The trace is a mix of four kinds of access:
+*
+* (1) Hot accesses, which pick a LBA of the hot set with a Zipf distribution,
+* so the hot LBA of rank r is accessed in proportion to 1 / r^zipf_exponent.
+* The hot set is spread evenly across the LBA space, the ranks are first
+* scattered over the hot set so that the hottest LBAs are not neighbours, and
+* scattered rank s is at (offset + s * spread) mod LBA_space for a spread that
+* is prime to the space.
+*
+* (2) Sequential runs, run_length accesses to consecutive LBAs.
+*
+* (3) Strided scans, scan_length accesses stride LBAs apart.
+*
+* (4) Cold accesses, to any LBA of the space with the same probability.
+*
+* The fractions of the accesses of each kind are given in Options, whatever is
+* left after the first three is cold. Runs and scans start at a random LBA and
+* are written out whole, they are picked less often than single accesses so
+* that each kind still makes up its fraction of the trace.
+*
+* With a phase_length, the trace is split into phases of that many accesses,
+* and every phase moves the hot set to a new offset, so the working set
+* changes the way it does when a workload moves on to other files.
+*
+* Every random choice comes from a splitmix64 generator started from the seed,
+* and the Zipf ranks are drawn from an alias table in constant time, so the
+* same Options always give the same trace, on every machine, and generating
+* an access takes a few nanoseconds.
+*
+*/
+
+#ifndef TRACEGENERATOR_HPP_INCLUDED
+#define TRACEGENERATOR_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TraceGenerator{
+
+public:
+
+  /*
+   * struct: Options
+   *
+   * The size and makeup of a generated trace.
+   */
+  struct Options {
+
+    std::uint64_t num_accesses = 1000000;     // Length of the trace
+
+    std::uint64_t LBA_space = 1ULL << 30;     // LBAs are in [0, LBA_space),
+                                              // at most 2^48
+
+    std::uint64_t seed = 1;                   // Seed of every random choice
+
+    std::uint64_t hot_set_size = 10000;       // Number of hot LBAs
+
+    double zipf_exponent = 1.0;               // Skew of the hot accesses
+
+    double hot_fraction = 0.6;                // Share of hot accesses
+
+    double sequential_fraction = 0.2;         // Share of accesses in runs
+
+    std::uint64_t run_length = 64;            // Accesses in each run
+
+    double strided_fraction = 0.1;            // Share of accesses in scans
+
+    std::uint64_t stride = 8;                 // Distance between the LBAs
+                                              // of a scan
+
+    std::uint64_t scan_length = 256;          // Accesses in each scan
+
+    std::uint64_t phase_length = 0;           // Accesses in each phase, 0
+                                              // for a single phase
+  };
+
+  /// The largest LBA_space, 2^48.
+  static const std::uint64_t MAX_LBA_SPACE = 1ULL << 48;
+
+  ///<Constructor which builds the Zipf table of the hot set. LBA_space is
+  ///<clamped to [1, MAX_LBA_SPACE], the hot set to the LBA space and to 2^32
+  ///<LBAs, and the fractions are scaled down if they add up to more than 1.
+  explicit TraceGenerator(const Options& options);
+
+  /// Returns the options the generator uses, after clamping.
+  const Options& options() const;
+
+  /// Returns the next LBA of the trace. The trace does not end, the first
+  /// options().num_accesses LBAs are the trace the options describe.
+  std::uint64_t next();
+
+  /// Starts the trace over from its first access.
+  void restart();
+
+  /// Calls callback(LBA) for each of the options().num_accesses accesses of
+  /// the trace, from the start.
+  template <typename Callback>
+  void generate(Callback callback);
+
+  /// Writes the trace to the file called filename, one LBA in decimal per
+  /// line. Returns false if the file could not be written.
+  bool write_text(const std::string& filename);
+
+  /// Writes the trace to the file called filename in the binary trace format
+  /// (see BinaryTrace.hpp). The distinct LBAs are only counted for the header
+  /// if count_unique is true. Returns false if the file could not be written.
+  bool write_binary(const std::string& filename, bool count_unique);
+
+  /// Returns the LBA of the hot set of rank rank (0 is the hottest) in the
+  /// given phase.
+  std::uint64_t hot_LBA(std::uint64_t rank, std::uint64_t phase) const;
+
+private:
+
+  // The kinds of access, see the top of this file
+  enum Kind { HOT, SEQUENTIAL, STRIDED, COLD };
+
+  // Returns the next number of the splitmix64 generator.
+  std::uint64_t random();
+
+  // Returns a random number in [0, bound).
+  std::uint64_t random_below(std::uint64_t bound);
+
+  // Returns a random double in [0, 1).
+  double random_unit();
+
+  // Builds the alias table of the Zipf distribution over the hot set.
+  void build_zipf_table();
+
+  // Returns a random rank of the hot set, drawn from the alias table.
+  std::uint64_t zipf_rank();
+
+  // Returns the offset of the hot set in the given phase.
+  std::uint64_t phase_offset(std::uint64_t phase) const;
+
+  Options options_;                 // The options, after clamping
+
+  std::uint64_t state_;             // State of the splitmix64 generator
+
+  double burst_limits_[3];          // Cumulative probabilities that a burst
+                                    // is hot, sequential or strided
+
+  std::uint64_t spread_;            // Multiplier of the hot ranks, prime to
+                                    // LBA_space
+
+  std::vector<std::uint32_t> alias_;       // Alias of each column of the
+                                           // Zipf alias table
+  std::vector<std::uint32_t> threshold_;   // Chance of keeping each column,
+                                           // out of 2^32
+
+  std::uint64_t position_;          // Number of accesses made so far
+
+  std::uint64_t phase_;             // Phase of the last access
+
+  std::uint64_t hot_offset_;        // Offset of the hot set in phase_
+
+  std::uint64_t burst_left_;        // Accesses left in the current run or
+                                    // scan
+
+  std::uint64_t burst_LBA_;         // Next LBA of the current run or scan
+
+  std::uint64_t burst_step_;        // Step between the LBAs of the burst
+
+};
+
+/**
+ * function: generate(Callback callback)
+ */
+template <typename Callback>
+void TraceGenerator::generate(Callback callback)
+{
+  restart();
+  for (std::uint64_t i = 0; i < options_.num_accesses; ++i) {
+    callback(next());
+  }
+}
+
+#endif // TRACEGENERATOR_HPP_INCLUDED
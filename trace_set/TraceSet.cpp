@@ -22,15 +22,44 @@
 #include <list>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 #include "TraceSet.hpp"
+#include "MappedTrace.hpp"
+#include "BinaryTrace.hpp"
+#include "TraceSnapshot.hpp"
+#include "SeekKernel.hpp"
+#include "LayoutMap.hpp"
+#include "LocationTree.hpp"
+#include "FrequencyRank.hpp"
 
 using namespace std;
 
 // Default constructor for TraceSet
 TraceSet::TraceSet():
   mapLBA_{1},
-  locations_{1}
+  locations_{1},
+  key_locations_(1),
+  dictionary_{false},
+  transition_accesses_{0},
+  transitions_stale_{true}
+{
+  // Do nothing here
+}
+
+// Constructor for a TraceSet which may be dictionary encoded, a dictionary
+// encoded TraceSet starts with no IDs.
+TraceSet::TraceSet(bool dictionary_encoded):
+  mapLBA_{dictionary_encoded ? 0u : 1u},
+  locations_{dictionary_encoded ? 0u : 1u},
+  key_locations_(dictionary_encoded ? 0u : 1u),
+  dictionary_{dictionary_encoded},
+  transition_accesses_{0},
+  transitions_stale_{true}
 {
   // Do nothing here
 }
@@ -48,6 +77,9 @@ TraceSet::~TraceSet()
  */
 vector<TraceSet::Line>& TraceSet::get_Sequence()
 {
+  // The caller may change Sequence_ through the reference
+  transitions_stale_ = true;
+
   vector<Line>& sequence = Sequence_;
 
   return sequence;
@@ -78,6 +110,50 @@ vector<TraceSet::LBA_location>& TraceSet::get_locations()
   return locations;
 }
 
+/**
+ * function: is_dictionary_encoded()
+ *
+ * Returns true if the TraceSet is dictionary encoded.
+ */
+bool TraceSet::is_dictionary_encoded() const
+{
+  return dictionary_;
+}
+
+/**
+ * function: get_ID(size_t LBA)
+ *
+ * Returns the index of the LBA in mapLBA_, in a dictionary encoded trace this
+ * is looked up in LBA_IDs_ and is mapLBA_.size() if the LBA is not there.
+ */
+size_t TraceSet::get_ID(size_t LBA) const
+{
+  if (!dictionary_) {
+    return LBA;
+  }
+
+  unordered_map<size_t, size_t>::const_iterator found = LBA_IDs_.find(LBA);
+  if (found == LBA_IDs_.end()) {
+    return mapLBA_.size();
+  }
+
+  return found->second;
+}
+
+/**
+ * function: get_LBA(size_t ID)
+ *
+ * Returns the LBA with the given index in mapLBA_.
+ */
+size_t TraceSet::get_LBA(size_t ID) const
+{
+  if (!dictionary_) {
+    return ID;
+  }
+
+  return ID_LBAs_[ID];
+}
+
 /**
  * function: insert(string LBA_to_add)
  *
@@ -103,12 +179,66 @@ vector<TraceSet::LBA_location>& TraceSet::get_locations()
 void TraceSet::insert(string LBA_to_add)
 {
 
-  size_t added_LBA = stoi(LBA_to_add);
+  insert(static_cast<size_t>(stoull(LBA_to_add)));
+
+}
+
+/**
+ * function: insert(size_t added_LBA)
+ *
+ * Does the work of insert(string LBA_to_add) for a LBA that has already been
+ * parsed, this is used by readInMapped so that no string is created for each
+ * access.
+ */
+void TraceSet::insert(size_t added_LBA)
+{
+
+  // If lengths are kept, an access without one reads a single block
+  if (!request_lengths_.empty()) {
+    request_lengths_.push_back(1);
+  }
 
+  // Until another access of the same LBA is inserted this is the last
+  // occurence of the LBA, which links to itself.
   Line Line_to_add;
   Line_to_add.LBA = added_LBA;
+  Line_to_add.next = Sequence_.size();
+
+  // In a dictionary encoded trace the LBA is replaced by its ID, and a LBA
+  // that has not been seen before is given the next ID and a blockLBA at the
+  // end of mapLBA_ whose location is the LBA.
+  if (dictionary_) {
+
+    pair<unordered_map<size_t, size_t>::iterator, bool> found =
+        LBA_IDs_.emplace(added_LBA, mapLBA_.size());
+
+    if (found.second) {
+
+      ID_LBAs_.push_back(added_LBA);
+
+      blockLBA new_blockLBA;
+      new_blockLBA.first = Sequence_.size();
+      new_blockLBA.location = added_LBA;
+      new_blockLBA.used = true;
+      mapLBA_.push_back(new_blockLBA);
+      key_locations_.push_back(added_LBA);
+
+    } else {
+
+      Sequence_[mapLBA_[found.first->second].last].next = Sequence_.size();
+
+    }
+
+    Line_to_add.LBA = found.first->second;
+    mapLBA_[found.first->second].last = Sequence_.size();
+    Sequence_.push_back(Line_to_add);
+    access_keys_.push_back(Line_to_add.LBA);
+
+    return;
+  }
 
   Sequence_.push_back(Line_to_add);
+  access_keys_.push_back(added_LBA);
 
   // Make sure that the LBA is in the mapLBA_vector and if it isnt
   // resizes the mapLBA_ vector apropriately. Since the locations_ vector
@@ -123,6 +253,7 @@ void TraceSet::insert(string LBA_to_add)
 
     mapLBA_.resize(2*added_LBA);
     locations_.resize(2*added_LBA);
+    key_locations_.resize(2*added_LBA);
 
   }
 
@@ -150,6 +281,7 @@ void TraceSet::insert(string LBA_to_add)
      LBAs_blockLBA.first = index_of_line;
      LBAs_blockLBA.location = added_LBA;
      LBAs_blockLBA.used = true;
+     key_locations_[added_LBA] = added_LBA;
 
      locations_[added_LBA].LBA = added_LBA;
      locations_[added_LBA].used = true;
@@ -161,6 +293,25 @@ void TraceSet::insert(string LBA_to_add)
 
 }
 
+/**
+ * function: insert(size_t added_LBA, size_t length)
+ *
+ * Lengths are only stored once some request is longer than one block, the
+ * accesses before it are then given a length of 1.
+ */
+void TraceSet::insert(size_t added_LBA, size_t length)
+{
+
+  insert(added_LBA);
+
+  if (request_lengths_.empty() && length == 1) {
+    return;
+  }
+  request_lengths_.resize(Sequence_.size(), 1);
+  request_lengths_.back() = length;
+
+}
+
 /**
  * function: readIn(ifstream& inputstream)
  *
@@ -198,6 +349,463 @@ void TraceSet::readIn(ifstream& inputstream)
   }
 }
 
+/**
+ * function: readInMapped(const string& filename)
+ *
+ * Memory maps the trace file and parses the LBAs on each line directly into
+ * the Sequence_, mapLBA_ and locations_ private data members using the
+ * insert function. The number of lines is counted first so that Sequence_ is
+ * only allocated once.
+ *
+ * NOTE: Unlike readIn, a last line which does not end with a newline is still
+ * added to the trace, and blank lines are skipped rather than passed to stoi.
+ */
+size_t TraceSet::readInMapped(const string& filename)
+{
+  MappedTrace trace(filename);
+
+  if (!trace.is_open()) {
+    return 0;
+  }
+
+  Sequence_.reserve(Sequence_.size() +
+                    MappedTrace::count_lines(trace.begin(), trace.end()));
+
+  MappedTrace::for_each_LBA(trace.begin(), trace.end(),
+                            [this](size_t LBA) { insert(LBA); });
+
+  return trace.size();
+}
+
+// The helpers of readInParallel are only used in this file.
+namespace {
+
+/*
+ * struct: ChunkLBA
+ *
+ * The first and last index, local to a chunk, of a LBA which occurs in that
+ * chunk. Used by readInParallel.
+ */
+struct ChunkLBA {
+
+  size_t LBA;
+  size_t first;
+  size_t last;
+
+  bool operator<(const ChunkLBA& other) const
+  {
+    return LBA < other.LBA;
+  }
+
+};
+
+/*
+ * struct: TraceChunk
+ *
+ * Everything one thread of readInParallel learns about its chunk of the
+ * trace file:
+ * (1) The accesses in the chunk with next links that are local to the chunk.
+ * (2) The first and last local index of every LBA in the chunk, sorted by LBA.
+ * (3) The LBAs that were larger than every LBA before them in the chunk, in
+ * order, which are the only LBAs that could have made insert resize mapLBA_.
+ * (4) Whether parsing stopped at a LBA too large for a size_t.
+ */
+struct TraceChunk {
+
+  vector<TraceSet::Line> lines;
+  vector<ChunkLBA> LBAs;
+  vector<size_t> records;
+  bool overflow = false;
+
+};
+
+} // namespace
+
+/*
+ * function: parse_chunk(const char* begin, const char* end, TraceChunk& chunk)
+ *
+ * Parses [begin, end) into chunk, linking repeated accesses to the same LBA
+ * within the chunk. An exception cannot leave a thread, so a LBA that
+ * overflows is recorded in chunk.overflow for readInParallel to throw.
+ */
+static void parse_chunk(const char* begin, const char* end, TraceChunk& chunk)
+{
+  chunk.lines.reserve(MappedTrace::count_lines(begin, end));
+
+  // Maps each LBA to its position in chunk.LBAs
+  unordered_map<size_t, size_t> positions;
+
+  try {
+
+    MappedTrace::for_each_LBA(begin, end, [&](size_t LBA) {
+
+      size_t index = chunk.lines.size();
+
+      TraceSet::Line line;
+      line.LBA = LBA;
+      line.next = index;
+      chunk.lines.push_back(line);
+
+      if (chunk.records.empty() || LBA > chunk.records.back()) {
+        chunk.records.push_back(LBA);
+      }
+
+      unordered_map<size_t, size_t>::iterator found = positions.find(LBA);
+      if (found == positions.end()) {
+
+        positions.emplace(LBA, chunk.LBAs.size());
+        ChunkLBA seen = {LBA, index, index};
+        chunk.LBAs.push_back(seen);
+
+      } else {
+
+        ChunkLBA& seen = chunk.LBAs[found->second];
+        chunk.lines[seen.last].next = index;
+        seen.last = index;
+
+      }
+    });
+
+  } catch (const out_of_range&) {
+    chunk.overflow = true;
+    return;
+  }
+
+  sort(chunk.LBAs.begin(), chunk.LBAs.end());
+}
+
+/**
+ * function: readInParallel(const string& filename, unsigned num_threads)
+ *
+ * Memory maps the trace file and builds the same data members as readInMapped
+ * in four steps:
+ *
+ * (1) The file is cut into num_threads chunks, each of which ends at a
+ * newline, and each chunk is parsed on its own thread by parse_chunk.
+ * (2) The records of every chunk are replayed in order against the current
+ * size of mapLBA_, so mapLBA_ and locations_ are grown to exactly the size
+ * that inserting the accesses one at a time would have produced.
+ * (3) Each thread copies its lines into their final place in Sequence_,
+ * offsetting the local next links.
+ * (4) The LBA space is split into num_threads ranges and each thread walks
+ * the sorted ChunkLBAs in its range chunk by chunk, linking the last
+ * occurence of a LBA in one chunk (or already in Sequence_) to its first
+ * occurence in the next and setting first, last and location in mapLBA_.
+ * Since the ranges do not overlap no two threads write the same element.
+ */
+size_t TraceSet::readInParallel(const string& filename, unsigned num_threads)
+{
+  MappedTrace trace(filename);
+
+  if (!trace.is_open() || trace.size() == 0) {
+    return 0;
+  }
+
+  if (dictionary_) {
+    trace.close();
+    return readInMapped(filename);
+  }
+
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+
+  // Step 1: cut the file at newlines and parse each chunk on its own thread.
+  vector<const char*> bounds;
+  bounds.push_back(trace.begin());
+  for (unsigned i = 1; i < num_threads; ++i) {
+    const char* guess = trace.begin() + trace.size() / num_threads * i;
+    guess = max(guess, bounds.back());
+    const char* newline = MappedTrace::find_newline(guess, trace.end());
+    bounds.push_back(newline == trace.end() ? newline : newline + 1);
+  }
+  bounds.push_back(trace.end());
+
+  vector<TraceChunk> chunks(num_threads);
+  vector<thread> workers;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    workers.push_back(thread(parse_chunk, bounds[i], bounds[i + 1],
+                             ref(chunks[i])));
+  }
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+  workers.clear();
+
+  // Throw the exception readInMapped would, but before anything is inserted
+  for (unsigned i = 0; i < num_threads; ++i) {
+    if (chunks[i].overflow) {
+      throw out_of_range("TraceSet::readInParallel");
+    }
+  }
+
+  // Step 2: grow mapLBA_ and locations_ the way insert would have.
+  size_t table_size = mapLBA_.size();
+  size_t max_LBA = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    for (size_t j = 0; j < chunks[i].records.size(); ++j) {
+      size_t LBA = chunks[i].records[j];
+      if (LBA >= table_size) {
+        table_size = 2*LBA;
+      }
+      max_LBA = max(max_LBA, LBA);
+    }
+  }
+  if (table_size > mapLBA_.size()) {
+    mapLBA_.resize(table_size);
+    locations_.resize(table_size);
+    key_locations_.resize(table_size);
+  }
+
+  // Step 3: copy every chunk into Sequence_.
+  vector<size_t> offsets(chunks.size() + 1, Sequence_.size());
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    offsets[i + 1] = offsets[i] + chunks[i].lines.size();
+  }
+  Sequence_.resize(offsets.back());
+  access_keys_.resize(offsets.back());
+  if (!request_lengths_.empty()) {
+    request_lengths_.resize(Sequence_.size(), 1);
+  }
+
+  for (unsigned i = 0; i < num_threads; ++i) {
+    workers.push_back(thread([this, &chunks, &offsets, i]() {
+      const vector<Line>& lines = chunks[i].lines;
+      size_t offset = offsets[i];
+      for (size_t j = 0; j < lines.size(); ++j) {
+        Sequence_[offset + j].LBA = lines[j].LBA;
+        Sequence_[offset + j].next = lines[j].next + offset;
+        access_keys_[offset + j] = lines[j].LBA;
+      }
+    }));
+  }
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+  workers.clear();
+
+  // Step 4: stitch the chains of each LBA across the chunks.
+  size_t range = max_LBA / num_threads + 1;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    workers.push_back(thread([this, &chunks, &offsets, range, i]() {
+
+      ChunkLBA low = {range * i, 0, 0};
+      ChunkLBA high = {range * (i + 1), 0, 0};
+
+      for (size_t c = 0; c < chunks.size(); ++c) {
+
+        const vector<ChunkLBA>& LBAs = chunks[c].LBAs;
+        vector<ChunkLBA>::const_iterator it =
+            lower_bound(LBAs.begin(), LBAs.end(), low);
+        vector<ChunkLBA>::const_iterator stop =
+            lower_bound(LBAs.begin(), LBAs.end(), high);
+
+        for (; it != stop; ++it) {
+
+          blockLBA& LBAs_blockLBA = mapLBA_[it->LBA];
+          size_t first = it->first + offsets[c];
+
+          if (LBAs_blockLBA.used) {
+
+            Sequence_[LBAs_blockLBA.last].next = first;
+
+          } else {
+
+            LBAs_blockLBA.first = first;
+            LBAs_blockLBA.location = it->LBA;
+            LBAs_blockLBA.used = true;
+            key_locations_[it->LBA] = it->LBA;
+
+            locations_[it->LBA].LBA = it->LBA;
+            locations_[it->LBA].used = true;
+
+          }
+
+          LBAs_blockLBA.last = it->last + offsets[c];
+        }
+      }
+    }));
+  }
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+
+  return trace.size();
+}
+
+/**
+ * function: readInBinary(const string& filename)
+ *
+ * Maps the binary trace file and inserts every LBA it decodes, the access
+ * count in the header is used to allocate Sequence_ once. The accesses
+ * before a corrupt entry stay inserted when 0 is returned for it.
+ */
+size_t TraceSet::readInBinary(const string& filename)
+{
+  BinaryTrace trace;
+
+  if (!trace.open(filename)) {
+    return 0;
+  }
+
+  Sequence_.reserve(Sequence_.size() + trace.header().num_accesses);
+
+  if (!trace.for_each_LBA([this](size_t LBA) { insert(LBA); })) {
+    return 0;
+  }
+
+  return trace.size();
+}
+
+/*
+ * function: write_section(ofstream& out, uint64_t offset, const void* data,
+ *                         size_t bytes)
+ *
+ * Writes bytes bytes of data at the given offset of out, the gap before it is
+ * left as a hole that reads as zeros.
+ */
+static void write_section(ofstream& out, uint64_t offset, const void* data,
+                          size_t bytes)
+{
+  if (bytes == 0) {
+    return;
+  }
+  out.seekp(static_cast<streamoff>(offset));
+  out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+}
+
+/**
+ * function: save_snapshot(const string& filename)
+ *
+ * Every section is written straight from its data member, the ACCESS_KEYS and
+ * KEY_LOCATIONS sections from the columns, so that the snapshot can be scored
+ * straight from its mapping.
+ */
+bool TraceSet::save_snapshot(const string& filename)
+{
+  size_t counts[TraceSnapshot::NUM_SECTIONS];
+  counts[TraceSnapshot::SEQUENCE] = Sequence_.size();
+  counts[TraceSnapshot::MAP_LBA] = mapLBA_.size();
+  counts[TraceSnapshot::LOCATIONS] = locations_.size();
+  counts[TraceSnapshot::ID_LBAS] = ID_LBAs_.size();
+  counts[TraceSnapshot::ACCESS_KEYS] = access_keys_.size();
+  counts[TraceSnapshot::KEY_LOCATIONS] = key_locations_.size();
+  counts[TraceSnapshot::REQUEST_LENGTHS] = request_lengths_.size();
+  counts[TraceSnapshot::TIMESTAMPS] = timestamps_.size();
+
+  TraceSnapshot::Header header = TraceSnapshot::layout(dictionary_, counts);
+
+  ofstream out(filename, ios::binary | ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  const void* sections[TraceSnapshot::NUM_SECTIONS] = {
+    Sequence_.data(), mapLBA_.data(), locations_.data(), ID_LBAs_.data(),
+    access_keys_.data(), key_locations_.data(), request_lengths_.data(),
+    timestamps_.data()
+  };
+  for (size_t i = 0; i < TraceSnapshot::NUM_SECTIONS; ++i) {
+    write_section(out, header.offsets[i], sections[i],
+                  counts[i] * header.element_sizes[i]);
+  }
+
+  out.close();
+  return !out.fail();
+}
+
+/**
+ * function: readInSnapshot(const string& filename)
+ *
+ * Each section is copied into its data member with one assign, the only
+ * thing rebuilt is the hashtable of IDs of a dictionary encoded trace.
+ */
+size_t TraceSet::readInSnapshot(const string& filename)
+{
+  TraceSnapshot snapshot;
+
+  if (!snapshot.open(filename, false)) {
+    return 0;
+  }
+
+  size_t num_accesses = snapshot.num_accesses();
+  size_t num_keys = snapshot.num_keys();
+
+  Sequence_.assign(snapshot.sequence(), snapshot.sequence() + num_accesses);
+  mapLBA_.assign(snapshot.mapLBA(), snapshot.mapLBA() + num_keys);
+  access_keys_.assign(snapshot.access_keys(),
+                      snapshot.access_keys() + num_accesses);
+  key_locations_.assign(snapshot.key_locations(),
+                        snapshot.key_locations() + num_keys);
+  locations_.assign(snapshot.locations(),
+                    snapshot.locations() +
+                        snapshot.count(TraceSnapshot::LOCATIONS));
+  ID_LBAs_.assign(snapshot.ID_LBAs(),
+                  snapshot.ID_LBAs() + snapshot.count(TraceSnapshot::ID_LBAS));
+  request_lengths_.assign(
+      snapshot.request_lengths(),
+      snapshot.request_lengths() +
+          snapshot.count(TraceSnapshot::REQUEST_LENGTHS));
+  timestamps_.assign(snapshot.timestamps(),
+                     snapshot.timestamps() +
+                         snapshot.count(TraceSnapshot::TIMESTAMPS));
+
+  dictionary_ = snapshot.is_dictionary_encoded();
+  LBA_IDs_.clear();
+  LBA_IDs_.reserve(ID_LBAs_.size());
+  for (size_t ID = 0; ID < ID_LBAs_.size(); ++ID) {
+    LBA_IDs_[ID_LBAs_[ID]] = ID;
+  }
+
+  transitions_.clear();
+  transition_accesses_ = 0;
+  transitions_stale_ = true;
+
+  return snapshot.size();
+}
+
+/**
+ * function: readInRequests(const string& filename)
+ *
+ * The same as readInMapped, but each line can give the length of the request
+ * after its LBA.
+ */
+size_t TraceSet::readInRequests(const string& filename)
+{
+  MappedTrace trace(filename);
+
+  if (!trace.is_open()) {
+    return 0;
+  }
+
+  Sequence_.reserve(Sequence_.size() +
+                    MappedTrace::count_lines(trace.begin(), trace.end()));
+
+  MappedTrace::for_each_request(trace.begin(), trace.end(),
+                                [this](size_t LBA, size_t length) {
+                                  insert(LBA, length);
+                                });
+
+  return trace.size();
+}
+
+/**
+ * function: has_request_lengths()
+ */
+bool TraceSet::has_request_lengths() const
+{
+  return !request_lengths_.empty();
+}
+
+/**
+ * function: get_request_length(size_t index)
+ */
+size_t TraceSet::get_request_length(size_t index) const
+{
+  return index < request_lengths_.size() ? request_lengths_[index] : 1;
+}
+
 /**
  * function: readLBAs(ifstream& inputstream)
  *
@@ -227,7 +835,7 @@ std::vector<size_t> TraceSet::readLBAs(ifstream& inputstream)
         // Sequence_ vector.
         else if ( c == '\n' ) {
 
-            freqLBAs.push_back(stoi(current_LBA));
+            freqLBAs.push_back(stoull(current_LBA));
             current_LBA = "";
 
         }
@@ -260,8 +868,15 @@ vector<size_t> TraceSet::get_indices(size_t LBA_to_find)
   vector<size_t> instances;
 
 
+  // A dictionary encoded trace is indexed by ID, a LBA without an ID does
+  // not occur in the trace.
+  size_t ID = get_ID(LBA_to_find);
+  if (ID >= mapLBA_.size()) {
+    return instances;
+  }
+
   // blockLBA that contains information pertaining to LBA_to_find
-  struct blockLBA LBAs_BlockLBA = mapLBA_[LBA_to_find];
+  struct blockLBA LBAs_BlockLBA = mapLBA_[ID];
 
   // Checks if there are instances of the LBA by checking the LBAs_BlockLBA
   // to see if that LBA has been used, if it has been used loops through and
@@ -300,108 +915,856 @@ vector<size_t> TraceSet::get_indices(size_t LBA_to_find)
 }
 
 /**
- * function: total_seek_distance()
- *
- * This is a function that returns the sum of the distance between two
- * consecutive access in the Sequences vector.
+ * function: count_LBAs(unsigned num_threads)
  *
- * The distance is said to be the absolute value of the difference of the
- * locations associated with the consecutive LBAs that represent accesses in the 
- * Sequence_ data member.
+ * Counts the access_keys_ column with FrequencyRank. The keys of a dictionary
+ * encoded trace are turned back into LBAs, so that ties are broken by LBA and
+ * not by ID when the counts are ranked.
  */
-size_t TraceSet::total_seek_distance()
+vector<FrequencyRank::Count> TraceSet::count_LBAs(unsigned num_threads)
 {
 
-  // Iterators that will be used to iterate through Sequences_.
-  vector<Line>::iterator current_it = Sequence_.begin();
-  vector<Line>::iterator next_it = Sequence_.begin();
-  ++next_it;
-
-  // Size_ts that will be used to hold locations in the while looop
-  size_t current_location;
-  size_t next_location;
-  size_t total_distance = 0;
-  while (next_it != Sequence_.end()) {
-
-    // Finds the blockLBA associated with current_it and next_it and then
-    // assigns its location data member to respectivly to current_location
-    // and next_location
-    current_location = mapLBA_[current_it->LBA].location;
-    next_location = mapLBA_[next_it->LBA].location;
-
-    // Finds the absolute values of the difference of current_location and
-    // next_location.Since current_location and next_location are size_ts the
-    // smaller location must be subtracted from the larger.
-    if (current_location < next_location) {
-
-      total_distance += next_location - current_location;
-
-    }
-
-    else {
-
-        total_distance += current_location - next_location;
-
+  vector<FrequencyRank::Count> counts =
+      FrequencyRank::count(access_keys_, num_threads);
+  if (dictionary_) {
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i].LBA = ID_LBAs_[counts[i].LBA];
     }
-
-    ++current_it;
-    ++next_it;
-
   }
 
-  return total_distance;
+  return counts;
 
 }
 
 /**
- * function: change_locations(vector<size_t> LBA_vector, size_t start)
- *
- * This is a function that takes in a vector of size_ts that represent LBAs and
- * the order in which to insert them and a size_t start, which represents the
- * location that should be the location of the first LBA in the LBA_vector, the
- * other LBAs in LBA_vector will then be assigned a contiguous set of locations
- * following start. The locations of the LBAs will be moved so that the no new
- * locations will be used but spaces that existed between LBAs that are not in
- * LBA_vector will be preserved.
+ * function: rank_LBAs(size_t top_k, unsigned num_threads)
  *
+ * Ranks the counts from count_LBAs and keeps only the LBAs.
  */
-void TraceSet::change_locations(vector<size_t> LBA_vector, size_t start)
+vector<size_t> TraceSet::rank_LBAs(size_t top_k, unsigned num_threads)
 {
 
-  // Call to a helper function that will remove the LBA_locations structs
-  // associated with the LBAs in LBA_vector from the locations_ data member
-  remove_LBA_locations(LBA_vector);
-
-  vector<LBA_location> LBAs;
-  LBA_location LBA_to_add;
-
-  // Iterates through and creates a LBA_location struct for each LBA in the
-  // LBA_vector, ordering of the LBAs is the same both the LBA_vector and LBAs.
-  for(size_t i = 0; i < LBA_vector.size(); ++i) {
-
-    LBA_to_add.LBA = LBA_vector[i];
-    LBA_to_add.used = true;
+  vector<FrequencyRank::Count> counts = count_LBAs(num_threads);
+  FrequencyRank::rank(counts, top_k);
 
-    LBAs.push_back(LBA_to_add);
+  vector<size_t> ranked(counts.size());
+  for (size_t i = 0; i < counts.size(); ++i) {
+    ranked[i] = counts[i].LBA;
   }
 
-  // Initializes an iterator for the mapLBA_ vector and then moves it so that it
-  // is pointing at the object at index start.
-  vector<LBA_location>::iterator start_location = locations_.begin();
-  advance(start_location, start);
+  return ranked;
 
-  // Inserts the vector LBAs in the locations_ data member right before
-  // the iterator start_location.
-  locations_.insert(start_location, LBAs.begin(), LBAs.end());
+}
+
+/**
+ * function: total_seek_distance()
+ *
+ * This is a function that returns the sum of the distance between two
+ * consecutive access in the Sequences vector.
+ *
+ * The distance is said to be the absolute value of the difference of the
+ * locations associated with the consecutive LBAs that represent accesses in the 
+ * Sequence_ data member.
+ *
+ * The scan reads the access_keys_ and key_locations_ columns, with the widest
+ * version of the SeekKernel loop the CPU supports.
+ */
+size_t TraceSet::total_seek_distance()
+{
+
+  return SeekKernel::distance(access_keys_.data(), access_keys_.size(),
+                              key_locations_.data());
+
+}
+
+/**
+ * function: total_seek_distance(unsigned num_threads)
+ */
+size_t TraceSet::total_seek_distance(unsigned num_threads)
+{
+
+  return total_seek_distance(num_threads, nullptr);
+
+}
+
+/**
+ * function: total_seek_distance(unsigned num_threads,
+ *                               SeekHistogram* histogram)
+ *
+ * Splits the accesses into num_threads ranges of about the same size. Each
+ * range starts one access before its first access, so the pair of accesses
+ * that spans the boundary between two ranges is scored by the later range and
+ * no pair is scored twice. The partial distances are added in range order.
+ * Sums are taken modulo 2^64 like in total_seek_distance(), so the result is
+ * the same for any number of threads.
+ */
+size_t TraceSet::total_seek_distance(unsigned num_threads,
+                                     SeekHistogram* histogram)
+{
+
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+
+  size_t num_accesses = access_keys_.size();
+  const size_t* keys = access_keys_.data();
+  const size_t* locations = key_locations_.data();
+  if (num_threads == 1 || num_accesses < 2 * num_threads) {
+    return SeekKernel::distance(keys, 1, num_accesses, locations, histogram);
+  }
+
+  vector<size_t> partial(num_threads, 0);
+  vector<SeekHistogram> partial_histograms(histogram == nullptr ? 0
+                                                                : num_threads);
+  vector<thread> workers;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    workers.push_back(thread([&partial, &partial_histograms, keys, locations,
+                              num_accesses, num_threads, i]() {
+      size_t begin = num_accesses / num_threads * i;
+      size_t end = i + 1 == num_threads ? num_accesses
+                                        : num_accesses / num_threads * (i + 1);
+      if (begin > 0) {
+        --begin;
+      }
+      partial[i] = SeekKernel::distance(
+          keys + begin, 1, end - begin, locations,
+          partial_histograms.empty() ? nullptr : &partial_histograms[i]);
+    }));
+  }
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+
+  size_t total_distance = 0;
+  for (size_t i = 0; i < partial.size(); ++i) {
+    total_distance += partial[i];
+  }
+  for (size_t i = 0; i < partial_histograms.size(); ++i) {
+    histogram->merge(partial_histograms[i]);
+  }
+
+  return total_distance;
+
+}
+
+/**
+ * function: set_timestamps(const vector<size_t>& timestamps)
+ */
+void TraceSet::set_timestamps(const vector<size_t>& timestamps)
+{
+  timestamps_ = timestamps;
+}
+
+/**
+ * function: has_timestamps()
+ */
+bool TraceSet::has_timestamps() const
+{
+  return !timestamps_.empty() && timestamps_.size() == Sequence_.size();
+}
+
+/**
+ * function: score_windows(vector<Window>& windows, unsigned num_threads)
+ *
+ * Each window is scanned with SeekKernel::distance starting one access
+ * before its first access, so together the windows read the trace once.
+ * The threads are given runs of windows with about the same number of
+ * accesses, thread t takes the windows whose first access is in the t-th
+ * part of the trace.
+ */
+void TraceSet::score_windows(vector<Window>& windows, unsigned num_threads)
+{
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+
+  size_t num_accesses = access_keys_.size();
+  const size_t* keys = access_keys_.data();
+  const size_t* locations = key_locations_.data();
+
+  auto score = [&windows, keys, locations](size_t begin, size_t end) {
+    for (size_t w = begin; w < end; ++w) {
+      Window& window = windows[w];
+      size_t first = window.first_access;
+      size_t num_seeks = window.num_accesses;
+      if (first > 0) {
+        --first;
+      } else if (num_seeks > 0) {
+        --num_seeks;
+      }
+      size_t last = window.first_access + window.num_accesses;
+
+      window.total_seek = num_seeks == 0
+          ? 0 : SeekKernel::distance(keys + first, last - first,
+                                     locations);
+      window.mean_seek = num_seeks == 0
+          ? 0 : static_cast<double>(window.total_seek) /
+                static_cast<double>(num_seeks);
+    }
+  };
+
+  if (num_threads == 1 || windows.size() < 2) {
+    score(0, windows.size());
+    return;
+  }
+
+  // bounds[t] is the first window of thread t
+  vector<size_t> bounds(num_threads + 1, windows.size());
+  bounds[0] = 0;
+  size_t w = 0;
+  for (unsigned t = 1; t < num_threads; ++t) {
+    size_t split = num_accesses / num_threads * t;
+    while (w < windows.size() && windows[w].first_access < split) {
+      ++w;
+    }
+    bounds[t] = w;
+  }
+
+  vector<thread> workers;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    workers.push_back(thread(score, bounds[t], bounds[t + 1]));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+}
+
+/**
+ * function: window_seek_distance(size_t window_accesses,
+ *                                unsigned num_threads)
+ */
+vector<TraceSet::Window> TraceSet::window_seek_distance(size_t window_accesses,
+                                                        unsigned num_threads)
+{
+  vector<Window> windows;
+  if (window_accesses == 0) {
+    return windows;
+  }
+
+  for (size_t first = 0; first < Sequence_.size(); first += window_accesses) {
+    Window window;
+    window.first_access = first;
+    window.num_accesses = min(window_accesses, Sequence_.size() - first);
+    window.start_time = first;
+    windows.push_back(window);
+  }
+
+  score_windows(windows, num_threads);
+  return windows;
+}
+
+/**
+ * function: window_seek_distance_by_time(size_t interval,
+ *                                        unsigned num_threads)
+ *
+ * Since the timestamps do not decrease, the first access of each window is
+ * found by a binary search for its start time.
+ */
+vector<TraceSet::Window> TraceSet::window_seek_distance_by_time(
+    size_t interval, unsigned num_threads)
+{
+  vector<Window> windows;
+  if (interval == 0 || !has_timestamps()) {
+    return windows;
+  }
 
-  // The ordering of the LBAs and the associated LBA_locations is now correct
-  // in locations_, the helper function fix_locationss() is now run to fix any
-  // discrepancies that may have occured in the LBA-location pairs in the
-  // mapLBA_ data structure due to the movement of LBA_location structs which
-  // was caused by the need to place the LBAs in LBA_vector in the
-  // correct locations in the locations_ vector.
+  size_t first_time = timestamps_.front();
+  size_t num_windows = (timestamps_.back() - first_time) / interval + 1;
 
-  fix_locations();
+  vector<size_t>::const_iterator begin = timestamps_.begin();
+  for (size_t k = 0; k < num_windows; ++k) {
+    vector<size_t>::const_iterator end =
+        lower_bound(begin, timestamps_.cend(), first_time + (k + 1) * interval);
+
+    Window window;
+    window.first_access = static_cast<size_t>(begin - timestamps_.cbegin());
+    window.num_accesses = static_cast<size_t>(end - begin);
+    window.start_time = first_time + k * interval;
+    windows.push_back(window);
+
+    begin = end;
+  }
+
+  score_windows(windows, num_threads);
+  return windows;
+}
+
+/**
+ * function: seek_histogram(unsigned num_threads)
+ */
+SeekHistogram TraceSet::seek_histogram(unsigned num_threads)
+{
+
+  SeekHistogram histogram;
+  total_seek_distance(num_threads, &histogram);
+
+  return histogram;
+
+}
+
+/*
+ * struct: PairHash
+ *
+ * Hash function for a pair of keys, used to count the transitions.
+ */
+struct PairHash {
+
+  size_t operator()(const pair<size_t, size_t>& keys) const
+  {
+    return hash<size_t>()(keys.first * 0x9E3779B97F4A7C15ULL ^ keys.second);
+  }
+
+};
+
+/**
+ * function: build_transitions()
+ *
+ * Counts every pair of consecutive accesses to different LBAs in a hashtable
+ * keyed by the ordered pair (smaller LBA, larger LBA), then copies the counts
+ * into transitions_ and sorts it so that the table is the same on every run.
+ */
+void TraceSet::build_transitions()
+{
+
+  unordered_map<pair<size_t, size_t>, size_t, PairHash> counts;
+  for (size_t i = 1; i < Sequence_.size(); ++i) {
+
+    size_t previous = Sequence_[i - 1].LBA;
+    size_t current = Sequence_[i].LBA;
+    if (previous == current) {
+      continue;
+    }
+
+    if (previous < current) {
+      ++counts[make_pair(previous, current)];
+    } else {
+      ++counts[make_pair(current, previous)];
+    }
+  }
+
+  transitions_.clear();
+  transitions_.reserve(counts.size());
+  for (unordered_map<pair<size_t, size_t>, size_t, PairHash>::const_iterator
+         it = counts.begin(); it != counts.end(); ++it) {
+    Transition transition;
+    transition.low = it->first.first;
+    transition.high = it->first.second;
+    transition.count = it->second;
+    transitions_.push_back(transition);
+  }
+
+  sort(transitions_.begin(), transitions_.end(),
+       [](const Transition& a, const Transition& b) {
+         return a.low < b.low || (a.low == b.low && a.high < b.high);
+       });
+
+  transition_accesses_ = Sequence_.size();
+  transitions_stale_ = false;
+
+}
+
+/**
+ * function: get_transitions()
+ *
+ * Rebuilds the table if Sequence_ may have changed or accesses were added.
+ */
+const vector<TraceSet::Transition>& TraceSet::get_transitions()
+{
+
+  if (transitions_stale_ || transition_accesses_ != Sequence_.size()) {
+    build_transitions();
+  }
+
+  return transitions_;
+
+}
+
+/*
+ * function: score_transitions(const vector<TraceSet::Transition>& transitions,
+ *                             const size_t* locations)
+ *
+ * Returns the sum over the transitions of count times the distance between
+ * the locations of the two keys, where locations is indexed by key.
+ */
+static size_t score_transitions(const vector<TraceSet::Transition>& transitions,
+                                const size_t* locations)
+{
+  size_t total_distance = 0;
+  for (size_t i = 0; i < transitions.size(); ++i) {
+
+    size_t low_location = locations[transitions[i].low];
+    size_t high_location = locations[transitions[i].high];
+
+    if (low_location < high_location) {
+      total_distance += transitions[i].count * (high_location - low_location);
+    } else {
+      total_distance += transitions[i].count * (low_location - high_location);
+    }
+  }
+
+  return total_distance;
+}
+
+/**
+ * function: transition_seek_distance()
+ *
+ * Each transition adds count times the distance between the locations of its
+ * two LBAs. The products and the sum are taken modulo 2^64, so the result is
+ * exactly the value total_seek_distance() returns.
+ */
+size_t TraceSet::transition_seek_distance()
+{
+
+  const vector<Transition>& transitions = get_transitions();
+
+  return score_transitions(transitions, key_locations_.data());
+
+}
+
+/**
+ * function: transition_seek_distance(const LayoutMap& layout)
+ *
+ * The same as transition_seek_distance(), but the locations come from the
+ * layout. In a dictionary encoded TraceSet the IDs in the table are turned
+ * back into LBAs first.
+ */
+size_t TraceSet::transition_seek_distance(const LayoutMap& layout)
+{
+
+  const vector<Transition>& transitions = get_transitions();
+
+  size_t total_distance = 0;
+  for (size_t i = 0; i < transitions.size(); ++i) {
+
+    size_t low = transitions[i].low;
+    size_t high = transitions[i].high;
+    if (dictionary_) {
+      low = ID_LBAs_[low];
+      high = ID_LBAs_[high];
+    }
+
+    size_t low_location = layout.location(low);
+    size_t high_location = layout.location(high);
+
+    if (low_location < high_location) {
+      total_distance += transitions[i].count * (high_location - low_location);
+    } else {
+      total_distance += transitions[i].count * (low_location - high_location);
+    }
+  }
+
+  return total_distance;
+
+}
+
+/**
+ * function: sweep_seek_distance(const vector<size_t>& ranked_LBAs,
+ *                               const vector<size_t>& prefix_sizes,
+ *                               size_t start)
+ *
+ * change_locations(LBA_vector, start) moves every other LBA down by the number
+ * of moved LBAs whose location was below its own, and then up by
+ * LBA_vector.size() if it lands at start or above. So with the keys in the
+ * trace sorted by location once, the locations after moving any prefix of
+ * ranked_LBAs are found in one pass over the keys, counting the moved keys
+ * passed so far. The table of transitions, the sorted keys and the rank of
+ * every key are built once and shared by all the prefixes, each prefix then
+ * costs one pass over the keys and one over the transitions.
+ */
+vector<size_t> TraceSet::sweep_seek_distance(const vector<size_t>& ranked_LBAs,
+                                             const vector<size_t>& prefix_sizes,
+                                             size_t start)
+{
+
+  const vector<Transition>& transitions = get_transitions();
+
+  // rank[key] is the index of the key in ranked_LBAs, or ranked_LBAs.size()
+  // if it is not there.
+  vector<size_t> rank(mapLBA_.size(), ranked_LBAs.size());
+  for (size_t i = 0; i < ranked_LBAs.size(); ++i) {
+    size_t key = get_ID(ranked_LBAs[i]);
+    if (key < mapLBA_.size() && rank[key] == ranked_LBAs.size()) {
+      rank[key] = i;
+    }
+  }
+
+  vector<size_t> sorted_keys = keys_by_location(
+      mapLBA_.data(), key_locations_.data(), mapLBA_.size());
+
+  vector<size_t> locations(key_locations_);
+  vector<size_t> distances;
+  distances.reserve(prefix_sizes.size());
+
+  for (size_t p = 0; p < prefix_sizes.size(); ++p) {
+
+    sweep_locations(sorted_keys, rank,
+                    min(prefix_sizes[p], ranked_LBAs.size()), start,
+                    key_locations_.data(), locations.data());
+
+    distances.push_back(score_transitions(transitions, locations.data()));
+  }
+
+  return distances;
+
+}
+
+/**
+ * function: keys_by_location(const blockLBA* mapLBA,
+ *                            const size_t* key_locations, size_t num_keys)
+ */
+vector<size_t> TraceSet::keys_by_location(const blockLBA* mapLBA,
+                                          const size_t* key_locations,
+                                          size_t num_keys)
+{
+
+  vector<size_t> sorted_keys;
+  for (size_t key = 0; key < num_keys; ++key) {
+    if (mapLBA[key].used) {
+      sorted_keys.push_back(key);
+    }
+  }
+  sort(sorted_keys.begin(), sorted_keys.end(),
+       [key_locations](size_t a, size_t b) {
+         return key_locations[a] < key_locations[b];
+       });
+
+  return sorted_keys;
+
+}
+
+/**
+ * function: sweep_locations(const vector<size_t>& sorted_keys,
+ *                           const vector<size_t>& rank, size_t moved,
+ *                           size_t start, const size_t* key_locations,
+ *                           size_t* locations)
+ *
+ * Walks the keys in order of location counting the moved keys passed so far,
+ * see sweep_seek_distance.
+ */
+void TraceSet::sweep_locations(const vector<size_t>& sorted_keys,
+                               const vector<size_t>& rank, size_t moved,
+                               size_t start, const size_t* key_locations,
+                               size_t* locations)
+{
+
+  size_t below = 0;
+  for (size_t i = 0; i < sorted_keys.size(); ++i) {
+
+    size_t key = sorted_keys[i];
+    if (rank[key] < moved) {
+      locations[key] = start + rank[key];
+      ++below;
+      continue;
+    }
+
+    size_t location = key_locations[key] - below;
+    if (location >= start) {
+      location += moved;
+    }
+    locations[key] = location;
+  }
+
+}
+
+/*
+ * function: signed_distance_change(size_t old_location, size_t new_location,
+ *                                  size_t other_location)
+ *
+ * Returns |new_location - other_location| - |old_location - other_location|.
+ */
+static long long signed_distance_change(size_t old_location,
+                                        size_t new_location,
+                                        size_t other_location)
+{
+  size_t old_distance = old_location < other_location
+                        ? other_location - old_location
+                        : old_location - other_location;
+  size_t new_distance = new_location < other_location
+                        ? other_location - new_location
+                        : new_location - other_location;
+
+  return static_cast<long long>(new_distance) -
+         static_cast<long long>(old_distance);
+}
+
+/**
+ * function: chain_delta(size_t key, size_t old_location, size_t new_location,
+ *                       size_t skip_key)
+ *
+ * Walks the occurences of key from first to last through the next indices,
+ * and looks at the access before and after each occurence. A neighbour that
+ * is also key keeps the same distance when key moves, and so does a
+ * neighbour that is skip_key when two keys are swapped, so both are skipped.
+ * Every other pair is seen exactly once, from the side of key.
+ */
+long long TraceSet::chain_delta(size_t key, size_t old_location,
+                                size_t new_location, size_t skip_key)
+{
+
+  long long delta = 0;
+  size_t index = mapLBA_[key].first;
+  while (true) {
+
+    if (index > 0) {
+      size_t neighbour = Sequence_[index - 1].LBA;
+      if (neighbour != key && neighbour != skip_key) {
+        delta += signed_distance_change(old_location, new_location,
+                                        mapLBA_[neighbour].location);
+      }
+    }
+
+    if (index + 1 < Sequence_.size()) {
+      size_t neighbour = Sequence_[index + 1].LBA;
+      if (neighbour != key && neighbour != skip_key) {
+        delta += signed_distance_change(old_location, new_location,
+                                        mapLBA_[neighbour].location);
+      }
+    }
+
+    // The last occurence links to itself
+    if (Sequence_[index].next == index) {
+      break;
+    }
+    index = Sequence_[index].next;
+  }
+
+  return delta;
+
+}
+
+/**
+ * function: set_key_location(size_t key, size_t new_location)
+ */
+void TraceSet::set_key_location(size_t key, size_t new_location)
+{
+
+  mapLBA_[key].location = new_location;
+  key_locations_[key] = new_location;
+
+}
+
+/**
+ * function: seek_delta_move(size_t LBA, size_t new_location, bool commit)
+ *
+ * Returns 0 for an LBA that does not occur in the trace. When committing, the
+ * locations_ vector of a TraceSet that is not dictionary encoded is updated
+ * as well, growing it if new_location is past its end.
+ */
+long long TraceSet::seek_delta_move(size_t LBA, size_t new_location,
+                                    bool commit)
+{
+
+  size_t key = get_ID(LBA);
+  if (key >= mapLBA_.size() || !mapLBA_[key].used) {
+    return 0;
+  }
+
+  size_t old_location = mapLBA_[key].location;
+  long long delta = chain_delta(key, old_location, new_location, key);
+
+  if (commit) {
+
+    set_key_location(key, new_location);
+
+    if (!dictionary_) {
+      if (old_location < locations_.size() &&
+          locations_[old_location].LBA == LBA) {
+        locations_[old_location].used = false;
+      }
+      if (new_location >= locations_.size()) {
+        locations_.resize(new_location + 1);
+      }
+      locations_[new_location].LBA = LBA;
+      locations_[new_location].used = true;
+    }
+  }
+
+  return delta;
+
+}
+
+/**
+ * function: seek_delta_swap(size_t first_LBA, size_t second_LBA, bool commit)
+ *
+ * Adds up the chain_delta of both LBAs, skipping the pairs where one LBA is
+ * accessed right after the other since their distance does not change.
+ * Returns 0 if either LBA does not occur in the trace.
+ */
+long long TraceSet::seek_delta_swap(size_t first_LBA, size_t second_LBA,
+                                    bool commit)
+{
+
+  size_t first_key = get_ID(first_LBA);
+  size_t second_key = get_ID(second_LBA);
+  if (first_key >= mapLBA_.size() || !mapLBA_[first_key].used ||
+      second_key >= mapLBA_.size() || !mapLBA_[second_key].used ||
+      first_key == second_key) {
+    return 0;
+  }
+
+  size_t first_location = mapLBA_[first_key].location;
+  size_t second_location = mapLBA_[second_key].location;
+
+  long long delta = chain_delta(first_key, first_location, second_location,
+                                second_key) +
+                    chain_delta(second_key, second_location, first_location,
+                                first_key);
+
+  if (commit) {
+
+    set_key_location(first_key, second_location);
+    set_key_location(second_key, first_location);
+
+    if (!dictionary_) {
+      if (first_location < locations_.size()) {
+        locations_[first_location].LBA = second_LBA;
+      }
+      if (second_location < locations_.size()) {
+        locations_[second_location].LBA = first_LBA;
+      }
+    }
+  }
+
+  return delta;
+
+}
+
+/**
+ * function: invalidate_transitions()
+ */
+void TraceSet::invalidate_transitions()
+{
+  transitions_stale_ = true;
+}
+
+/**
+ * function: memory_usage()
+ */
+vector<MemoryStats::Container> TraceSet::memory_usage() const
+{
+  vector<MemoryStats::Container> containers = {
+    {"Sequence_", MemoryStats::vector_bytes(Sequence_)},
+    {"mapLBA_", MemoryStats::vector_bytes(mapLBA_)},
+    {"locations_", MemoryStats::vector_bytes(locations_)},
+    {"LBA_IDs_ buckets", MemoryStats::bucket_bytes(LBA_IDs_)},
+    {"LBA_IDs_ nodes", MemoryStats::node_bytes(LBA_IDs_)},
+    {"ID_LBAs_", MemoryStats::vector_bytes(ID_LBAs_)},
+    {"access_keys_", MemoryStats::vector_bytes(access_keys_)},
+    {"key_locations_", MemoryStats::vector_bytes(key_locations_)},
+    {"transitions_", MemoryStats::vector_bytes(transitions_)},
+    {"request_lengths_", MemoryStats::vector_bytes(request_lengths_)},
+    {"timestamps_", MemoryStats::vector_bytes(timestamps_)}
+  };
+
+  return containers;
+}
+
+/**
+ * function: change_locations(vector<size_t> LBA_vector, size_t start)
+ *
+ * This is a function that takes in a vector of size_ts that represent LBAs and
+ * the order in which to insert them and a size_t start, which represents the
+ * location that should be the location of the first LBA in the LBA_vector, the
+ * other LBAs in LBA_vector will then be assigned a contiguous set of locations
+ * following start. The locations of the LBAs will be moved so that the no new
+ * locations will be used but spaces that existed between LBAs that are not in
+ * LBA_vector will be preserved.
+ *
+ */
+void TraceSet::change_locations(vector<size_t> LBA_vector, size_t start)
+{
+
+  // A dictionary encoded trace has no locations_ vector to shift, the new
+  // locations are computed directly.
+  if (dictionary_) {
+    change_dictionary_locations(LBA_vector, start);
+    return;
+  }
+
+  // The slots of the LBAs in LBA_vector are cut out of the locations_ data
+  // member and put back at start in a LocationTree, which only touches the
+  // runs of slots around the moved LBAs instead of shifting the vector. The
+  // tree then writes back only the slots between start and the old slots of
+  // the moved LBAs, into locations_ and mapLBA_, which is what
+  // remove_LBA_locations, the insert and fix_locations() used to do for the
+  // whole trace. The same range of key_locations_ is then brought up to date.
+  LocationTree tree(locations_, mapLBA_);
+  tree.move_to(LBA_vector, start);
+
+  size_t low;
+  size_t high;
+  tree.apply(low, high);
+  for (size_t location = low; location < high; ++location) {
+    if (locations_[location].used &&
+        locations_[location].LBA < key_locations_.size()) {
+      key_locations_[locations_[location].LBA] = location;
+    }
+  }
+
+}
+
+/**
+ * function: change_dictionary_locations(const vector<size_t>& LBA_vector,
+ *                                       size_t start)
+ *
+ * This is the version of change_locations for a dictionary encoded trace,
+ * which gives every ID the location change_locations would give its LBA in a
+ * trace that is not dictionary encoded.
+ *
+ * Removing the moved LBAs from locations_ moves every other LBA at location x
+ * down by the number of moved LBAs whose location was below x, and inserting
+ * them again at start moves every LBA that is then at start or above up by
+ * LBA_vector.size(). So the old locations of the moved LBAs are sorted and the
+ * new location of every other ID is found with a binary search.
+ */
+void TraceSet::change_dictionary_locations(const vector<size_t>& LBA_vector,
+                                           size_t start)
+{
+
+  vector<bool> moved(mapLBA_.size(), false);
+  vector<size_t> old_locations;
+
+  for (size_t i = 0; i < LBA_vector.size(); ++i) {
+
+    size_t ID = get_ID(LBA_vector[i]);
+    if (ID < mapLBA_.size()) {
+      moved[ID] = true;
+      old_locations.push_back(mapLBA_[ID].location);
+    }
+
+  }
+
+  sort(old_locations.begin(), old_locations.end());
+
+  size_t location;
+  size_t below;
+  for (size_t ID = 0; ID < mapLBA_.size(); ++ID) {
+
+    if (!moved[ID]) {
+
+      location = mapLBA_[ID].location;
+      below = static_cast<size_t>(lower_bound(old_locations.begin(),
+                                              old_locations.end(), location) -
+                                  old_locations.begin());
+
+      location -= below;
+      if (location >= start) {
+        location += LBA_vector.size();
+      }
+
+      set_key_location(ID, location);
+
+    }
+  }
+
+  for (size_t i = 0; i < LBA_vector.size(); ++i) {
+
+    size_t ID = get_ID(LBA_vector[i]);
+    if (ID < mapLBA_.size()) {
+      set_key_location(ID, start + i);
+    }
+
+  }
 
 }
 
@@ -417,6 +1780,11 @@ void TraceSet::change_locations(vector<size_t> LBA_vector, size_t start)
 void TraceSet::remove_LBA_locations(vector<size_t> LBA_vector)
 {
 
+  // There is no locations_ vector in a dictionary encoded trace
+  if (dictionary_) {
+    return;
+  }
+
   // loops through LBA_vector, finds the location associated with each LBA and
   // then inserts the LBA and its associated location as a key-value pair into
   // location_hashtable, where the LBA is used as the key.
@@ -501,6 +1869,15 @@ void TraceSet::remove_LBA_locations(vector<size_t> LBA_vector)
 void TraceSet::fix_locations()
 {
 
+  // There is no locations_ vector in a dictionary encoded trace, so only the
+  // column the scans read is copied again from mapLBA_.
+  if (dictionary_) {
+    for (size_t ID = 0; ID < mapLBA_.size(); ++ID) {
+      key_locations_[ID] = mapLBA_[ID].location;
+    }
+    return;
+  }
+
   size_t current_LBA;
   for(size_t location = 0; location < locations_.size(); ++location) {
 
@@ -519,5 +1896,11 @@ void TraceSet::fix_locations()
 
     }
   }
+
+  // The locations may also have been changed through references to mapLBA_
+  // and locations_, so the column the scans read is copied again.
+  for (size_t key = 0; key < mapLBA_.size(); ++key) {
+    key_locations_[key] = mapLBA_[key].location;
+  }
 }
 
@@ -28,6 +28,53 @@
 * location, represents the index in the 1d array representation of the disk that 
 * contains our approxmition of a given LBAs location.
 *
+* DICTIONARY ENCODING: Since mapLBA_ and locations_ are indexed by LBA, a
+* single access to a LBA near the end of a large disk makes them hold billions
+* of structs. A TraceSet constructed with TraceSet(true) is instead dictionary
+* encoded, each distinct LBA is given a dense ID in the order that the LBAs are
+* first seen, the LBA data member of each Line in Sequence_ holds that ID and
+* mapLBA_ is indexed by ID, so it holds one struct per distinct LBA. The
+* location of each ID starts as its 64 bit LBA. In this mode the locations_
+* vector is not kept, mapLBA_ is the only location table, and the functions
+* which take LBAs (get_indices, change_locations, ...) translate them to IDs
+* themselves.
+*
+* COLUMNS: The seek distance scans only need the key of each access and the
+* location of each key, but reading them out of Sequence_ and mapLBA_ drags
+* the next, first, last and used data members through the cache as well. So
+* TraceSet also keeps two contiguous columns, access_keys_ (the LBA data
+* member of every Line, in order) and key_locations_ (the location data member
+* of every blockLBA, indexed the same way as mapLBA_), and the scans read
+* those instead. Every member function that changes the trace writes the
+* columns along with Sequence_ and mapLBA_, so a scan never has to copy them,
+* at the cost of 8 more bytes per access and per key. The references returned
+* by get_Sequence() and get_mapLBA() are not watched: a location changed
+* through get_mapLBA() or get_locations() reaches key_locations_ when
+* fix_locations() is called, and Sequence_ should only be read through its
+* reference.
+*
+* TRANSITIONS: The total seek distance is also the sum, over every distinct
+* pair of LBAs a and b that are accessed one right after the other, of the
+* number of times that happens times the distance between the locations of a
+* and b. Real traces repeat the same pairs many times, so build_transitions()
+* counts the pairs once and transition_seek_distance() scores a layout with
+* one pass over the distinct pairs instead of one pass over the trace.
+*
+* REQUEST LENGTHS: Traces read with readInRequests, or built with
+* insert(LBA, length), also keep the number of blocks of every request in a
+* column beside Sequence_, so that service_time() can tell a long sequential
+* read from a short random one. Traces without lengths use no extra memory,
+* every request is then one block long.
+*
+* SNAPSHOTS: save_snapshot writes all of the above to a file in the layout the
+* data members have in memory, which TraceSnapshot maps and serves without
+* parsing, and which readInSnapshot copies back into a TraceSet.
+*
+* CACHES: cached_seek_distance() scores the trace as a disk behind a buffer
+* cache would see it, counting only the seeks of the accesses that miss an
+* LRU, CLOCK or ARC cache of a given capacity (see CacheModel.hpp), since the
+* hits never reach the disk.
+*
 * The quality of the algorithms are tested against one another using the metric
 * of "total seek distance" which is calculated by the total_seek_distance()
 * function which finds the "total distance" which is said to be the sum of the
@@ -42,6 +89,15 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+
+#include "FrequencyRank.hpp"
+#include "SeekCost.hpp"
+#include "CacheModel.hpp"
+#include "SeekHistogram.hpp"
+#include "MemoryStats.hpp"
+
+class LayoutMap;
 
 
 
@@ -52,6 +108,10 @@ public:
   ///<Constructor creates an empty traceset.
   TraceSet();
 
+  ///<Constructor creates an empty traceset, which is dictionary encoded if
+  ///<dictionary_encoded is true (see the top of this file).
+  explicit TraceSet(bool dictionary_encoded);
+
   ///<Destructor.
   ~TraceSet();
 
@@ -64,9 +124,12 @@ public:
   struct Line {
 
     size_t next;                  // index to the next occurence of the LBA in
-                                  // the vector.
+                                  // the vector, the last occurence of a LBA
+                                  // holds its own index.
 
-    size_t LBA;                   // int representation of the LBA
+    size_t LBA;                   // int representation of the LBA, or the
+                                  // ID of the LBA in a dictionary encoded
+                                  // TraceSet
 
   };
 
@@ -95,6 +158,45 @@ public:
                               // used in the trace
   };
 
+  /*
+   *  struct: Transition
+   *
+   *  A struct describing every pair of consecutive accesses between the same
+   *  two LBAs, in either order.
+   */
+  struct Transition{
+
+    size_t low;               // The smaller of the two LBAs (or IDs in a
+                              // dictionary encoded TraceSet)
+
+    size_t high;              // The larger of the two LBAs (or IDs)
+
+    size_t count;             // Number of times one of the two LBAs is
+                              // accessed right after the other
+  };
+
+  /*
+   *  struct: Window
+   *
+   *  The seek statistics of a run of consecutive accesses of the trace. The
+   *  seek into the first access of a window, from the access before it, is
+   *  counted in the window.
+   */
+  struct Window{
+
+    size_t first_access;      // Index in Sequence_ of the first access
+
+    size_t num_accesses;      // Number of accesses in the window
+
+    size_t start_time;        // Timestamp the window starts at, or the
+                              // index of its first access without timestamps
+
+    size_t total_seek;        // Sum of the seek distances into its accesses
+
+    double mean_seek;         // total_seek over the number of seeks, 0 for a
+                              // window with no seeks
+  };
+
   /*
    *  struct: location
    *
@@ -120,20 +222,97 @@ public:
   /// Returns a reference to the mapPBA_ private data member
   std::vector<LBA_location>& get_locations();
 
+  /// Returns true if this TraceSet is dictionary encoded.
+  bool is_dictionary_encoded() const;
+
+  /// Returns the index in mapLBA_ of the given LBA, which is the LBA itself
+  /// unless the TraceSet is dictionary encoded. Returns mapLBA_.size() if the
+  /// LBA does not occur in a dictionary encoded trace.
+  std::size_t get_ID(std::size_t LBA) const;
+
+  /// Returns the LBA whose index in mapLBA_ is ID, which is the ID itself
+  /// unless the TraceSet is dictionary encoded.
+  std::size_t get_LBA(std::size_t ID) const;
+
   /// Adds a string which defines a LBA address and and adds it to the end
   /// of the Sequence_ vector and updates data members apropriately.
   void insert(std::string LBA_to_add);
 
+  /// Adds a LBA which has already been parsed to the end of the Sequence_
+  /// vector and updates data members apropriately.
+  void insert(std::size_t LBA_to_add);
+
+  /// Inserts an access that reads or writes length blocks starting at
+  /// LBA_to_add. The lengths are kept in a column beside Sequence_.
+  void insert(std::size_t LBA_to_add, std::size_t length);
+
   /// Reads in a text file where each line in the text file contains a LBA
   /// and adds each LBA in the text file to the TraceSet data members
   /// apropriately.
   void readIn(std::ifstream& inputstream);
 
+  /// Memory maps the text file called filename, where each line contains a
+  /// LBA, and adds each LBA to the TraceSet data members apropriately without
+  /// building a string per line. Returns the number of bytes that were
+  /// parsed, which is 0 if the file could not be mapped. Like readIn, throws
+  /// std::out_of_range for a LBA too large for a size_t.
+  std::size_t readInMapped(const std::string& filename);
+
+  /// Does the same thing as readInMapped but splits the file into num_threads
+  /// chunks at newline boundaries and parses each chunk on its own thread,
+  /// then stitches the chains of next links across the chunks together. The
+  /// resulting data members are identical to those readInMapped builds. If
+  /// num_threads is 0 one thread per core is used. A LBA too large for a
+  /// size_t throws std::out_of_range before any access is inserted.
+  std::size_t readInParallel(const std::string& filename,
+                             unsigned num_threads);
+
+  /// Reads in a binary trace file (see BinaryTrace.hpp) and adds each LBA in
+  /// it to the TraceSet data members apropriately. Returns the number of
+  /// bytes that were read, which is 0 if the file is not a binary trace or
+  /// is corrupt.
+  std::size_t readInBinary(const std::string& filename);
+
+  /// Memory maps the text trace called filename, where each line holds a LBA
+  /// and optionally the number of blocks the request reads or writes, and
+  /// inserts every request. Returns the number of bytes that were read.
+  std::size_t readInRequests(const std::string& filename);
+
+  /// Writes every data member of the trace to a snapshot file called
+  /// filename (see TraceSnapshot.hpp), which TraceSnapshot can map without
+  /// parsing anything. Returns false if the file could not be written.
+  bool save_snapshot(const std::string& filename);
+
+  /// Replaces the trace with the one in the snapshot file called filename,
+  /// including its locations and whether it is dictionary encoded, by
+  /// copying the mapped sections. Returns the size of the snapshot in bytes,
+  /// which is 0 (and the trace is left unchanged) if the file is not a
+  /// snapshot.
+  std::size_t readInSnapshot(const std::string& filename);
+
+  /// Returns true if some request in the trace is longer than one block.
+  bool has_request_lengths() const;
+
+  /// Returns the number of blocks of the access at the given index of
+  /// Sequence_, which is 1 for traces read without lengths.
+  std::size_t get_request_length(std::size_t index) const;
+
   /// Reads in a text file where each line in the text file contains
   /// a frequent LBA, which will be part of the "hot" partition in our
   /// final disk arrangment.
   std::vector<std::size_t> readLBAs(std::ifstream& inputstream);
 
+  /// Returns the number of accesses of every LBA in the trace, in increasing
+  /// order of LBA, counted with num_threads threads (or every hardware
+  /// thread if num_threads is 0).
+  std::vector<FrequencyRank::Count> count_LBAs(unsigned num_threads);
+
+  /// Returns the LBAs of the trace from most to least accessed, LBAs with the
+  /// same number of accesses are in increasing order. If top_k is not 0 only
+  /// the top_k most accessed LBAs are returned. The accesses are counted with
+  /// num_threads threads, or every hardware thread if num_threads is 0.
+  std::vector<std::size_t> rank_LBAs(std::size_t top_k, unsigned num_threads);
+
 
   /// This function takes in a size_t which is an LBA and returns
   /// a vector of size_ts which represent the indices of all
@@ -148,6 +327,149 @@ public:
   /// of the difference of thier respective location values.
   std::size_t total_seek_distance();
 
+  /// Returns the same value as total_seek_distance(), but splits Sequence_
+  /// into num_threads ranges and scores each range on its own thread. If
+  /// num_threads is 0 the number of hardware threads is used.
+  std::size_t total_seek_distance(unsigned num_threads);
+
+  /// Returns the same value as total_seek_distance(num_threads), and if
+  /// histogram is not nullptr also counts every seek of the trace into it in
+  /// the same pass over the trace (see SeekKernel.hpp). Each thread counts
+  /// its range into its own histogram, and they are merged into histogram in
+  /// range order. Counting the seeks adds about a quarter to the pass when
+  /// the locations do not fit in the cache, and up to three quarters when
+  /// they do.
+  std::size_t total_seek_distance(unsigned num_threads,
+                                  SeekHistogram* histogram);
+
+  /// Returns the histogram of the seek distances of the trace, whose total()
+  /// is total_seek_distance(), counted by total_seek_distance(num_threads,
+  /// histogram).
+  SeekHistogram seek_histogram(unsigned num_threads);
+
+  /// Builds the table of transitions, which holds one Transition for every
+  /// distinct pair of different LBAs that are accessed one right after the
+  /// other, sorted by low then high. Pairs of accesses to the same LBA add
+  /// nothing to the seek distance, so they are left out.
+  void build_transitions();
+
+  /// Returns a reference to the table of transitions, building it first if
+  /// the trace has changed since it was last built.
+  const std::vector<Transition>& get_transitions();
+
+  /// Returns the same value as total_seek_distance(), but computed as the
+  /// sum over the table of transitions of count times the distance between
+  /// the two locations, which only reads one entry per distinct pair.
+  std::size_t transition_seek_distance();
+
+  /// Returns the total seek distance the trace would have in the given
+  /// layout, computed from the table of transitions.
+  std::size_t transition_seek_distance(const LayoutMap& layout);
+
+  /// Returns the estimated total seek time of the trace, the sum over every
+  /// pair of adjacent accesses of model(distance), where model is one of the
+  /// seek cost models in SeekCost.hpp. The model is a template parameter, so
+  /// its cost is inlined into the scan.
+  template <typename SeekModel>
+  double seek_time(const SeekModel& model);
+
+  /// Returns the same estimate as seek_time(model), but computed from the
+  /// table of transitions, calling the model once per distinct pair.
+  template <typename SeekModel>
+  double transition_seek_time(const SeekModel& model);
+
+  /// Returns the total seek distance of the trace behind a buffer cache,
+  /// one of the models in CacheModel.hpp. The cache is cleared and every
+  /// access is given to it in order, only the accesses that miss move the
+  /// head, so each seek is from the location of the previous miss. The hits
+  /// and misses can be read from the cache afterwards. A cache of capacity 0
+  /// gives total_seek_distance().
+  template <typename Cache>
+  std::size_t cached_seek_distance(Cache& cache);
+
+  /// Gives the timestamp of every access in Sequence_, in the same order,
+  /// which must not decrease. Accesses inserted afterwards have no
+  /// timestamps, so call this once the whole trace has been read.
+  void set_timestamps(const std::vector<std::size_t>& timestamps);
+
+  /// Returns true if every access in Sequence_ has a timestamp.
+  bool has_timestamps() const;
+
+  /// Splits the trace into windows of window_accesses accesses (the last one
+  /// can be shorter) and returns the seek statistics of each window, found
+  /// with num_threads threads (every hardware thread if num_threads is 0).
+  /// The total seeks of the windows add up to total_seek_distance().
+  std::vector<Window> window_seek_distance(std::size_t window_accesses,
+                                           unsigned num_threads);
+
+  /// The same as window_seek_distance, but each window holds the accesses
+  /// whose timestamps are in one interval of the given length, starting at
+  /// the first timestamp. Windows with no accesses are kept, so window k
+  /// always starts at the first timestamp plus k times interval. Returns no
+  /// windows if the trace has no timestamps.
+  std::vector<Window> window_seek_distance_by_time(std::size_t interval,
+                                                   unsigned num_threads);
+
+  /// Returns the total seek distance and the estimated service time of the
+  /// trace, found in one pass. Each request waits for the seek from the end
+  /// of the previous request, timed by model, then for the disk to turn, and
+  /// then transfers its blocks, as set by timing. A request that starts
+  /// where the previous one ended needs neither a seek nor a rotation.
+  template <typename SeekModel>
+  ServiceEstimate service_time(const SeekModel& model,
+                               const DiskTiming& timing);
+
+  /// Returns, for each size m in prefix_sizes, the total seek distance the
+  /// trace would have after change_locations was called with the first m
+  /// LBAs in ranked_LBAs and start, without changing any locations. Every LBA
+  /// in ranked_LBAs should occur in the trace.
+  std::vector<std::size_t> sweep_seek_distance(
+      const std::vector<std::size_t>& ranked_LBAs,
+      const std::vector<std::size_t>& prefix_sizes, std::size_t start);
+
+  /// Returns the keys in [0, num_keys) whose blockLBA in mapLBA is used, in
+  /// increasing order of their location in key_locations. Used by the sweeps
+  /// of TraceSet and TraceSnapshot.
+  static std::vector<std::size_t> keys_by_location(
+      const blockLBA* mapLBA, const std::size_t* key_locations,
+      std::size_t num_keys);
+
+  /// Sets locations[key], for every key in sorted_keys (see
+  /// keys_by_location), to the location change_locations would give it if
+  /// the keys whose rank is below moved were moved to start, where rank[key]
+  /// is the index of key in the ranked LBAs of the sweep.
+  static void sweep_locations(const std::vector<std::size_t>& sorted_keys,
+                              const std::vector<std::size_t>& rank,
+                              std::size_t moved, std::size_t start,
+                              const std::size_t* key_locations,
+                              std::size_t* locations);
+
+  /// Returns the change in total_seek_distance() if the given LBA were moved
+  /// to new_location and every other LBA kept its location. Only the
+  /// accesses of the LBA and their neighbours in Sequence_ are read, by
+  /// following the LBA's chain of next indices. If commit is true the LBA is
+  /// also moved, new_location should then be a location no LBA in the trace
+  /// is using (use seek_delta_swap to exchange the locations of two LBAs).
+  long long seek_delta_move(std::size_t LBA, std::size_t new_location,
+                            bool commit);
+
+  /// Returns the change in total_seek_distance() if the two given LBAs
+  /// exchanged locations, reading only the accesses of the two LBAs and
+  /// their neighbours. If commit is true the locations are also exchanged.
+  long long seek_delta_swap(std::size_t first_LBA, std::size_t second_LBA,
+                            bool commit);
+
+  /// Returns the bytes held by each of the data members of the TraceSet,
+  /// Sequence_, mapLBA_ and locations_ first and then the dictionary, the
+  /// columns, the table of transitions, the request lengths and the
+  /// timestamps.
+  std::vector<MemoryStats::Container> memory_usage() const;
+
+  /// Marks the table of transitions as out of date, so that it is rebuilt
+  /// from Sequence_ before it is next used. Only needed if Sequence_ is
+  /// changed through a reference taken before the table was last built.
+  void invalidate_transitions();
+
   /// This function takes in a vector of size_ts that are LBAs in the
   /// mapLBA_ vector and a size_t start, where the ordeor of the LBAs in
   /// the vector represents a reordering of the locations that are associated
@@ -160,6 +482,10 @@ public:
   ///
   /// The locations of the LBAs that are not in the input vector will then be
   /// shifted so that no LBAs have the same location.
+  ///
+  /// Finding the new order takes O(k log n) time for k LBAs (see
+  /// LocationTree.hpp). The slots from start to the farthest old location of
+  /// a moved LBA are then written, since every one of them is shifted.
   void change_locations(std::vector<std::size_t> LBA_vector, std::size_t start);
 
   /// This is a helper function for change_location, the function takes in a
@@ -176,10 +502,34 @@ public:
   /// assigned different locations_ in the mapLBA_ and locations_ data members
   /// then it will change the location assigned to the LBA in mapLBA_ to match
   /// the LBA in locations_.
+  ///
+  /// It then copies the location of every LBA in mapLBA_ into the column the
+  /// seek distance scans read, so it must be called after locations are
+  /// changed through get_mapLBA() or get_locations().
   void fix_locations();
 
 private:
 
+  /// This is the version of change_locations used by a dictionary encoded
+  /// TraceSet, it gives each ID the location that change_locations would give
+  /// its LBA in a TraceSet that is not dictionary encoded.
+  void change_dictionary_locations(const std::vector<std::size_t>& LBA_vector,
+                                   std::size_t start);
+
+  /// Returns the change in the distance of every pair of consecutive
+  /// accesses where one access is to key and the other is not to key or to
+  /// skip_key, if the location of key went from old_location to new_location.
+  long long chain_delta(std::size_t key, std::size_t old_location,
+                        std::size_t new_location, std::size_t skip_key);
+
+  /// Sets the location of key to new_location in mapLBA_ and
+  /// key_locations_.
+  void set_key_location(std::size_t key, std::size_t new_location);
+
+  // Fills in total_seek and mean_seek of windows whose first_access and
+  // num_accesses are set, using num_threads threads.
+  void score_windows(std::vector<Window>& windows, unsigned num_threads);
+
   // Sequence_ is an vector of TraceSet structs, which together contain
   // the entirety of the trace. The indices of Sequence_ correspond to the order
   // access.
@@ -216,7 +566,193 @@ private:
   // This data member allows for quick look up of LBAs when given a location.
   std::vector<LBA_location> locations_;
 
+  // access_keys_ holds the LBA data member of every Line in Sequence_, in
+  // order, which is the index into key_locations_ of each access.
+  std::vector<std::size_t> access_keys_;
+
+  // key_locations_ holds the location data member of every blockLBA in
+  // mapLBA_, indexed the same way as mapLBA_.
+  std::vector<std::size_t> key_locations_;
+
+  // dictionary_ is true if the TraceSet is dictionary encoded.
+  bool dictionary_;
+
+  // LBA_IDs_ is a hashtable where the keys are the LBAs in a dictionary
+  // encoded trace and the values are their IDs. It is empty otherwise.
+  std::unordered_map<std::size_t, std::size_t> LBA_IDs_;
+
+  // ID_LBAs_ is a vector indexed by ID which holds the LBA given that ID in a
+  // dictionary encoded trace. It is empty otherwise.
+  std::vector<std::size_t> ID_LBAs_;
+
+  // transitions_ is the table of transitions built by build_transitions().
+  std::vector<Transition> transitions_;
+
+  // transition_accesses_ is the number of accesses transitions_ was built
+  // from, if accesses have been added since then the table is rebuilt.
+  std::size_t transition_accesses_;
+
+  // transitions_stale_ is true if transitions_ must be rebuilt because
+  // Sequence_ may have been changed.
+  bool transitions_stale_;
+
+  // request_lengths_ holds the number of blocks of every access in Sequence_,
+  // it is empty if every request is one block long.
+  std::vector<std::size_t> request_lengths_;
+
+  // timestamps_ holds the time of every access in Sequence_ given to
+  // set_timestamps, it is empty if the trace has no timestamps.
+  std::vector<std::size_t> timestamps_;
+
 };
 
+/**
+ * function: seek_time(const SeekModel& model)
+ *
+ * The same scan of the access_keys_ and key_locations_ columns as
+ * total_seek_distance(), with the distance of each seek given to the model.
+ */
+template <typename SeekModel>
+double TraceSet::seek_time(const SeekModel& model)
+{
+  const std::size_t* keys = access_keys_.data();
+  const std::size_t* locations = key_locations_.data();
+
+  double total_time = 0;
+  for (std::size_t i = 1; i < access_keys_.size(); ++i) {
+
+    std::size_t previous = locations[keys[i - 1]];
+    std::size_t current = locations[keys[i]];
+
+    total_time += model(previous < current ? current - previous
+                                           : previous - current);
+  }
+
+  return total_time;
+}
+
+/**
+ * function: transition_seek_time(const SeekModel& model)
+ *
+ * Seeks between accesses to the same LBA are not in the table, which is
+ * why every model must give a seek of distance 0 a time of 0.
+ */
+template <typename SeekModel>
+double TraceSet::transition_seek_time(const SeekModel& model)
+{
+  const std::vector<Transition>& transitions = get_transitions();
+  const std::size_t* locations = key_locations_.data();
+
+  double total_time = 0;
+  for (std::size_t i = 0; i < transitions.size(); ++i) {
+
+    std::size_t low_location = locations[transitions[i].low];
+    std::size_t high_location = locations[transitions[i].high];
+
+    total_time += static_cast<double>(transitions[i].count) *
+                  model(low_location < high_location
+                        ? high_location - low_location
+                        : low_location - high_location);
+  }
+
+  return total_time;
+}
+
+/**
+ * function: cached_seek_distance(Cache& cache)
+ *
+ * The same scan of the access_keys_ and key_locations_ columns as
+ * total_seek_distance(), with the location of each key only read on a miss.
+ */
+template <typename Cache>
+std::size_t TraceSet::cached_seek_distance(Cache& cache)
+{
+  cache.clear(key_locations_.size());
+
+  const std::size_t* keys = access_keys_.data();
+  const std::size_t* locations = key_locations_.data();
+
+  std::size_t total_distance = 0;
+  std::size_t head = 0;
+  bool moved = false;
+  for (std::size_t i = 0; i < access_keys_.size(); ++i) {
+
+    if (cache.access(keys[i])) {
+      continue;
+    }
+
+    std::size_t current = locations[keys[i]];
+    if (moved) {
+      total_distance += head < current ? current - head : head - current;
+    }
+    head = current;
+    moved = true;
+  }
+
+  return total_distance;
+}
+
+/**
+ * function: service_time(const SeekModel& model, const DiskTiming& timing)
+ *
+ * The blocks of a request are taken to follow its first block in the layout,
+ * so the head ends a request at the location of its LBA plus its length. The
+ * seek distance is still taken between the starts of the requests, so that
+ * it matches total_seek_distance(). The first request needs a rotation but
+ * no seek.
+ */
+template <typename SeekModel>
+ServiceEstimate TraceSet::service_time(const SeekModel& model,
+                                       const DiskTiming& timing)
+{
+  const std::size_t* keys = access_keys_.data();
+  const std::size_t* locations = key_locations_.data();
+  const std::size_t* lengths =
+      request_lengths_.size() == access_keys_.size() ? request_lengths_.data()
+                                                     : nullptr;
+
+  ServiceEstimate estimate;
+  estimate.seek_distance = 0;
+  estimate.seek_time = 0;
+  estimate.rotation_time = 0;
+  estimate.transfer_time = 0;
+  if (access_keys_.empty()) {
+    return estimate;
+  }
+
+  std::size_t total_blocks = lengths == nullptr ? access_keys_.size()
+                                                : lengths[0];
+  std::size_t rotations = 1;
+
+  std::size_t previous = locations[keys[0]];
+  std::size_t head = previous + (lengths == nullptr ? 1 : lengths[0]);
+  for (std::size_t i = 1; i < access_keys_.size(); ++i) {
+
+    std::size_t current = locations[keys[i]];
+    std::size_t length = lengths == nullptr ? 1 : lengths[i];
+
+    estimate.seek_distance += previous < current ? current - previous
+                                                 : previous - current;
+    if (current != head) {
+      estimate.seek_time += model(head < current ? current - head
+                                                 : head - current);
+      ++rotations;
+    }
+    if (lengths != nullptr) {
+      total_blocks += length;
+    }
+
+    previous = current;
+    head = current + length;
+  }
+
+  estimate.rotation_time = static_cast<double>(rotations) *
+                           timing.rotational_latency;
+  estimate.transfer_time = static_cast<double>(total_blocks) *
+                           timing.transfer_per_block;
+
+  return estimate;
+}
+
 #endif // TRACESET_HPP_INCLUDED
 
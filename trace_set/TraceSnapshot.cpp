@@ -0,0 +1,412 @@
+/*
+* TraceSnapshot.cpp
+*
+* Authors: Jazmin Ortiz
+*
+* Implementation of the TraceSnapshot class, which memory maps a snapshot of a
+* TraceSet written by TraceSet::save_snapshot.
+*
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TraceSnapshot.hpp"
+#include "SeekKernel.hpp"
+
+using namespace std;
+
+// The first four bytes of every snapshot file
+static const char MAGIC[4] = {'L', 'B', 'A', 'S'};
+
+// The size of one element of each section, in the order of Section
+static const size_t ELEMENT_SIZES[TraceSnapshot::NUM_SECTIONS] = {
+  sizeof(TraceSet::Line),
+  sizeof(TraceSet::blockLBA),
+  sizeof(TraceSet::LBA_location),
+  sizeof(size_t),
+  sizeof(size_t),
+  sizeof(size_t),
+  sizeof(size_t),
+  sizeof(size_t)
+};
+
+// Definitions for the static data members
+const uint32_t TraceSnapshot::VERSION;
+const size_t TraceSnapshot::PAGE_SIZE;
+
+// Default constructor for TraceSnapshot
+TraceSnapshot::TraceSnapshot():
+  fd_{-1},
+  data_{nullptr},
+  size_{0},
+  writable_{false}
+{
+  memset(&header_, 0, sizeof(header_));
+}
+
+// Destructor for TraceSnapshot
+TraceSnapshot::~TraceSnapshot()
+{
+  close();
+}
+
+/**
+ * function: open(const string& filename, bool copy_on_write)
+ *
+ * A read only mapping is shared, so every process that opens the snapshot
+ * reads the same pages of the page cache. A copy on write mapping is private,
+ * it shares the pages too until one is written, which copies that page.
+ */
+bool TraceSnapshot::open(const string& filename, bool copy_on_write)
+{
+  close();
+
+  fd_ = ::open(filename.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    return false;
+  }
+
+  struct stat file_info;
+  if (fstat(fd_, &file_info) != 0 ||
+      static_cast<size_t>(file_info.st_size) < sizeof(Header)) {
+    close();
+    return false;
+  }
+
+  size_ = static_cast<size_t>(file_info.st_size);
+  void* mapping = mmap(nullptr, size_,
+                       copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+                       copy_on_write ? MAP_PRIVATE : MAP_SHARED, fd_, 0);
+  if (mapping == MAP_FAILED) {
+    close();
+    return false;
+  }
+  data_ = static_cast<char*>(mapping);
+  writable_ = copy_on_write;
+
+  memcpy(&header_, data_, sizeof(Header));
+
+  bool valid = memcmp(header_.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               header_.version == VERSION;
+  for (size_t i = 0; valid && i < NUM_SECTIONS; ++i) {
+    // The count is compared with the room left rather than multiplied out,
+    // so that a huge count cannot overflow into a small size.
+    valid = header_.element_sizes[i] == ELEMENT_SIZES[i] &&
+            header_.offsets[i] % PAGE_SIZE == 0 &&
+            (header_.counts[i] == 0 ||
+             (header_.offsets[i] <= size_ &&
+              header_.counts[i] <= (size_ - header_.offsets[i]) /
+                                   ELEMENT_SIZES[i]));
+  }
+  valid = valid && header_.counts[ACCESS_KEYS] == header_.counts[SEQUENCE] &&
+          header_.counts[KEY_LOCATIONS] == header_.counts[MAP_LBA];
+
+  if (!valid) {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * function: close()
+ *
+ * Unmaps the file and closes the file descriptor if a file is open.
+ */
+void TraceSnapshot::close()
+{
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+
+  fd_ = -1;
+  data_ = nullptr;
+  size_ = 0;
+  writable_ = false;
+  memset(&header_, 0, sizeof(header_));
+}
+
+/**
+ * function: is_open()
+ */
+bool TraceSnapshot::is_open() const
+{
+  return data_ != nullptr;
+}
+
+/**
+ * function: header()
+ */
+const TraceSnapshot::Header& TraceSnapshot::header() const
+{
+  return header_;
+}
+
+/**
+ * function: size()
+ */
+size_t TraceSnapshot::size() const
+{
+  return size_;
+}
+
+/**
+ * function: is_dictionary_encoded()
+ */
+bool TraceSnapshot::is_dictionary_encoded() const
+{
+  return header_.dictionary_encoded != 0;
+}
+
+/**
+ * function: num_accesses()
+ */
+size_t TraceSnapshot::num_accesses() const
+{
+  return header_.counts[SEQUENCE];
+}
+
+/**
+ * function: num_keys()
+ */
+size_t TraceSnapshot::num_keys() const
+{
+  return header_.counts[MAP_LBA];
+}
+
+/**
+ * function: count(Section section)
+ */
+size_t TraceSnapshot::count(Section section) const
+{
+  return header_.counts[section];
+}
+
+/**
+ * function: section(Section which)
+ *
+ * An empty section may start past the end of the file, so nullptr is
+ * returned for it.
+ */
+const char* TraceSnapshot::section(Section which) const
+{
+  if (data_ == nullptr || header_.counts[which] == 0) {
+    return nullptr;
+  }
+  return data_ + header_.offsets[which];
+}
+
+/**
+ * function: sequence()
+ */
+const TraceSet::Line* TraceSnapshot::sequence() const
+{
+  return reinterpret_cast<const TraceSet::Line*>(section(SEQUENCE));
+}
+
+/**
+ * function: mapLBA()
+ */
+const TraceSet::blockLBA* TraceSnapshot::mapLBA() const
+{
+  return reinterpret_cast<const TraceSet::blockLBA*>(section(MAP_LBA));
+}
+
+/**
+ * function: locations()
+ */
+const TraceSet::LBA_location* TraceSnapshot::locations() const
+{
+  return reinterpret_cast<const TraceSet::LBA_location*>(section(LOCATIONS));
+}
+
+/**
+ * function: ID_LBAs()
+ */
+const size_t* TraceSnapshot::ID_LBAs() const
+{
+  return reinterpret_cast<const size_t*>(section(ID_LBAS));
+}
+
+/**
+ * function: access_keys()
+ */
+const size_t* TraceSnapshot::access_keys() const
+{
+  return reinterpret_cast<const size_t*>(section(ACCESS_KEYS));
+}
+
+/**
+ * function: key_locations()
+ */
+const size_t* TraceSnapshot::key_locations() const
+{
+  return reinterpret_cast<const size_t*>(section(KEY_LOCATIONS));
+}
+
+/**
+ * function: mutable_key_locations()
+ */
+size_t* TraceSnapshot::mutable_key_locations()
+{
+  if (!writable_) {
+    return nullptr;
+  }
+  return const_cast<size_t*>(key_locations());
+}
+
+/**
+ * function: request_lengths()
+ */
+const size_t* TraceSnapshot::request_lengths() const
+{
+  return reinterpret_cast<const size_t*>(section(REQUEST_LENGTHS));
+}
+
+/**
+ * function: timestamps()
+ */
+const size_t* TraceSnapshot::timestamps() const
+{
+  return reinterpret_cast<const size_t*>(section(TIMESTAMPS));
+}
+
+/**
+ * function: total_seek_distance()
+ *
+ * The mapped columns hold the same keys and locations TraceSet scans, so
+ * they are given to the same SeekKernel.
+ */
+size_t TraceSnapshot::total_seek_distance() const
+{
+  if (!is_open()) {
+    return 0;
+  }
+  return SeekKernel::distance(access_keys(), num_accesses(), key_locations());
+}
+
+/**
+ * function: sweep_seek_distance(const vector<size_t>& ranked_LBAs,
+ *                               const vector<size_t>& prefix_sizes,
+ *                               size_t start)
+ *
+ * The keys of the ranked LBAs are found the way TraceSet::get_ID finds them,
+ * through a hashtable of the ranked LBAs for a dictionary encoded trace. The
+ * locations of each prefix are written into one private vector, the mapped
+ * key_locations() are only read.
+ */
+vector<size_t> TraceSnapshot::sweep_seek_distance(
+    const vector<size_t>& ranked_LBAs, const vector<size_t>& prefix_sizes,
+    size_t start) const
+{
+  vector<size_t> distances;
+  if (!is_open()) {
+    return distances;
+  }
+
+  size_t keys = num_keys();
+
+  // rank[key] is the index of the key in ranked_LBAs, or ranked_LBAs.size()
+  // if it is not there.
+  vector<size_t> rank(keys, ranked_LBAs.size());
+  if (is_dictionary_encoded()) {
+    unordered_map<size_t, size_t> rank_of_LBA;
+    for (size_t i = 0; i < ranked_LBAs.size(); ++i) {
+      rank_of_LBA.emplace(ranked_LBAs[i], i);
+    }
+    const size_t* LBAs = ID_LBAs();
+    for (size_t key = 0; key < keys && key < count(ID_LBAS); ++key) {
+      unordered_map<size_t, size_t>::const_iterator found =
+          rank_of_LBA.find(LBAs[key]);
+      if (found != rank_of_LBA.end()) {
+        rank[key] = found->second;
+      }
+    }
+  }
+  else {
+    for (size_t i = 0; i < ranked_LBAs.size(); ++i) {
+      size_t key = ranked_LBAs[i];
+      if (key < keys && rank[key] == ranked_LBAs.size()) {
+        rank[key] = i;
+      }
+    }
+  }
+
+  vector<size_t> sorted_keys =
+      TraceSet::keys_by_location(mapLBA(), key_locations(), keys);
+
+  vector<size_t> locations(key_locations(), key_locations() + keys);
+  distances.reserve(prefix_sizes.size());
+
+  for (size_t p = 0; p < prefix_sizes.size(); ++p) {
+
+    TraceSet::sweep_locations(sorted_keys, rank,
+                              min(prefix_sizes[p], ranked_LBAs.size()), start,
+                              key_locations(), locations.data());
+
+    distances.push_back(SeekKernel::distance(access_keys(), num_accesses(),
+                                             locations.data()));
+  }
+
+  return distances;
+}
+
+/**
+ * function: layout(bool dictionary_encoded, const size_t counts[])
+ *
+ * The header takes the first page and each section starts on the page after
+ * the end of the one before it.
+ */
+TraceSnapshot::Header TraceSnapshot::layout(bool dictionary_encoded,
+                                            const size_t counts[NUM_SECTIONS])
+{
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.dictionary_encoded = dictionary_encoded ? 1 : 0;
+
+  uint64_t offset = PAGE_SIZE;
+  for (size_t i = 0; i < NUM_SECTIONS; ++i) {
+    header.element_sizes[i] = static_cast<uint32_t>(ELEMENT_SIZES[i]);
+    header.counts[i] = counts[i];
+    header.offsets[i] = offset;
+    uint64_t bytes = counts[i] * ELEMENT_SIZES[i];
+    offset += (bytes + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+  }
+
+  return header;
+}
+
+/**
+ * function: is_snapshot(const string& filename)
+ *
+ * Reads the first four bytes of the file and compares them to the magic bytes.
+ */
+bool TraceSnapshot::is_snapshot(const string& filename)
+{
+  ifstream in(filename, ios::binary);
+  char magic[4];
+
+  if (!in.read(magic, sizeof(magic))) {
+    return false;
+  }
+
+  return memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
@@ -0,0 +1,205 @@
+/**
+* TraceSnapshot.hpp
+*
+* Authors: Jazmin Ortiz
+*
+* This is a class called TraceSnapshot, which memory maps a snapshot file
+* written by TraceSet::save_snapshot, so that a trace which has already been
+* parsed once can be evaluated again without reading any text.
+*
+* A snapshot file holds the data members of a TraceSet as they are laid out in
+* memory: Sequence_, mapLBA_, locations_, the ID of every LBA of a dictionary
+* encoded trace, a column of the key of every access and one of the location
+* of every key, the request lengths and the timestamps. It starts with a
+* fixed size Header that gives the number of elements in each section and its
+* offset in the file, and every section starts on a page boundary.
+* TraceSnapshot hands out pointers straight into the mapping, so opening a
+* snapshot reads nothing but the header, the pages of a section are only read
+* from disk when they are first touched, and every process that maps the same
+* snapshot shares the same physical pages through the page cache.
+*
+* A snapshot is mapped read only, or copy on write, in which case the
+* locations of the keys can be changed through mutable_key_locations() to
+* score other layouts. Only the pages that are written are copied, and the
+* file itself is never changed.
+*
+* TraceSet::readInSnapshot copies the sections of a snapshot into a TraceSet,
+* for code that needs a TraceSet it can change.
+*
+* NOTE: The sections are written in the byte order and struct layout of the
+* machine that wrote the file, and a snapshot whose struct sizes do not match
+* is rejected by open(). A snapshot should be taken on the machine that uses
+* it.
+*
+*/
+
+#ifndef TRACESNAPSHOT_HPP_INCLUDED
+#define TRACESNAPSHOT_HPP_INCLUDED 1
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TraceSet.hpp"
+
+class TraceSnapshot{
+
+public:
+
+  /// The version of the format written by TraceSet::save_snapshot, a file
+  /// with a different version is rejected by open().
+  static const std::uint32_t VERSION = 1;
+
+  /// The sections of a snapshot file, in the order they are written.
+  enum Section {
+    SEQUENCE,           // Sequence_, one Line per access
+    MAP_LBA,            // mapLBA_, one blockLBA per key
+    LOCATIONS,          // locations_, one LBA_location per location
+    ID_LBAS,            // The LBA of every ID of a dictionary encoded trace
+    ACCESS_KEYS,        // The key of every access
+    KEY_LOCATIONS,      // The location of every key
+    REQUEST_LENGTHS,    // The length of every request, if there are lengths
+    TIMESTAMPS,         // The time of every access, if there are timestamps
+    NUM_SECTIONS
+  };
+
+  /*
+   * struct: Header
+   *
+   * The fixed size header at the start of every snapshot file.
+   */
+  struct Header {
+
+    char magic[4];                          // Always "LBAS"
+
+    std::uint32_t version;                  // See VERSION
+
+    std::uint32_t dictionary_encoded;       // 1 if the trace is dictionary
+                                            // encoded, 0 otherwise
+
+    std::uint32_t element_sizes[NUM_SECTIONS];  // sizeof each element type,
+                                                // checked by open()
+
+    std::uint64_t counts[NUM_SECTIONS];     // Number of elements in each
+                                            // section
+
+    std::uint64_t offsets[NUM_SECTIONS];    // Byte offset of each section,
+                                            // a multiple of PAGE_SIZE
+
+  };
+
+  /// Sections start at a multiple of this many bytes.
+  static const std::size_t PAGE_SIZE = 4096;
+
+  ///<Constructor creates a TraceSnapshot which has no file mapped.
+  TraceSnapshot();
+
+  ///<Destructor unmaps the file if one is mapped.
+  ~TraceSnapshot();
+
+  /// Maps the snapshot file called filename and checks its header. The file
+  /// is mapped read only unless copy_on_write is true. Returns false if the
+  /// file could not be mapped, is not a snapshot of the current version, was
+  /// written with different struct sizes or is shorter than its header says.
+  bool open(const std::string& filename, bool copy_on_write);
+
+  /// Unmaps the file if one is mapped.
+  void close();
+
+  /// Returns true if a snapshot is mapped.
+  bool is_open() const;
+
+  /// Returns the header of the mapped file.
+  const Header& header() const;
+
+  /// Returns the size of the mapped file in bytes.
+  std::size_t size() const;
+
+  /// Returns true if the snapshot is of a dictionary encoded trace.
+  bool is_dictionary_encoded() const;
+
+  /// Returns the number of accesses in the trace.
+  std::size_t num_accesses() const;
+
+  /// Returns the number of keys, the size of mapLBA_ in the TraceSet.
+  std::size_t num_keys() const;
+
+  /// Returns the number of elements in the given section.
+  std::size_t count(Section section) const;
+
+  /// Returns the Sequence_ of the trace, num_accesses() Lines long.
+  const TraceSet::Line* sequence() const;
+
+  /// Returns the mapLBA_ of the trace, num_keys() blockLBAs long.
+  const TraceSet::blockLBA* mapLBA() const;
+
+  /// Returns the locations_ of the trace, count(LOCATIONS) long.
+  const TraceSet::LBA_location* locations() const;
+
+  /// Returns the LBA of every ID of a dictionary encoded trace,
+  /// count(ID_LBAS) long.
+  const std::size_t* ID_LBAs() const;
+
+  /// Returns the key of every access, num_accesses() long.
+  const std::size_t* access_keys() const;
+
+  /// Returns the location of every key, num_keys() long.
+  const std::size_t* key_locations() const;
+
+  /// Returns the location of every key for writing, or nullptr if the
+  /// snapshot was not opened copy on write.
+  std::size_t* mutable_key_locations();
+
+  /// Returns the length of every request, count(REQUEST_LENGTHS) long.
+  const std::size_t* request_lengths() const;
+
+  /// Returns the time of every access, count(TIMESTAMPS) long.
+  const std::size_t* timestamps() const;
+
+  /// Returns the total seek distance of the trace with the current key
+  /// locations, the same value as TraceSet::total_seek_distance(), read
+  /// straight from the mapped columns.
+  std::size_t total_seek_distance() const;
+
+  /// Returns the same distances as TraceSet::sweep_seek_distance on the
+  /// trace of the snapshot, scored from the mapped sections without copying
+  /// the trace. A snapshot has no table of transitions, so each prefix costs
+  /// one pass over the keys and one SeekKernel scan of the accesses.
+  std::vector<std::size_t> sweep_seek_distance(
+      const std::vector<std::size_t>& ranked_LBAs,
+      const std::vector<std::size_t>& prefix_sizes, std::size_t start) const;
+
+  /// Returns the header of a snapshot with the given number of elements in
+  /// each section, with its offsets filled in. Used by save_snapshot.
+  static Header layout(bool dictionary_encoded,
+                       const std::size_t counts[NUM_SECTIONS]);
+
+  /// Returns true if the file called filename starts with the magic bytes of
+  /// a snapshot.
+  static bool is_snapshot(const std::string& filename);
+
+private:
+
+  // A TraceSnapshot owns its mapping, so it cannot be copied.
+  TraceSnapshot(const TraceSnapshot&);
+  TraceSnapshot& operator=(const TraceSnapshot&);
+
+  // Returns the start of the given section in the mapping.
+  const char* section(Section which) const;
+
+  int fd_;                    // File descriptor of the mapped file, -1 if
+                              // no file is open.
+
+  char* data_;                // Start of the mapping, nullptr if no file is
+                              // open.
+
+  std::size_t size_;          // Size of the mapping in bytes.
+
+  bool writable_;             // True if the mapping is copy on write.
+
+  Header header_;             // Copy of the header at the start of data_.
+
+};
+
+#endif // TRACESNAPSHOT_HPP_INCLUDED
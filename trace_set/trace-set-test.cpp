@@ -7,13 +7,53 @@
  */
 
 #include "TraceSet.hpp"
+#include "BinaryTrace.hpp"
+#include "LayoutMap.hpp"
+#include "SeekKernel.hpp"
+#include "LocationTree.hpp"
+#include "FrequencyRank.hpp"
+#include "PlacementStrategy.hpp"
+#include "LayoutOptimizer.hpp"
+#include "SeekCost.hpp"
+#include "SeekHistogram.hpp"
+#include "TraceSnapshot.hpp"
+#include "MemoryStats.hpp"
+#include "TraceGenerator.hpp"
+#include "CacheModel.hpp"
 #include "gtest/gtest.h"
 
 #include <memory>
 #include <fstream> 
+#include <cstdio>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include <list>
+#include <map>
 
 using namespace std;
 
+/// Advances the linear congruential generator the tests draw their random
+/// traces from, and returns its new state.
+static size_t next_random(size_t& state)
+{
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state;
+}
+
+/// Returns num_accesses LBAs in [0, range) drawn from the generator started
+/// at seed, so that every run of a test sees the same trace.
+static vector<size_t> random_accesses(size_t num_accesses, size_t seed,
+                                      size_t range)
+{
+    vector<size_t> accesses;
+    size_t state = seed;
+    for (size_t i = 0; i < num_accesses; ++i) {
+        accesses.push_back((next_random(state) >> 33) % range);
+    }
+    return accesses;
+}
+
 //--------------------------------------------------
 //           TEST FUNCTIONS
 //--------------------------------------------------
@@ -917,6 +957,1945 @@ TEST(change_locations, noncontiguous_set_large)
 
 }
 
+/// Test that readInMapped builds the same trace as readIn
+TEST(readInMapped, matches_readIn)
+{
+    string fileName = "mappedReadTest";
+    ofstream out(fileName);
+    for (size_t i = 0; i < 1000; ++i) {
+        out << (i * 7919) % 613 << "\n";
+    }
+    out.close();
+
+    TraceSet expected;
+    ifstream in(fileName);
+    expected.readIn(in);
+
+    TraceSet test;
+    size_t bytes = test.readInMapped(fileName);
+    remove(fileName.c_str());
+
+    vector<TraceSet::Line>& expected_sequence = expected.get_Sequence();
+    vector<TraceSet::Line>& test_sequence = test.get_Sequence();
+    assert(bytes > 0);
+    assert(test_sequence.size() == expected_sequence.size());
+    for (size_t i = 0; i < test_sequence.size(); ++i) {
+        assert(test_sequence[i].LBA == expected_sequence[i].LBA);
+    }
+    for (size_t LBA = 0; LBA < 613; ++LBA) {
+        assert(test.get_indices(LBA) == expected.get_indices(LBA));
+    }
+    assert(test.total_seek_distance() == expected.total_seek_distance());
+}
+
+/// Test that readInMapped handles long lines, blank lines, carriage returns
+/// and a last line without a newline
+TEST(readInMapped, odd_lines)
+{
+    string fileName = "mappedOddTest";
+    ofstream out(fileName);
+    out << "12\n\n000000000000000000000000000034\r\n5 extra\n   7\n99";
+    out.close();
+
+    TraceSet test;
+    test.readInMapped(fileName);
+    remove(fileName.c_str());
+
+    vector<TraceSet::Line>& test_sequence = test.get_Sequence();
+    assert(test_sequence.size() == 5);
+    assert(test_sequence[0].LBA == 12);
+    assert(test_sequence[1].LBA == 34);
+    assert(test_sequence[2].LBA == 5);
+    assert(test_sequence[3].LBA == 7);
+    assert(test_sequence[4].LBA == 99);
+}
+
+/// Test that readInMapped returns 0 for a file that does not exist
+TEST(readInMapped, missing_file)
+{
+    TraceSet test;
+    assert(test.readInMapped("doesNotExist") == 0);
+    assert(test.get_Sequence().empty());
+}
+
+/// Test that every text loader throws std::out_of_range for a LBA that does
+/// not fit in 64 bits, and that the largest 64 bit LBA still parses
+TEST(readInMapped, overflow)
+{
+    const char* largest = "18446744073709551615";
+    size_t LBA = 0;
+    bool parsed = MappedTrace::parse_LBA(largest, largest + 20, LBA);
+    assert(parsed);
+    assert(LBA == ~size_t(0));
+
+    const char* lines[] = {"18446744073709551616", "18446744073709551620",
+                           "100000000000000000000"};
+    for (size_t i = 0; i < 3; ++i) {
+
+        string fileName = "mappedOverflowTest";
+        ofstream out(fileName);
+        out << "12\n" << lines[i] << "\n7\n";
+        out.close();
+
+        bool threw = false;
+        try {
+            TraceSet test;
+            test.readInMapped(fileName);
+        } catch (const out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        threw = false;
+        try {
+            TraceSet test;
+            test.readInParallel(fileName, 2);
+        } catch (const out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        threw = false;
+        try {
+            TraceSet test;
+            ifstream in(fileName);
+            test.readIn(in);
+        } catch (const out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        remove(fileName.c_str());
+    }
+}
+
+/// Checks that two TraceSets have identical data members
+static void assert_same_trace(TraceSet& expected, TraceSet& test)
+{
+    vector<TraceSet::Line>& expected_sequence = expected.get_Sequence();
+    vector<TraceSet::Line>& test_sequence = test.get_Sequence();
+    assert(test_sequence.size() == expected_sequence.size());
+    for (size_t i = 0; i < test_sequence.size(); ++i) {
+        assert(test_sequence[i].LBA == expected_sequence[i].LBA);
+        assert(test_sequence[i].next == expected_sequence[i].next);
+    }
+
+    vector<TraceSet::blockLBA>& expected_mapLBA = expected.get_mapLBA();
+    vector<TraceSet::blockLBA>& test_mapLBA = test.get_mapLBA();
+    assert(test_mapLBA.size() == expected_mapLBA.size());
+    for (size_t i = 0; i < test_mapLBA.size(); ++i) {
+        assert(test_mapLBA[i].used == expected_mapLBA[i].used);
+        if (test_mapLBA[i].used) {
+            assert(test_mapLBA[i].first == expected_mapLBA[i].first);
+            assert(test_mapLBA[i].last == expected_mapLBA[i].last);
+            assert(test_mapLBA[i].location == expected_mapLBA[i].location);
+        }
+    }
+
+    vector<TraceSet::LBA_location>& expected_locations =
+        expected.get_locations();
+    vector<TraceSet::LBA_location>& test_locations = test.get_locations();
+    assert(test_locations.size() == expected_locations.size());
+    for (size_t i = 0; i < test_locations.size(); ++i) {
+        assert(test_locations[i].used == expected_locations[i].used);
+        if (test_locations[i].used) {
+            assert(test_locations[i].LBA == expected_locations[i].LBA);
+        }
+    }
+}
+
+/// Test that readInParallel builds the same trace as readInMapped for
+/// several numbers of threads
+TEST(readInParallel, matches_readInMapped)
+{
+    string fileName = "parallelReadTest";
+    ofstream out(fileName);
+    for (size_t i = 0; i < 5000; ++i) {
+        out << (i * i * 31) % 1777 + (i / 100) * 13 << "\n";
+    }
+    out.close();
+
+    TraceSet expected;
+    expected.readInMapped(fileName);
+
+    for (unsigned threads = 1; threads <= 9; threads += 2) {
+        TraceSet test;
+        test.readInParallel(fileName, threads);
+        assert_same_trace(expected, test);
+    }
+
+    remove(fileName.c_str());
+}
+
+/// Test that readInParallel links new accesses to a trace that was already
+/// partly loaded
+TEST(readInParallel, appends)
+{
+    string fileName = "parallelAppendTest";
+    ofstream out(fileName);
+    for (size_t i = 0; i < 300; ++i) {
+        out << i % 37 << "\n";
+    }
+    out.close();
+
+    TraceSet expected;
+    TraceSet test;
+    for (size_t i = 0; i < 20; ++i) {
+        expected.insert(i * 3);
+        test.insert(i * 3);
+    }
+
+    expected.readInMapped(fileName);
+    test.readInParallel(fileName, 4);
+    remove(fileName.c_str());
+
+    assert_same_trace(expected, test);
+}
+
+/// Test that a trace written by BinaryTraceWriter is loaded by readInBinary
+/// into the same trace that the text version builds
+TEST(readInBinary, matches_readInMapped)
+{
+    string textName = "binaryTextTest";
+    string binaryName = "binaryTest.bin";
+
+    // Large jumps in both directions so that the differences take several
+    // bytes and are negative as often as positive.
+    vector<size_t> LBAs;
+    size_t max_LBA = 0;
+    for (size_t i = 0; i < 2000; ++i) {
+        LBAs.push_back((i * 104729) % 100003);
+        max_LBA = max(max_LBA, LBAs.back());
+    }
+    LBAs.push_back(0);
+    LBAs.push_back(0);
+
+    ofstream out(textName);
+    BinaryTraceWriter writer(binaryName);
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        out << LBAs[i] << "\n";
+        writer.append(LBAs[i]);
+    }
+    out.close();
+    bool closed = writer.close();
+    assert(closed);
+
+    BinaryTrace binary;
+    bool opened = binary.open(binaryName);
+    assert(opened);
+    assert(binary.header().num_accesses == LBAs.size());
+    assert(binary.header().max_LBA == max_LBA);
+    assert(binary.header().unique_LBAs == 2000);
+    assert(BinaryTrace::is_binary_trace(binaryName));
+    assert(!BinaryTrace::is_binary_trace(textName));
+
+    TraceSet expected;
+    expected.readInMapped(textName);
+
+    TraceSet test;
+    size_t bytes = test.readInBinary(binaryName);
+    assert(bytes == binary.size());
+
+    remove(textName.c_str());
+    remove(binaryName.c_str());
+
+    assert_same_trace(expected, test);
+}
+
+/// Test that the largest 64 bit LBAs survive the difference encoding
+TEST(readInBinary, full_width_LBAs)
+{
+    string binaryName = "binaryWideTest.bin";
+    vector<size_t> LBAs;
+    LBAs.push_back(~size_t(0));
+    LBAs.push_back(0);
+    LBAs.push_back(size_t(1) << 63);
+    LBAs.push_back(12345);
+
+    BinaryTraceWriter writer(binaryName);
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        writer.append(LBAs[i]);
+    }
+    writer.close();
+
+    BinaryTrace binary;
+    binary.open(binaryName);
+    vector<size_t> decoded;
+    bool complete = binary.for_each_LBA([&decoded](size_t LBA) {
+        decoded.push_back(LBA);
+    });
+    remove(binaryName.c_str());
+
+    assert(complete);
+    assert(decoded == LBAs);
+}
+
+/// Test that an entry longer than a 64 bit varint, or one whose last byte
+/// holds more than the top bit, stops decoding and is reported as corrupt
+TEST(readInBinary, corrupt_varint)
+{
+    string binaryName = "binaryCorruptTest.bin";
+
+    BinaryTraceWriter writer(binaryName);
+    writer.append(1);
+    writer.append(2);
+    writer.close();
+
+    ifstream in(binaryName, ios::binary);
+    string header(sizeof(BinaryTrace::Header), '\0');
+    in.read(&header[0], header.size());
+    in.close();
+
+    // The first entry is LBA 1, the second runs on past 10 bytes
+    string too_long = header + '\x02' + string(11, '\x80') + '\x01';
+    // The second entry is 10 bytes, but the last byte overflows 64 bits
+    string too_large = header + '\x02' + string(9, '\x80') + '\x02';
+
+    string files[] = {too_long, too_large};
+    for (size_t i = 0; i < 2; ++i) {
+        ofstream out(binaryName, ios::binary | ios::trunc);
+        out.write(files[i].data(), files[i].size());
+        out.close();
+
+        BinaryTrace binary;
+        bool opened = binary.open(binaryName);
+        assert(opened);
+        vector<size_t> decoded;
+        bool complete = binary.for_each_LBA([&decoded](size_t LBA) {
+            decoded.push_back(LBA);
+        });
+        assert(!complete);
+        assert(decoded.size() == 1 && decoded[0] == 1);
+
+        TraceSet trace;
+        size_t bytes = trace.readInBinary(binaryName);
+        assert(bytes == 0);
+    }
+
+    remove(binaryName.c_str());
+}
+
+/// Test that LayoutMap puts LBAs where change_locations puts them
+TEST(LayoutMap, matches_change_locations)
+{
+    vector<size_t> hot;
+    for (size_t i = 0; i < 40; ++i) {
+        hot.push_back((i * 37) % 300);
+    }
+
+    for (size_t start = 0; start < 300; start += 75) {
+
+        TraceSet trace;
+        for (size_t i = 0; i < 300; ++i) {
+            trace.insert(i);
+        }
+        trace.change_locations(hot, start);
+
+        LayoutMap layout(hot, start);
+        vector<TraceSet::blockLBA>& mapLBA = trace.get_mapLBA();
+        for (size_t LBA = 0; LBA < 300; ++LBA) {
+            assert(layout.location(LBA) == mapLBA[LBA].location);
+        }
+    }
+
+    // With nothing moved every LBA stays at its own location
+    LayoutMap identity;
+    assert(identity.location(0) == 0);
+    assert(identity.location(123456789) == 123456789);
+}
+
+/// Test that streaming a trace through a LayoutMap gives the same total seek
+/// distance as loading it and calling change_locations
+TEST(LayoutMap, stream_seek_distance)
+{
+    string textName = "streamTextTest";
+    string binaryName = "streamTest.bin";
+
+    ofstream out(textName);
+    BinaryTraceWriter writer(binaryName);
+    stringstream stream;
+    for (size_t i = 0; i < 3000; ++i) {
+        size_t LBA = (i * i + 7 * i) % 911;
+        out << LBA << "\n";
+        stream << LBA << "\n";
+        writer.append(LBA);
+    }
+    out.close();
+    writer.close();
+
+    TraceSet trace;
+    trace.readInMapped(textName);
+    size_t initial = trace.total_seek_distance();
+
+    // The hot LBAs have to occur in the trace, so they are taken from it
+    vector<size_t> hot;
+    vector<TraceSet::blockLBA>& mapLBA = trace.get_mapLBA();
+    for (size_t LBA = 0; LBA < 911 && hot.size() < 50; LBA += 7) {
+        if (mapLBA[LBA].used) {
+            hot.push_back(LBA);
+        }
+    }
+    reverse(hot.begin(), hot.end());
+    trace.change_locations(hot, 0);
+    size_t final = trace.total_seek_distance();
+
+    LayoutMap identity;
+    LayoutMap layout(hot, 0);
+    assert(identity.stream_seek_distance(textName) == initial);
+    assert(layout.stream_seek_distance(textName) == final);
+    assert(layout.stream_seek_distance(binaryName) == final);
+    assert(layout.stream_seek_distance(stream) == final);
+
+    remove(textName.c_str());
+    remove(binaryName.c_str());
+}
+
+/// Test that a dictionary encoded trace sizes its tables by the number of
+/// distinct LBAs and handles LBAs that do not fit in an int
+TEST(dictionary, large_LBAs)
+{
+    TraceSet test(true);
+    assert(test.is_dictionary_encoded());
+    assert(test.get_mapLBA().empty());
+
+    size_t base = size_t(1) << 60;
+    for (size_t i = 0; i < 100; ++i) {
+        test.insert(to_string(base + (i % 10) * 1000));
+    }
+
+    vector<TraceSet::Line>& test_sequence = test.get_Sequence();
+    vector<TraceSet::blockLBA>& test_mapLBA = test.get_mapLBA();
+    assert(test_sequence.size() == 100);
+    assert(test_mapLBA.size() == 10);
+    assert(test.get_locations().empty());
+
+    // IDs are given in the order LBAs are first seen
+    for (size_t i = 0; i < 10; ++i) {
+        assert(test.get_ID(base + i * 1000) == i);
+        assert(test.get_LBA(i) == base + i * 1000);
+        assert(test_mapLBA[i].location == base + i * 1000);
+        assert(test_mapLBA[i].first == i);
+        assert(test_mapLBA[i].last == 90 + i);
+    }
+    assert(test.get_ID(5) == 10);
+    assert(test.get_indices(5).empty());
+
+    vector<size_t> indices = test.get_indices(base + 3000);
+    assert(indices.size() == 10);
+    for (size_t i = 0; i < 10; ++i) {
+        assert(indices[i] == 3 + 10 * i);
+    }
+
+    // 10 passes of 9 steps of 1000 and 9 jumps back of 9000
+    assert(test.total_seek_distance() == 10 * 9000 + 9 * 9000);
+}
+
+/// Test that change_locations gives the same locations and total seek
+/// distance in a dictionary encoded trace as in one that is not
+TEST(dictionary, change_locations)
+{
+    TraceSet dense;
+    TraceSet test(true);
+    for (size_t i = 0; i < 2000; ++i) {
+        size_t LBA = (i * 7907) % 1009 + (i % 3) * 2000;
+        dense.insert(LBA);
+        test.insert(LBA);
+    }
+    assert(test.total_seek_distance() == dense.total_seek_distance());
+
+    vector<size_t> hot;
+    for (size_t i = 0; i < 2000 && hot.size() < 60; i += 31) {
+        size_t LBA = (i * 7907) % 1009 + (i % 3) * 2000;
+        if (find(hot.begin(), hot.end(), LBA) == hot.end()) {
+            hot.push_back(LBA);
+        }
+    }
+
+    dense.change_locations(hot, 500);
+    test.change_locations(hot, 500);
+
+    vector<TraceSet::blockLBA>& dense_mapLBA = dense.get_mapLBA();
+    vector<TraceSet::blockLBA>& test_mapLBA = test.get_mapLBA();
+    for (size_t ID = 0; ID < test_mapLBA.size(); ++ID) {
+        assert(test_mapLBA[ID].location ==
+               dense_mapLBA[test.get_LBA(ID)].location);
+    }
+    assert(test.total_seek_distance() == dense.total_seek_distance());
+}
+
+TEST(total_seek_distance, follows_changes)
+{
+  TraceSet trace;
+  trace.insert("5");
+  trace.insert("2");
+  trace.insert("9");
+  trace.insert("2");
+
+  bool fresh = trace.total_seek_distance() == 3 + 7 + 7;
+  assert(fresh);
+
+  // Accesses inserted after a scan are scanned too
+  trace.insert("1");
+  bool extended = trace.total_seek_distance() == 3 + 7 + 7 + 1;
+  assert(extended);
+
+  // Locations changed by seek_delta_move are picked up
+  trace.seek_delta_move(9, 3, true);
+  bool relocated = trace.total_seek_distance() == 3 + 1 + 1 + 1;
+  assert(relocated);
+
+  trace.seek_delta_move(9, 9, true);
+  bool kept = trace.total_seek_distance() == 3 + 7 + 7 + 1 &&
+              trace.seek_time(LinearSeek()) == 3 + 7 + 7 + 1;
+  assert(kept);
+
+  // Locations changed through the references once fix_locations is called
+  vector<TraceSet::LBA_location>& locations = trace.get_locations();
+  locations[9].LBA = 1;
+  locations[1].LBA = 9;
+  trace.fix_locations();
+  bool fixed = trace.total_seek_distance() == 3 + 1 + 1 + 7 &&
+               trace.get_mapLBA()[9].location == 1;
+  assert(fixed);
+  trace.seek_delta_swap(9, 1, true);
+  trace.seek_delta_move(9, 3, true);
+
+  // As are locations moved by change_locations
+  vector<size_t> hot = {2, 9};
+  trace.change_locations(hot, 0);
+  TraceSet expected;
+  expected.insert("5");
+  expected.insert("2");
+  expected.insert("9");
+  expected.insert("2");
+  expected.insert("1");
+  expected.seek_delta_move(9, 3, true);
+  expected.change_locations(hot, 0);
+  vector<TraceSet::blockLBA>& expected_mapLBA = expected.get_mapLBA();
+  size_t recomputed = 0;
+  vector<TraceSet::Line>& sequence = expected.get_Sequence();
+  for (size_t i = 1; i < sequence.size(); ++i) {
+    size_t previous = expected_mapLBA[sequence[i - 1].LBA].location;
+    size_t current = expected_mapLBA[sequence[i].LBA].location;
+    recomputed += previous < current ? current - previous
+                                     : previous - current;
+  }
+  bool moved = trace.total_seek_distance() == recomputed &&
+               expected.total_seek_distance() == recomputed;
+  assert(moved);
+}
+
+TEST(SeekKernel, versions_agree)
+{
+  // Locations near the top of the range make the sums wrap around, every
+  // version must wrap the same way.
+  vector<size_t> locations = {0, 7, 3, ~size_t(0), ~size_t(0) - 5,
+                              size_t(1) << 63, 42, 1};
+  vector<size_t> keys = random_accesses(203, 12345, locations.size());
+
+  for (size_t n = 0; n <= keys.size(); ++n) {
+    size_t expected = SeekKernel::distance_scalar(keys.data(), n,
+                                                  locations.data());
+    bool dispatched = SeekKernel::distance(keys.data(), n,
+                                           locations.data()) == expected;
+    assert(dispatched);
+
+    if (SeekKernel::has_avx2()) {
+      bool avx2 = SeekKernel::distance_avx2(keys.data(), n,
+                                            locations.data()) == expected;
+      assert(avx2);
+    }
+
+    if (SeekKernel::has_avx512()) {
+      bool avx512 = SeekKernel::distance_avx512(keys.data(), n,
+                                                locations.data()) == expected;
+      assert(avx512);
+    }
+  }
+}
+
+TEST(SeekKernel, strided_keys_agree)
+{
+  vector<size_t> locations = {0, 7, 3, ~size_t(0), ~size_t(0) - 5,
+                              size_t(1) << 63, 42, 1};
+  vector<size_t> keys = random_accesses(131, 777, locations.size());
+
+  for (size_t stride = 1; stride <= 3; ++stride) {
+    for (size_t n = 1; n <= keys.size(); ++n) {
+      // The elements between the keys are not keys, and nothing past the
+      // last key is allocated.
+      vector<size_t> strided((n - 1) * stride + 1, ~size_t(0));
+      for (size_t i = 0; i < n; ++i) {
+        strided[i * stride] = keys[i];
+      }
+
+      size_t expected = SeekKernel::distance_scalar(keys.data(), n,
+                                                    locations.data());
+      bool scalar = SeekKernel::distance_scalar(strided.data(), stride, n,
+                                                locations.data()) == expected;
+      assert(scalar);
+
+      SeekHistogram histogram;
+      bool counted = SeekKernel::distance(strided.data(), stride, n,
+                                          locations.data(), &histogram) ==
+                         expected &&
+                     histogram.count() == n - 1;
+      assert(counted);
+
+      if (SeekKernel::has_avx2()) {
+        bool avx2 = SeekKernel::distance_avx2(strided.data(), stride, n,
+                                              locations.data()) == expected;
+        assert(avx2);
+      }
+
+      if (SeekKernel::has_avx512()) {
+        bool avx512 = SeekKernel::distance_avx512(strided.data(), stride, n,
+                                                  locations.data()) ==
+                      expected;
+        assert(avx512);
+      }
+    }
+  }
+}
+
+TEST(total_seek_distance, threads_match_serial)
+{
+  TraceSet trace;
+  vector<size_t> accesses = random_accesses(1001, 2015, 300);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+
+  size_t expected = trace.total_seek_distance();
+  for (unsigned threads = 0; threads <= 7; ++threads) {
+    bool same = trace.total_seek_distance(threads) == expected;
+    assert(same);
+  }
+
+  // More threads than pairs of accesses
+  TraceSet small;
+  small.insert("4");
+  small.insert("1");
+  small.insert("6");
+  bool tiny = small.total_seek_distance(8) == 3 + 5;
+  assert(tiny);
+}
+
+TEST(transitions, counts_pairs)
+{
+  TraceSet trace;
+  trace.insert("3");
+  trace.insert("1");
+  trace.insert("1");
+  trace.insert("3");
+  trace.insert("2");
+  trace.insert("1");
+  trace.insert("3");
+
+  // (1,3) three times, (2,3) once, (1,2) once, (1,1) is left out
+  const vector<TraceSet::Transition>& transitions = trace.get_transitions();
+  bool three = transitions.size() == 3;
+  assert(three);
+  bool first = transitions[0].low == 1 && transitions[0].high == 2 &&
+               transitions[0].count == 1;
+  assert(first);
+  bool second = transitions[1].low == 1 && transitions[1].high == 3 &&
+                transitions[1].count == 3;
+  assert(second);
+  bool third = transitions[2].low == 2 && transitions[2].high == 3 &&
+               transitions[2].count == 1;
+  assert(third);
+
+  // Accesses added later are counted too
+  trace.insert("2");
+  bool rebuilt = trace.get_transitions().size() == 3 &&
+                 trace.get_transitions()[2].count == 2;
+  assert(rebuilt);
+}
+
+TEST(transitions, matches_total_seek_distance)
+{
+  TraceSet trace;
+  TraceSet dictionary(true);
+  vector<size_t> accesses = random_accesses(2000, 99, 50);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+    dictionary.insert(accesses[i]);
+  }
+
+  bool initial = trace.transition_seek_distance() ==
+                 trace.total_seek_distance();
+  assert(initial);
+
+  vector<size_t> hot = {17, 3, 44, 8};
+  LayoutMap layout(hot, 5);
+  bool from_layout = trace.transition_seek_distance(layout) ==
+                     dictionary.transition_seek_distance(layout);
+  assert(from_layout);
+
+  trace.change_locations(hot, 5);
+  bool moved = trace.transition_seek_distance() ==
+               trace.total_seek_distance();
+  assert(moved);
+  bool same_as_layout = trace.transition_seek_distance(layout) ==
+                        trace.total_seek_distance();
+  assert(same_as_layout);
+}
+
+TEST(seek_delta, move_and_swap)
+{
+  TraceSet trace;
+  TraceSet dictionary(true);
+  vector<size_t> accesses = random_accesses(500, 7, 40);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+    dictionary.insert(accesses[i]);
+  }
+
+  size_t state = 8;
+  for (size_t step = 0; step < 40; ++step) {
+    next_random(state);
+    size_t first = (state >> 33) % 40;
+    size_t second = (state >> 13) % 40;
+
+    size_t before = trace.total_seek_distance();
+
+    // A delta that is not committed leaves the trace alone
+    long long swap = trace.seek_delta_swap(first, second, false);
+    bool unchanged = trace.total_seek_distance() == before;
+    assert(unchanged);
+
+    long long committed = trace.seek_delta_swap(first, second, true);
+    bool swapped = committed == swap &&
+                   static_cast<long long>(trace.total_seek_distance()) -
+                   static_cast<long long>(before) == swap;
+    assert(swapped);
+
+    // Free locations start at 80, since mapLBA_ is twice the largest LBA
+    before = trace.total_seek_distance();
+    long long move = trace.seek_delta_move(first, 80 + step, true);
+    bool moved = static_cast<long long>(trace.total_seek_distance()) -
+                 static_cast<long long>(before) == move;
+    assert(moved);
+
+    bool located = trace.get_locations()[80 + step].LBA == first &&
+                   trace.get_locations()[80 + step].used;
+    assert(located);
+
+    // The same steps on a dictionary encoded trace
+    size_t dictionary_before = dictionary.total_seek_distance();
+    long long dictionary_delta =
+        dictionary.seek_delta_swap(first, second, true) +
+        dictionary.seek_delta_move(first, 80 + step, true);
+    bool same = dictionary_delta == swap + move &&
+                static_cast<long long>(dictionary.total_seek_distance()) -
+                static_cast<long long>(dictionary_before) == dictionary_delta;
+    assert(same);
+  }
+
+  // An LBA that is not in the trace does not change the distance
+  bool missing = trace.seek_delta_move(1000, 3, false) == 0 &&
+                 dictionary.seek_delta_swap(1000, 3, false) == 0;
+  assert(missing);
+}
+
+/*
+ * function: reference_change_locations(TraceSet& trace,
+ *                                       vector<size_t> LBA_vector,
+ *                                       size_t start)
+ *
+ * The steps change_locations took before it used a LocationTree, used to
+ * check that the tree gives the same result.
+ */
+static void reference_change_locations(TraceSet& trace,
+                                       vector<size_t> LBA_vector,
+                                       size_t start)
+{
+  trace.remove_LBA_locations(LBA_vector);
+
+  vector<TraceSet::LBA_location> LBAs;
+  for (size_t i = 0; i < LBA_vector.size(); ++i) {
+    TraceSet::LBA_location LBA_to_add;
+    LBA_to_add.LBA = LBA_vector[i];
+    LBA_to_add.used = true;
+    LBAs.push_back(LBA_to_add);
+  }
+
+  vector<TraceSet::LBA_location>& locations = trace.get_locations();
+  locations.insert(locations.begin() + start, LBAs.begin(), LBAs.end());
+
+  trace.fix_locations();
+}
+
+TEST(LocationTree, matches_reference_change_locations)
+{
+  TraceSet trace;
+  TraceSet reference;
+  vector<size_t> accesses = random_accesses(300, 31, 120);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+    reference.insert(accesses[i]);
+  }
+
+  LocationTree tree(trace.get_locations(), trace.get_mapLBA());
+
+  size_t state = 32;
+  for (size_t round = 0; round < 25; ++round) {
+
+    // Distinct LBAs of the trace in a random order
+    vector<size_t> LBA_vector;
+    size_t count = 1 + round % 9;
+    while (LBA_vector.size() < count) {
+      size_t LBA = (next_random(state) >> 33) % 120;
+      if (reference.get_mapLBA()[LBA].used &&
+          find(LBA_vector.begin(), LBA_vector.end(), LBA) ==
+          LBA_vector.end()) {
+        LBA_vector.push_back(LBA);
+      }
+    }
+    size_t start = (state >> 20) % (tree.size() - count + 1);
+
+    tree.move_to(LBA_vector, start);
+    reference_change_locations(reference, LBA_vector, start);
+
+    // The tree answers without being applied
+    vector<TraceSet::LBA_location>& expected = reference.get_locations();
+    bool sized = tree.size() == expected.size();
+    assert(sized);
+    for (size_t location = 0; location < expected.size(); ++location) {
+      if (expected[location].used) {
+        bool found = tree.location(expected[location].LBA) == location;
+        assert(found);
+      }
+    }
+
+    // Every few rounds the tree is written back, and starts over. It writes
+    // through the references, so the trace is told with fix_locations.
+    if (round % 4 == 3) {
+      tree.apply();
+      trace.fix_locations();
+      vector<TraceSet::LBA_location>& applied = trace.get_locations();
+      for (size_t location = 0; location < expected.size(); ++location) {
+        bool same = applied[location].used == expected[location].used &&
+                    (!expected[location].used ||
+                     applied[location].LBA == expected[location].LBA);
+        assert(same);
+      }
+      bool distance = trace.total_seek_distance() ==
+                      reference.total_seek_distance();
+      assert(distance);
+    }
+  }
+}
+
+TEST(LocationTree, apply_writes_only_moved_range)
+{
+  TraceSet trace;
+  TraceSet reference;
+  for (size_t LBA = 1; LBA <= 50; ++LBA) {
+    trace.insert(LBA);
+    reference.insert(LBA);
+  }
+
+  // Slots outside the moved range are not written, a location set through
+  // the reference there is kept
+  trace.get_mapLBA()[45].location = 7;
+  vector<size_t> hot = {20, 12};
+  trace.change_locations(hot, 10);
+  reference_change_locations(reference, hot, 10);
+  bool untouched = trace.get_mapLBA()[45].location == 7;
+  assert(untouched);
+  trace.get_mapLBA()[45].location = 45;
+  for (size_t LBA = 1; LBA <= 50; ++LBA) {
+    bool same = trace.get_mapLBA()[LBA].location ==
+                reference.get_mapLBA()[LBA].location;
+    assert(same);
+  }
+
+  // Moving more LBAs with no slot than there are slots grows the vector
+  TraceSet small;
+  small.insert("1");
+  vector<size_t> missing = {7, 8, 9, 10, 11};
+  small.change_locations(missing, 0);
+  vector<TraceSet::LBA_location>& grown = small.get_locations();
+  bool sized = grown.size() == missing.size();
+  assert(sized);
+  for (size_t location = 0; location < missing.size(); ++location) {
+    bool placed = grown[location].used &&
+                  grown[location].LBA == missing[location];
+    assert(placed);
+  }
+}
+
+TEST(change_locations, matches_reference)
+{
+  TraceSet trace;
+  TraceSet reference;
+  vector<size_t> accesses = random_accesses(400, 5, 200);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+    reference.insert(accesses[i]);
+  }
+
+  vector<size_t> hot = {150, 7, 99, 3, 42};
+  trace.change_locations(hot, 11);
+  reference_change_locations(reference, hot, 11);
+  trace.change_locations(hot, 0);
+  reference_change_locations(reference, hot, 0);
+
+  for (size_t LBA = 0; LBA < 200; ++LBA) {
+    if (trace.get_mapLBA()[LBA].used) {
+      bool same = trace.get_mapLBA()[LBA].location ==
+                  reference.get_mapLBA()[LBA].location;
+      assert(same);
+    }
+  }
+}
+
+TEST(sweep_seek_distance, matches_change_locations)
+{
+  for (int dictionary = 0; dictionary < 2; ++dictionary) {
+
+    TraceSet trace(dictionary == 1);
+    vector<size_t> accesses = random_accesses(600, 11, 90);
+    for (size_t i = 0; i < accesses.size(); ++i) {
+      accesses[i] *= 3;
+      trace.insert(accesses[i]);
+    }
+
+    // Start from a layout that has already been changed once
+    vector<size_t> first_move = {30, 60, 90};
+    trace.change_locations(first_move, 4);
+
+    vector<size_t> ranked;
+    for (size_t i = 0; i < accesses.size(); ++i) {
+      if (find(ranked.begin(), ranked.end(), accesses[i]) == ranked.end()) {
+        ranked.push_back(accesses[i]);
+      }
+    }
+    vector<size_t> prefixes = {0, ranked.size(), 1, 7, ranked.size() / 2};
+
+    vector<size_t> distances = trace.sweep_seek_distance(ranked, prefixes, 10);
+    bool sized = distances.size() == prefixes.size();
+    assert(sized);
+
+    for (size_t p = 0; p < prefixes.size(); ++p) {
+      TraceSet expected(dictionary == 1);
+      for (size_t i = 0; i < accesses.size(); ++i) {
+        expected.insert(accesses[i]);
+      }
+      expected.change_locations(first_move, 4);
+      expected.change_locations(vector<size_t>(ranked.begin(),
+                                               ranked.begin() + prefixes[p]),
+                                10);
+      bool same = distances[p] == expected.total_seek_distance();
+      assert(same);
+    }
+
+    // The sweep does not move anything
+    bool unchanged = trace.get_mapLBA()[trace.get_ID(30)].location == 4;
+    assert(unchanged);
+  }
+}
+
+TEST(FrequencyRank, counts_and_ranks)
+{
+  vector<size_t> accesses;
+  map<size_t, size_t> expected;
+  size_t state = 3;
+  for (size_t i = 0; i < 5000; ++i) {
+    next_random(state);
+    size_t LBA = ((state >> 33) % 300) * ((state >> 20) % 3 == 0 ? 1 : 1000);
+    accesses.push_back(LBA);
+    ++expected[LBA];
+  }
+
+  for (unsigned threads = 1; threads <= 4; ++threads) {
+    vector<FrequencyRank::Count> counts =
+        FrequencyRank::count(accesses, threads);
+
+    bool sized = counts.size() == expected.size();
+    assert(sized);
+    size_t i = 0;
+    for (map<size_t, size_t>::iterator it = expected.begin();
+         it != expected.end(); ++it, ++i) {
+      bool same = counts[i].LBA == it->first && counts[i].count == it->second;
+      assert(same);
+    }
+  }
+
+  vector<FrequencyRank::Count> all = FrequencyRank::count(accesses, 2);
+  vector<FrequencyRank::Count> top = all;
+  FrequencyRank::rank(all, 0);
+  FrequencyRank::rank(top, 10);
+
+  bool kept = top.size() == 10;
+  assert(kept);
+  for (size_t i = 0; i + 1 < all.size(); ++i) {
+    bool ordered = all[i].count > all[i + 1].count ||
+                   (all[i].count == all[i + 1].count &&
+                    all[i].LBA < all[i + 1].LBA);
+    assert(ordered);
+  }
+  for (size_t i = 0; i < top.size(); ++i) {
+    bool same = top[i].LBA == all[i].LBA && top[i].count == all[i].count;
+    assert(same);
+  }
+}
+
+TEST(rank_LBAs, ties_by_LBA)
+{
+  TraceSet trace;
+  TraceSet dictionary(true);
+  vector<size_t> accesses = {9, 4, 9, 7, 4, 2, 9, 7};
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+    dictionary.insert(accesses[i]);
+  }
+
+  // 9 three times, 4 and 7 twice, 2 once
+  vector<size_t> expected = {9, 4, 7, 2};
+  bool dense = trace.rank_LBAs(0, 2) == expected;
+  assert(dense);
+  bool encoded = dictionary.rank_LBAs(0, 1) == expected;
+  assert(encoded);
+
+  vector<size_t> top = {9, 4};
+  bool only_top = trace.rank_LBAs(2, 0) == top;
+  assert(only_top);
+}
+
+TEST(PlacementStrategy, strategies)
+{
+  TraceSet trace(true);
+  vector<size_t> accesses = {50, 20, 50, 30, 20, 50, 40, 30, 50, 20, 10};
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+
+  // 50 four times, 20 three times, 30 twice, then 10 and 40 once
+  PlacementStats stats = PlacementStrategy::collect(trace, 4, 1);
+  bool ranked = stats.ranked.size() == 4 && stats.ranked[0].LBA == 50 &&
+                stats.ranked[3].LBA == 10;
+  assert(ranked);
+
+  // The transitions hold LBAs, not IDs
+  bool has_pair = false;
+  for (size_t i = 0; i < stats.transitions.size(); ++i) {
+    if (stats.transitions[i].low == 20 && stats.transitions[i].high == 50) {
+      has_pair = stats.transitions[i].count == 4;
+    }
+  }
+  assert(has_pair);
+
+  FrequencyPlacement frequency;
+  vector<size_t> expected_frequency = {50, 20, 30, 10};
+  bool by_frequency = frequency.place(stats) == expected_frequency;
+  assert(by_frequency);
+
+  // Even ranks reversed, then odd ranks, as organ-pipe.py printed them
+  OrganPipePlacement organ_pipe;
+  vector<size_t> expected_organ_pipe = {30, 50, 20, 10};
+  bool by_organ_pipe = organ_pipe.place(stats) == expected_organ_pipe;
+  assert(by_organ_pipe);
+
+  vector<size_t> leaves = {10, 30, 50};
+  ClusterPlacement cluster(leaves);
+  bool by_cluster = cluster.place(stats) == leaves;
+  assert(by_cluster);
+
+  vector<const PlacementStrategy*> strategies = {&frequency, &organ_pipe,
+                                                 &cluster};
+  bool named = strategies[0]->name() == "frequency" &&
+               strategies[1]->name() == "organ-pipe" &&
+               strategies[2]->name() == "cluster";
+  assert(named);
+}
+
+TEST(LayoutOptimizer, improves_and_matches_change_locations)
+{
+  vector<size_t> accesses;
+  size_t state = 47;
+  for (size_t i = 0; i < 2000; ++i) {
+    next_random(state);
+    // A few hot LBAs that follow each other, and some other LBAs
+    if ((state >> 40) % 4 != 0) {
+      accesses.push_back(200 + (state >> 33) % 30);
+    } else {
+      accesses.push_back((state >> 33) % 400);
+    }
+  }
+
+  TraceSet trace;
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+  vector<size_t> LBA_vector = trace.rank_LBAs(40, 1);
+
+  LayoutOptimizer optimizer(trace, LBA_vector, 0);
+
+  TraceSet initial;
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    initial.insert(accesses[i]);
+  }
+  initial.change_locations(LBA_vector, 0);
+  bool initial_matches =
+    optimizer.initial_seek_distance() == initial.total_seek_distance();
+  assert(initial_matches);
+
+  LayoutOptimizer::Options options;
+  options.iterations = 20000;
+  options.num_threads = 2;
+  options.exchange_interval = 2000;
+  vector<size_t> best = optimizer.optimize(options);
+
+  bool improved =
+    optimizer.best_seek_distance() < optimizer.initial_seek_distance();
+  assert(improved);
+
+  // The best layout is an order of the same LBAs
+  vector<size_t> sorted_best = best;
+  vector<size_t> sorted_LBAs = LBA_vector;
+  sort(sorted_best.begin(), sorted_best.end());
+  sort(sorted_LBAs.begin(), sorted_LBAs.end());
+  bool same_LBAs = sorted_best == sorted_LBAs;
+  assert(same_LBAs);
+
+  // The distance tracked by the deltas is the real one
+  TraceSet moved;
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    moved.insert(accesses[i]);
+  }
+  moved.change_locations(best, 0);
+  bool best_matches =
+    optimizer.best_seek_distance() == moved.total_seek_distance();
+  assert(best_matches);
+  bool recomputed = optimizer.seek_distance(best) == moved.total_seek_distance();
+  assert(recomputed);
+
+  // The same seed and step limit give the same layout
+  LayoutOptimizer again(trace, LBA_vector, 0);
+  bool repeatable = again.optimize(options) == best;
+  assert(repeatable);
+}
+
+TEST(SeekCost, models)
+{
+  // The square root part up to the knee, then linear
+  SqrtLinearSeek curve(2.0, 0.5, 0.01, 100);
+  bool zero = curve(0) == 0;
+  assert(zero);
+  bool short_seek = fabs(curve(16) - 4.0) < 1e-9;
+  assert(short_seek);
+  bool at_knee = fabs(curve(100) - 7.0) < 1e-9;
+  assert(at_knee);
+  bool long_seek = fabs(curve(300) - 9.0) < 1e-9;
+  assert(long_seek);
+
+  // Points out of order and a repeated distance
+  istringstream profile("# distance time\n100 5\n\n10 2\n1000 14\n10 9\n");
+  TableSeek table;
+  bool read = table.read(profile);
+  assert(read);
+  bool three_points = table.points().size() == 3 &&
+                      table.points()[0].distance == 10 &&
+                      table.points()[0].time == 2;
+  assert(three_points);
+  bool below_first = table(0) == 0 && table(3) == 2;
+  assert(below_first);
+  bool between = fabs(table(55) - 3.5) < 1e-9;
+  assert(between);
+  bool beyond_last = fabs(table(1100) - 15.0) < 1e-9;
+  assert(beyond_last);
+
+  istringstream bad("10 2\nten 3\n");
+  TableSeek unread;
+  bool rejected = !unread.read(bad) && unread.points().empty();
+  assert(rejected);
+}
+
+TEST(SeekCost, seek_time_matches_distance_and_transitions)
+{
+  TraceSet trace;
+  vector<size_t> accesses = random_accesses(1500, 53, 5000);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+  trace.change_locations(trace.rank_LBAs(50, 1), 0);
+
+  // The linear model adds up the distances
+  bool linear = trace.seek_time(LinearSeek()) ==
+                static_cast<double>(trace.total_seek_distance());
+  assert(linear);
+
+  SqrtLinearSeek curve(1.0, 0.05, 0.0005, 400);
+  double scanned = trace.seek_time(curve);
+  double from_table = trace.transition_seek_time(curve);
+  bool curve_agrees = fabs(scanned - from_table) <= 1e-9 * scanned;
+  assert(curve_agrees);
+
+  vector<TableSeek::Point> points = {{1, 0.5}, {64, 2.0}, {4096, 8.0}};
+  TableSeek table(points);
+  scanned = trace.seek_time(table);
+  from_table = trace.transition_seek_time(table);
+  bool table_agrees = fabs(scanned - from_table) <= 1e-9 * scanned;
+  assert(table_agrees);
+}
+
+TEST(service_time, request_lengths)
+{
+  string fileName = "requestsTest";
+  ofstream out(fileName);
+  out << "100 8\n108,4\n50\n\n50 0\n";
+  out.close();
+
+  TraceSet trace;
+  trace.readInRequests(fileName);
+  remove(fileName.c_str());
+
+  bool read = trace.get_Sequence().size() == 4 && trace.has_request_lengths();
+  assert(read);
+  bool lengths = trace.get_request_length(0) == 8 &&
+                 trace.get_request_length(1) == 4 &&
+                 trace.get_request_length(2) == 1 &&
+                 trace.get_request_length(3) == 1;
+  assert(lengths);
+
+  // 108 starts where 100 ends, so it needs no seek and no rotation, the two
+  // seeks are from 112 to 50 and from 51 back to 50.
+  DiskTiming timing;
+  timing.rotational_latency = 4;
+  timing.transfer_per_block = 0.5;
+  ServiceEstimate estimate = trace.service_time(LinearSeek(), timing);
+  bool distance = estimate.seek_distance == 66 &&
+                  estimate.seek_distance == trace.total_seek_distance();
+  assert(distance);
+  bool parts = estimate.seek_time == 63 && estimate.rotation_time == 12 &&
+               estimate.transfer_time == 7 && estimate.total_time() == 82;
+  assert(parts);
+}
+
+TEST(service_time, without_lengths)
+{
+  TraceSet trace;
+  vector<size_t> accesses = random_accesses(500, 59, 300);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+  bool no_lengths = !trace.has_request_lengths() &&
+                    trace.get_request_length(7) == 1;
+  assert(no_lengths);
+
+  DiskTiming timing;
+  timing.rotational_latency = 0;
+  timing.transfer_per_block = 1;
+  ServiceEstimate estimate = trace.service_time(LinearSeek(), timing);
+  bool distance = estimate.seek_distance == trace.total_seek_distance();
+  assert(distance);
+  bool transfer = estimate.transfer_time == 500;
+  assert(transfer);
+
+  // One long request later gives the earlier ones a length of 1
+  trace.insert(10, 16);
+  bool padded = trace.has_request_lengths() &&
+                trace.get_request_length(0) == 1 &&
+                trace.get_request_length(500) == 16;
+  assert(padded);
+  trace.insert(26);
+  bool after = trace.get_request_length(501) == 1;
+  assert(after);
+  estimate = trace.service_time(LinearSeek(), timing);
+  bool more_transfer = estimate.transfer_time == 517;
+  assert(more_transfer);
+}
+
+TEST(window_seek_distance, by_accesses)
+{
+  TraceSet trace;
+  vector<size_t> accesses = random_accesses(1003, 61, 700);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+  trace.change_locations(trace.rank_LBAs(30, 1), 0);
+
+  vector<TraceSet::Window> windows = trace.window_seek_distance(100, 1);
+  bool eleven = windows.size() == 11 && windows.back().num_accesses == 3;
+  assert(eleven);
+
+  // Each window against a scan of its own accesses
+  vector<TraceSet::Line>& sequence = trace.get_Sequence();
+  vector<TraceSet::blockLBA>& mapLBA = trace.get_mapLBA();
+  size_t sum = 0;
+  for (size_t w = 0; w < windows.size(); ++w) {
+    size_t expected = 0;
+    size_t first = windows[w].first_access;
+    for (size_t i = max<size_t>(first, 1); i < first + windows[w].num_accesses;
+         ++i) {
+      size_t previous = mapLBA[sequence[i - 1].LBA].location;
+      size_t current = mapLBA[sequence[i].LBA].location;
+      expected += previous < current ? current - previous : previous - current;
+    }
+    size_t num_seeks = w == 0 ? windows[w].num_accesses - 1
+                              : windows[w].num_accesses;
+    bool matches = windows[w].total_seek == expected &&
+                   windows[w].mean_seek ==
+                     static_cast<double>(expected) / num_seeks;
+    assert(matches);
+    sum += windows[w].total_seek;
+  }
+  bool adds_up = sum == trace.total_seek_distance();
+  assert(adds_up);
+
+  // The same windows on several threads
+  vector<TraceSet::Window> threaded = trace.window_seek_distance(100, 3);
+  bool same = threaded.size() == windows.size();
+  for (size_t w = 0; same && w < windows.size(); ++w) {
+    same = threaded[w].total_seek == windows[w].total_seek &&
+           threaded[w].first_access == windows[w].first_access;
+  }
+  assert(same);
+}
+
+TEST(window_seek_distance, by_time)
+{
+  TraceSet trace;
+  vector<size_t> LBAs = {10, 20, 10, 50, 40, 45, 10};
+  vector<size_t> times = {100, 105, 119, 150, 151, 160, 161};
+  for (size_t i = 0; i < LBAs.size(); ++i) {
+    trace.insert(LBAs[i]);
+  }
+
+  bool none = !trace.has_timestamps() &&
+              trace.window_seek_distance_by_time(20, 1).empty();
+  assert(none);
+  trace.set_timestamps(times);
+  bool timed = trace.has_timestamps();
+  assert(timed);
+
+  // Windows start at 100, 120, 140 and 160, the one at 120 is empty
+  vector<TraceSet::Window> windows = trace.window_seek_distance_by_time(20, 2);
+  bool four = windows.size() == 4;
+  assert(four);
+  bool starts = windows[0].start_time == 100 && windows[1].start_time == 120 &&
+                windows[2].start_time == 140 && windows[3].start_time == 160;
+  assert(starts);
+  bool counts = windows[0].num_accesses == 3 && windows[1].num_accesses == 0 &&
+                windows[2].num_accesses == 2 && windows[3].num_accesses == 2;
+  assert(counts);
+  bool seeks = windows[0].total_seek == 20 && windows[0].mean_seek == 10 &&
+               windows[1].total_seek == 0 && windows[1].mean_seek == 0 &&
+               windows[2].total_seek == 50 && windows[2].mean_seek == 25 &&
+               windows[3].total_seek == 40 && windows[3].mean_seek == 20;
+  assert(seeks);
+}
+
+/// Test that the loop of SeekKernel::distance counts every seek in the same
+/// bucket as SeekHistogram::add, for distances of every size
+TEST(SeekKernel, histogram_matches_add)
+{
+  // Locations of every magnitude, so the seeks reach every fine bucket
+  size_t state = 99;
+  vector<size_t> locations(256);
+  for (size_t i = 0; i < locations.size(); ++i) {
+    locations[i] = next_random(state) >> (next_random(state) % 64);
+  }
+  vector<size_t> keys = random_accesses(5003, 31, locations.size());
+
+  for (size_t stride = 1; stride <= 2; ++stride) {
+    vector<size_t> strided(keys.size() * stride);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      strided[i * stride] = keys[i];
+    }
+
+    SeekHistogram expected;
+    for (size_t i = 1; i < keys.size(); ++i) {
+      size_t previous = locations[keys[i - 1]];
+      size_t current = locations[keys[i]];
+      expected.add(previous < current ? current - previous
+                                      : previous - current);
+    }
+
+    SeekHistogram counted;
+    size_t distance = SeekKernel::distance(strided.data(), stride,
+                                           keys.size(), locations.data(),
+                                           &counted);
+    bool totals = distance == expected.total() &&
+                  counted.total() == expected.total() &&
+                  counted.count() == expected.count() &&
+                  counted.max() == expected.max();
+    assert(totals);
+
+    // fraction_below is exact at the low end of every fine bucket
+    bool buckets = true;
+    for (size_t limit = 1; limit < SeekHistogram::SUB_BUCKETS; ++limit) {
+      buckets = buckets &&
+                counted.fraction_below(limit) == expected.fraction_below(limit);
+    }
+    for (unsigned shift = 0; shift + SeekHistogram::SUB_BITS < 64; ++shift) {
+      for (size_t sub = 0; sub < SeekHistogram::SUB_BUCKETS; ++sub) {
+        size_t limit = (SeekHistogram::SUB_BUCKETS + sub) << shift;
+        buckets = buckets &&
+                  counted.fraction_below(limit) ==
+                      expected.fraction_below(limit);
+      }
+    }
+    assert(buckets);
+  }
+}
+
+TEST(SeekHistogram, buckets_and_quantiles)
+{
+  SeekHistogram histogram;
+  vector<size_t> distances = {0, 0, 1, 3, 4, 7, 15, 16, 1000, 1000000};
+  for (size_t i = 0; i < distances.size(); ++i) {
+    histogram.add(distances[i]);
+  }
+
+  bool totals = histogram.count() == 10 && histogram.total() == 1001046 &&
+                histogram.max() == 1000000;
+  assert(totals);
+
+  // 0 | 1 | 2-3 | 4-7 | 8-15 | 16-31 | ... | 512-1023 | ... | 2^19-2^20-1
+  bool log2 = histogram.log2_bucket_count(0) == 2 &&
+              histogram.log2_bucket_count(1) == 1 &&
+              histogram.log2_bucket_count(2) == 1 &&
+              histogram.log2_bucket_count(3) == 2 &&
+              histogram.log2_bucket_count(4) == 1 &&
+              histogram.log2_bucket_count(5) == 1 &&
+              histogram.log2_bucket_count(10) == 1 &&
+              histogram.log2_bucket_count(20) == 1;
+  assert(log2);
+  bool edges = SeekHistogram::log2_bucket_low(5) == 16 &&
+               SeekHistogram::log2_bucket_high(5) == 31 &&
+               SeekHistogram::log2_bucket_high(64) == ~size_t(0);
+  assert(edges);
+
+  bool zero_fraction = histogram.fraction_below(1) == 0.2 &&
+                       histogram.fraction_below(16) == 0.7;
+  assert(zero_fraction);
+
+  // Exact below 16, within 1/32 above
+  bool small = histogram.quantile(0.5) == 4 && histogram.quantile(0) == 0 &&
+               histogram.quantile(0.7) == 15;
+  assert(small);
+  size_t p90 = histogram.quantile(0.9);
+  bool close = p90 >= 1000 - 1000 / 32 && p90 <= 1000 + 1000 / 32;
+  assert(close);
+  bool top = histogram.quantile(1) <= 1000000 &&
+             histogram.quantile(1) >= 1000000 - 1000000 / 32;
+  assert(top);
+
+  // Merging two halves gives the same histogram
+  SeekHistogram first;
+  SeekHistogram second;
+  for (size_t i = 0; i < distances.size(); ++i) {
+    if (i % 2 == 0) {
+      first.add(distances[i]);
+    } else {
+      second.add(distances[i]);
+    }
+  }
+  first.merge(second);
+  bool merged = first.count() == histogram.count() &&
+                first.total() == histogram.total() &&
+                first.max() == histogram.max() &&
+                first.quantile(0.9) == histogram.quantile(0.9);
+  for (unsigned b = 0; b < SeekHistogram::NUM_LOG2_BUCKETS; ++b) {
+    merged = merged &&
+             first.log2_bucket_count(b) == histogram.log2_bucket_count(b);
+  }
+  assert(merged);
+}
+
+TEST(SeekHistogram, seek_histogram_matches_total)
+{
+  TraceSet trace;
+  vector<size_t> accesses = random_accesses(3000, 67, 100000);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    trace.insert(accesses[i]);
+  }
+
+  SeekHistogram serial = trace.seek_histogram(1);
+  bool matches = serial.count() == 2999 &&
+                 serial.total() == trace.total_seek_distance();
+  assert(matches);
+
+  SeekHistogram threaded = trace.seek_histogram(4);
+  bool same = threaded.count() == serial.count() &&
+              threaded.total() == serial.total() &&
+              threaded.quantile(0.99) == serial.quantile(0.99);
+  assert(same);
+
+  // The total and the histogram come out of the same pass
+  for (unsigned threads = 1; threads <= 4; threads += 3) {
+    SeekHistogram counted;
+    bool one_pass = trace.total_seek_distance(threads, &counted) ==
+                    serial.total() &&
+                    counted.count() == serial.count() &&
+                    counted.max() == serial.max() &&
+                    counted.quantile(0.5) == serial.quantile(0.5);
+    assert(one_pass);
+  }
+}
+
+/// Test that a snapshot reloads to the same trace and can be scored in place
+TEST(TraceSnapshot, round_trip_and_mapped_views)
+{
+    string snapshotName = "snapshotTest.snap";
+
+    TraceSet expected;
+    size_t state = 20;
+    for (size_t i = 0; i < 5000; ++i) {
+        next_random(state);
+        expected.insert((state >> 33) % 700, 1 + (state >> 20) % 8);
+    }
+    expected.change_locations({650, 3, 99, 12}, 40);
+    vector<size_t> timestamps;
+    for (size_t i = 0; i < 5000; ++i) {
+        timestamps.push_back(i * 3);
+    }
+    expected.set_timestamps(timestamps);
+    size_t expected_distance = expected.total_seek_distance();
+
+    bool saved = expected.save_snapshot(snapshotName);
+    assert(saved);
+    assert(TraceSnapshot::is_snapshot(snapshotName));
+
+    TraceSet test;
+    size_t bytes = test.readInSnapshot(snapshotName);
+    assert(bytes > 0);
+    assert(test.total_seek_distance() == expected_distance);
+    assert(test.has_request_lengths() && test.has_timestamps());
+    assert(test.get_request_length(17) == expected.get_request_length(17));
+    assert_same_trace(expected, test);
+
+    // The views read the file in place, and a copy on write mapping can be
+    // given another layout without changing the file.
+    TraceSnapshot snapshot;
+    bool opened = snapshot.open(snapshotName, false);
+    assert(opened);
+    assert(snapshot.num_accesses() == 5000);
+    assert(snapshot.mutable_key_locations() == nullptr);
+    assert(snapshot.sequence()[9].LBA == test.get_Sequence()[9].LBA);
+    assert(snapshot.total_seek_distance() == expected_distance);
+
+    TraceSnapshot copy;
+    opened = copy.open(snapshotName, true);
+    assert(opened);
+    size_t* locations = copy.mutable_key_locations();
+    for (size_t key = 0; key < copy.num_keys(); ++key) {
+        locations[key] = 0;
+    }
+    bool moved = copy.total_seek_distance() == 0;
+    assert(moved);
+    bool unchanged = snapshot.total_seek_distance() == expected_distance;
+    assert(unchanged);
+    copy.close();
+
+    TraceSet reloaded;
+    reloaded.readInSnapshot(snapshotName);
+    bool file_unchanged = reloaded.total_seek_distance() == expected_distance;
+    assert(file_unchanged);
+
+    remove(snapshotName.c_str());
+}
+
+/// Test that a dictionary encoded trace keeps its IDs and that files which
+/// are not snapshots are rejected
+TEST(TraceSnapshot, dictionary_and_rejects)
+{
+    string snapshotName = "snapshotDictionaryTest.snap";
+
+    TraceSet expected(true);
+    vector<size_t> LBAs = {1000000000000ULL, 5, 1000000000000ULL, 77, 5,
+                           18446744073709551615ULL};
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        expected.insert(LBAs[i]);
+    }
+    bool saved = expected.save_snapshot(snapshotName);
+    assert(saved);
+
+    TraceSet test;
+    test.insert(3);
+    test.readInSnapshot(snapshotName);
+    assert(test.is_dictionary_encoded());
+    assert(test.get_Sequence().size() == LBAs.size());
+    assert(test.get_ID(77) == expected.get_ID(77));
+    assert(test.get_LBA(3) == 18446744073709551615ULL);
+    assert(test.total_seek_distance() == expected.total_seek_distance());
+    vector<size_t> indices = test.get_indices(1000000000000ULL);
+    assert(indices.size() == 2 && indices[1] == 2);
+
+    // A text trace is not a snapshot, and the trace is left as it was
+    ofstream out(snapshotName);
+    out << "1\n2\n";
+    out.close();
+    assert(!TraceSnapshot::is_snapshot(snapshotName));
+    TraceSnapshot snapshot;
+    bool rejected = !snapshot.open(snapshotName, false) &&
+                    test.readInSnapshot(snapshotName) == 0;
+    assert(rejected);
+    assert(test.get_Sequence().size() == LBAs.size());
+
+    remove(snapshotName.c_str());
+}
+
+/// Test that memory_usage counts every data member and that allocations are
+/// counted
+TEST(MemoryStats, memory_usage_and_allocations)
+{
+    size_t allocations = MemoryStats::num_allocations();
+    size_t allocated = MemoryStats::bytes_allocated();
+
+    TraceSet test(true);
+    for (size_t i = 0; i < 1000; ++i) {
+        test.insert(1000000 + (i * 37) % 400);
+    }
+    size_t unscanned = MemoryStats::total(test.memory_usage());
+    test.total_seek_distance();
+
+    vector<MemoryStats::Container> containers = test.memory_usage();
+    assert(containers.size() == 11);
+    assert(string(containers[0].name) == "Sequence_");
+    assert(containers[0].bytes ==
+           test.get_Sequence().capacity() * sizeof(TraceSet::Line));
+    assert(containers[1].bytes ==
+           test.get_mapLBA().capacity() * sizeof(TraceSet::blockLBA));
+    assert(string(containers[4].name) == "LBA_IDs_ nodes");
+    assert(containers[4].bytes >= 400 * 2 * sizeof(size_t));
+    assert(string(containers[6].name) == "access_keys_");
+    assert(containers[6].bytes >= 1000 * sizeof(size_t));
+    assert(string(containers[7].name) == "key_locations_");
+    assert(containers[7].bytes >= 400 * sizeof(size_t));
+    // The scan reads the columns without copying them
+    assert(string(containers[8].name) == "transitions_");
+    assert(MemoryStats::total(containers) == unscanned);
+    size_t sum = 0;
+    for (size_t i = 0; i < containers.size(); ++i) {
+        sum += containers[i].bytes;
+    }
+    assert(MemoryStats::total(containers) == sum);
+
+    bool counted = MemoryStats::num_allocations() > allocations &&
+                   MemoryStats::bytes_allocated() >= allocated + sum / 2;
+    assert(counted);
+    assert(MemoryStats::peak_rss_bytes() > 0);
+
+    ostringstream out;
+    MemoryStats::print(out, containers);
+    assert(out.str().find("transitions_: ") != string::npos);
+    assert(out.str().find("total: " + to_string(sum) + " bytes") !=
+           string::npos);
+}
+
+TEST(TraceGenerator, deterministic_and_bounded)
+{
+    TraceGenerator::Options options;
+    options.num_accesses = 20000;
+    options.LBA_space = 1ULL << 48;
+    options.seed = 7;
+
+    TraceGenerator first(options);
+    TraceGenerator second(options);
+    vector<uint64_t> LBAs;
+    first.generate([&LBAs](uint64_t LBA) { LBAs.push_back(LBA); });
+    assert(LBAs.size() == 20000);
+
+    size_t i = 0;
+    bool same = true;
+    bool in_space = true;
+    second.generate([&](uint64_t LBA) {
+        same = same && LBA == LBAs[i++];
+        in_space = in_space && LBA < (1ULL << 48);
+    });
+    assert(same && in_space);
+
+    // generate starts over, and another seed gives another trace
+    first.restart();
+    assert(first.next() == LBAs[0]);
+    options.seed = 8;
+    TraceGenerator other(options);
+    size_t differ = 0;
+    for (size_t j = 0; j < 100; ++j) {
+        differ += other.next() != LBAs[j];
+    }
+    assert(differ > 50);
+
+    // Out of range options are clamped
+    options.LBA_space = 0;
+    options.hot_fraction = 3;
+    TraceGenerator clamped(options);
+    assert(clamped.options().LBA_space == 1);
+    assert(clamped.options().hot_set_size == 1);
+    assert(clamped.options().hot_fraction <= 1);
+    bool zero = clamped.next() == 0 && clamped.next() == 0;
+    assert(zero);
+}
+
+TEST(TraceGenerator, kinds_of_access)
+{
+    // Only sequential runs
+    TraceGenerator::Options options;
+    options.num_accesses = 64 * 50;
+    options.LBA_space = 1000000;
+    options.hot_fraction = 0;
+    options.sequential_fraction = 1;
+    options.strided_fraction = 0;
+    options.run_length = 64;
+    TraceGenerator runs(options);
+    vector<uint64_t> LBAs;
+    runs.generate([&LBAs](uint64_t LBA) { LBAs.push_back(LBA); });
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        if (i % 64 != 0) {
+            assert(LBAs[i] == (LBAs[i - 1] + 1) % 1000000);
+        }
+    }
+
+    // Only strided scans
+    options.sequential_fraction = 0;
+    options.strided_fraction = 1;
+    options.scan_length = 10;
+    options.stride = 16;
+    TraceGenerator scans(options);
+    LBAs.clear();
+    scans.generate([&LBAs](uint64_t LBA) { LBAs.push_back(LBA); });
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        if (i % 10 != 0) {
+            assert(LBAs[i] == (LBAs[i - 1] + 16) % 1000000);
+        }
+    }
+
+    // Only hot accesses, in phases that each move the hot set
+    options.strided_fraction = 0;
+    options.hot_fraction = 1;
+    options.hot_set_size = 500;
+    options.phase_length = 20000;
+    options.num_accesses = 40000;
+    TraceGenerator hot(options);
+    vector<map<uint64_t, size_t>> counts(2);
+    size_t position = 0;
+    hot.generate([&](uint64_t LBA) {
+        ++counts[position++ / 20000][LBA];
+    });
+    for (size_t phase = 0; phase < 2; ++phase) {
+        assert(counts[phase].size() <= 500);
+        // The hottest LBA is accessed about 1 / H(500) = 15% of the time
+        uint64_t hottest = hot.hot_LBA(0, phase);
+        assert(counts[phase][hottest] > 2000);
+        assert(counts[phase][hottest] < 4000);
+        assert(counts[phase][hot.hot_LBA(1, phase)] > 1000);
+    }
+    size_t shared = 0;
+    for (map<uint64_t, size_t>::iterator it = counts[0].begin();
+         it != counts[0].end(); ++it) {
+        shared += counts[1].count(it->first);
+    }
+    assert(shared < 50);
+}
+
+TEST(TraceGenerator, write_text_and_binary)
+{
+    string textName = "generatedTest.trace";
+    string binaryName = "generatedTest.lbat";
+
+    TraceGenerator::Options options;
+    options.num_accesses = 30000;
+    options.LBA_space = 1ULL << 40;
+    TraceGenerator generator(options);
+    vector<size_t> LBAs;
+    generator.generate([&LBAs](uint64_t LBA) { LBAs.push_back(LBA); });
+
+    bool written = generator.write_text(textName);
+    assert(written);
+    // The LBAs are spread over 2^40 blocks, so the traces are dictionary
+    // encoded.
+    TraceSet text(true);
+    bool read = text.readInMapped(textName) > 0;
+    assert(read);
+    assert(text.get_Sequence().size() == 30000);
+
+    written = generator.write_binary(binaryName, false);
+    assert(written);
+    TraceSet binary(true);
+    read = binary.readInBinary(binaryName) > 0;
+    assert(read);
+    assert(binary.get_Sequence().size() == 30000);
+    BinaryTrace file;
+    bool opened = file.open(binaryName);
+    assert(opened);
+    assert(file.header().unique_LBAs == 0);
+    assert(file.header().max_LBA ==
+           *max_element(LBAs.begin(), LBAs.end()));
+
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        assert(text.get_LBA(text.get_Sequence()[i].LBA) == LBAs[i]);
+        assert(binary.get_LBA(binary.get_Sequence()[i].LBA) == LBAs[i]);
+    }
+
+    remove(textName.c_str());
+    remove(binaryName.c_str());
+}
+
+TEST(CacheModel, policies)
+{
+    // A cache of two entries, 3 evicts 2 and then 2 evicts 1 in both
+    vector<size_t> keys = {1, 2, 1, 3, 2};
+    LRUCache lru(2);
+    ClockCache clock(2);
+    vector<bool> lru_hits;
+    vector<bool> clock_hits;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        lru_hits.push_back(lru.access(keys[i]));
+        clock_hits.push_back(clock.access(keys[i]));
+    }
+    vector<bool> expected = {false, false, true, false, false};
+    assert(lru_hits == expected);
+    assert(clock_hits == expected);
+    assert(lru.hits() == 1 && lru.misses() == 4);
+    assert(clock.hits() == 1 && clock.misses() == 4);
+
+    // The same hits as a list kept in recency order
+    lru.clear(0);
+    list<size_t> recency;
+    size_t reference_hits = 0;
+    vector<size_t> random_keys = random_accesses(20000, 25, 300);
+    for (size_t i = 0; i < random_keys.size(); ++i) {
+        size_t key = random_keys[i];
+        list<size_t>::iterator found = find(recency.begin(), recency.end(),
+                                            key);
+        if (found != recency.end()) {
+            ++reference_hits;
+            recency.erase(found);
+        }
+        else if (recency.size() == 2) {
+            recency.pop_back();
+        }
+        recency.push_front(key);
+        lru.access(key);
+    }
+    assert(lru.hits() == reference_hits);
+
+    // Hot keys seen twice survive a scan in ARC, but not in LRU
+    ARCCache arc(4);
+    lru = LRUCache(4);
+    vector<size_t> stream = {1, 2, 1, 2};
+    for (size_t key = 100; key < 200; ++key) {
+        stream.push_back(key);
+    }
+    for (size_t i = 0; i < stream.size(); ++i) {
+        arc.access(stream[i]);
+        lru.access(stream[i]);
+    }
+    bool arc_kept = arc.access(1) && arc.access(2);
+    bool lru_kept = lru.access(1) || lru.access(2);
+    assert(arc_kept);
+    assert(!lru_kept);
+
+    // Caches that hold every key only miss the first access of each
+    ARCCache large_arc(1000);
+    ClockCache large_clock(1000);
+    for (size_t i = 0; i < 5000; ++i) {
+        large_arc.access(i % 700);
+        large_clock.access(i % 700);
+    }
+    assert(large_arc.misses() == 700 && large_clock.misses() == 700);
+    assert(large_arc.target() <= 1000);
+
+    // A cache of nothing misses everything
+    ARCCache empty(0);
+    bool hit = empty.access(3) || empty.access(3);
+    assert(!hit);
+    assert(empty.misses() == 2);
+}
+
+TEST(CacheModel, cached_seek_distance)
+{
+    TraceSet test;
+    vector<size_t> LBAs = {10, 20, 10, 30, 20};
+    for (size_t i = 0; i < LBAs.size(); ++i) {
+        test.insert(LBAs[i]);
+    }
+    assert(test.total_seek_distance() == 10 + 10 + 20 + 10);
+
+    // Only 10, 20 and 30 miss, the head moves 10 and then 10
+    LRUCache lru(4);
+    assert(test.cached_seek_distance(lru) == 20);
+    assert(lru.hits() == 2 && lru.misses() == 3);
+
+    // With room for one LBA no access repeats the one before it, so every
+    // access misses
+    ClockCache clock(1);
+    assert(test.cached_seek_distance(clock) == test.total_seek_distance());
+
+    // On a larger trace a cache of 0 gives the total seek distance, and each
+    // policy gives the distance of the accesses it misses
+    TraceSet large;
+    vector<size_t> accesses = random_accesses(20000, 30, 2000);
+    for (size_t i = 0; i < accesses.size(); ++i) {
+        large.insert(accesses[i] * accesses[i] / 2000);
+    }
+    large.change_locations({0, 1, 2, 3, 4}, 1000);
+    size_t total = large.total_seek_distance();
+    LRUCache none(0);
+    ARCCache arc_none(0);
+    assert(large.cached_seek_distance(none) == total);
+    assert(large.cached_seek_distance(arc_none) == total);
+
+    ARCCache arc(200);
+    size_t arc_distance = large.cached_seek_distance(arc);
+    assert(arc_distance < total);
+    assert(arc.hits() + arc.misses() == 20000);
+    assert(arc.hits() > 0);
+
+    // Evaluating again starts from an empty cache
+    bool repeatable = large.cached_seek_distance(arc) == arc_distance;
+    assert(repeatable);
+}
+
+/// Test that a snapshot is swept from its mapping with the same distances as
+/// the TraceSet it was saved from, and that a count whose size in bytes
+/// overflows is rejected
+TEST(TraceSnapshot, sweep_and_overflowing_counts)
+{
+    string snapshotName = "snapshotSweepTest.snap";
+
+    for (int dictionary = 0; dictionary < 2; ++dictionary) {
+        TraceSet trace(dictionary == 1);
+        vector<size_t> accesses = random_accesses(3000, 31, 400);
+        for (size_t i = 0; i < accesses.size(); ++i) {
+            trace.insert(accesses[i] * 2);
+        }
+        trace.change_locations({10, 20, 30}, 5);
+        vector<size_t> ranked = trace.rank_LBAs(0, 1);
+        vector<size_t> prefixes = {0, 1, ranked.size() / 3, ranked.size()};
+        vector<size_t> expected = trace.sweep_seek_distance(ranked, prefixes, 0);
+
+        bool saved = trace.save_snapshot(snapshotName);
+        assert(saved);
+        TraceSnapshot snapshot;
+        bool opened = snapshot.open(snapshotName, false);
+        assert(opened);
+        bool same = snapshot.sweep_seek_distance(ranked, prefixes, 0) ==
+                    expected;
+        assert(same);
+    }
+
+    // 2^60 LBA_locations are 2^64 bytes, which wraps around to 0
+    TraceSnapshot::Header header;
+    ifstream in(snapshotName, ios::binary);
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    in.close();
+    header.counts[TraceSnapshot::LOCATIONS] = 1ULL << 60;
+    fstream out(snapshotName, ios::binary | ios::in | ios::out);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    TraceSnapshot snapshot;
+    bool rejected = !snapshot.open(snapshotName, false);
+    assert(rejected);
+
+    remove(snapshotName.c_str());
+}
+
 //--------------------------------------------------
 //           RUNNING THE TESTS
 //--------------------------------------------------
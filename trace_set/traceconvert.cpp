@@ -0,0 +1,75 @@
+/*
+ *  traceconvert.cpp
+ *
+ *  Author:         Jazmin Ortiz
+ *
+ *  Description:    Converts a text trace, with one LBA in decimal on each
+ *                  line, into the binary trace format described in
+ *                  BinaryTrace.hpp, which TraceSet::readInBinary and
+ *                  FrequentPairs::readInBinarySequence load without any text
+ *                  parsing.
+ *
+ *  Usage:          trace-convert -t <text trace> -o <binary trace>
+ */
+
+#include <string>
+#include <cstring>
+#include <iostream>
+
+#include "MappedTrace.hpp"
+#include "BinaryTrace.hpp"
+
+using namespace std;
+
+int main( int argc, char* argv[])
+{
+    string text_trace; 
+    string binary_trace; 
+    for (int i = 1; i < argc; ++i){
+        if (i + 1 != argc){ 
+            if (!strcmp(argv[i], "-t")){
+                text_trace = argv[i + 1]; 
+            }
+            if (!strcmp(argv[i], "-o")){
+                binary_trace = argv[i + 1];  
+            }
+        }
+    }
+
+    if (text_trace.empty() || binary_trace.empty()){
+        cout << "Usage: trace-convert -t <text trace> -o <binary trace>" 
+             << endl; 
+        return 1; 
+    }
+
+    MappedTrace text(text_trace); 
+    if (!text.is_open()){
+        cout << text_trace << " does not seem to exist. " << endl;
+        return 1; 
+    }
+
+    BinaryTraceWriter writer(binary_trace); 
+    if (!writer.is_open()){
+        cout << binary_trace << " could not be created. " << endl;
+        return 1; 
+    }
+
+    MappedTrace::for_each_LBA(text.begin(), text.end(), 
+                              [&writer](size_t LBA) { writer.append(LBA); });
+
+    BinaryTrace::Header header = writer.header(); 
+    if (!writer.close()){
+        cout << "Could not write " << binary_trace << endl; 
+        return 1; 
+    }
+
+    // Report what was converted and how much smaller the binary trace is. 
+    ifstream converted(binary_trace, ios::binary | ios::ate); 
+    cout << "accesses: " << header.num_accesses << endl; 
+    cout << "unique LBAs: " << header.unique_LBAs << endl; 
+    cout << "max LBA: " << header.max_LBA << endl; 
+    cout << "text bytes: " << text.size() << endl; 
+    cout << "binary bytes: " << converted.tellg() << endl; 
+
+    return 0;
+}
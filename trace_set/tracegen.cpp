@@ -0,0 +1,113 @@
+/*
+ *  tracegen.cpp
+ *
+ *  Author:         Jazmin Ortiz
+ *
+ *  Description:    Writes a synthetic trace made by TraceGenerator, as text
+ *                  with one LBA in decimal on each line, or in the binary
+ *                  trace format described in BinaryTrace.hpp with -b. Every
+ *                  option of TraceGenerator::Options has a flag, the ones
+ *                  that are not given keep their defaults.
+ *
+ *  Usage:          trace-gen -o <trace> [-b] [-n accesses] [-s seed]
+ *                            [-S LBA space] [-H hot set size]
+ *                            [-z zipf exponent] [-f hot fraction]
+ *                            [-q sequential fraction] [-r run length]
+ *                            [-d strided fraction] [-k stride]
+ *                            [-l scan length] [-p phase length]
+ */
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <chrono>
+
+#include "TraceGenerator.hpp"
+
+using namespace std;
+
+int main( int argc, char* argv[])
+{
+    TraceGenerator::Options options;
+    string trace;
+    bool binary = false;
+    for (int i = 1; i < argc; ++i){
+        if (!strcmp(argv[i], "-b")){
+            binary = true;
+        }
+        if (i + 1 != argc){
+            const char* value = argv[i + 1];
+            if (!strcmp(argv[i], "-o")){
+                trace = value;
+            }
+            if (!strcmp(argv[i], "-n")){
+                options.num_accesses = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-s")){
+                options.seed = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-S")){
+                options.LBA_space = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-H")){
+                options.hot_set_size = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-z")){
+                options.zipf_exponent = strtod(value, nullptr);
+            }
+            if (!strcmp(argv[i], "-f")){
+                options.hot_fraction = strtod(value, nullptr);
+            }
+            if (!strcmp(argv[i], "-q")){
+                options.sequential_fraction = strtod(value, nullptr);
+            }
+            if (!strcmp(argv[i], "-r")){
+                options.run_length = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-d")){
+                options.strided_fraction = strtod(value, nullptr);
+            }
+            if (!strcmp(argv[i], "-k")){
+                options.stride = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-l")){
+                options.scan_length = strtoull(value, nullptr, 10);
+            }
+            if (!strcmp(argv[i], "-p")){
+                options.phase_length = strtoull(value, nullptr, 10);
+            }
+        }
+    }
+
+    if (trace.empty()){
+        cout << "Usage: trace-gen -o <trace> [-b] [-n accesses] [-s seed] "
+             << "[-S LBA space] [-H hot set size] [-z zipf exponent] "
+             << "[-f hot fraction] [-q sequential fraction] "
+             << "[-r run length] [-d strided fraction] [-k stride] "
+             << "[-l scan length] [-p phase length]" << endl;
+        return 1;
+    }
+
+    TraceGenerator generator(options);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    // Counting the distinct LBAs of a huge trace would take more memory
+    // than the trace itself, so the binary header leaves them out.
+    bool written = binary ? generator.write_binary(trace, false)
+                          : generator.write_text(trace);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    if (!written){
+        cout << "Could not write " << trace << endl;
+        return 1;
+    }
+
+    const TraceGenerator::Options& used = generator.options();
+    cout << "accesses: " << used.num_accesses << endl;
+    cout << "LBA space: " << used.LBA_space << endl;
+    cout << "hot set size: " << used.hot_set_size << endl;
+    cout << "seconds: " << elapsed.count() << endl;
+
+    return 0;
+}
@@ -10,18 +10,146 @@
  */
 
 #include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <vector>
 
 #include "TraceSet.hpp"
+#include "BinaryTrace.hpp"
+#include "LayoutMap.hpp"
+#include "SeekCost.hpp"
+#include "CacheModel.hpp"
+#include "SeekHistogram.hpp"
+#include "TraceSnapshot.hpp"
+#include "MemoryStats.hpp"
 
 using namespace std;
 
+// Prints the estimated seek time of the trace under model, and with a 
+//     DiskTiming also the service time of its requests. 
+template <typename SeekModel>
+static void print_times(TraceSet& trace, const SeekModel& model, 
+                        const DiskTiming* timing)
+{
+    if (timing == nullptr){
+        cout << "Seek time: " << trace.seek_time(model) << endl; 
+        return; 
+    }
+    ServiceEstimate estimate = trace.service_time(model, *timing); 
+    cout << "Seek time: " << estimate.seek_time << endl; 
+    cout << "Service time: " << estimate.total_time() << " (rotation " 
+         << estimate.rotation_time << ", transfer " << estimate.transfer_time 
+         << ")" << endl; 
+}
+
+// Prints the estimated times of the trace under the model named by 
+//     cost_model: "linear", "sqrt,settle,sqrt_scale,linear_scale,knee", or 
+//     the name of a drive profile file with one "distance time" per line. 
+//     Each model is its own instantiation of the TraceSet templates. 
+static void print_seek_time(TraceSet& trace, const string& cost_model, 
+                            const DiskTiming* timing)
+{
+    double settle, sqrt_scale, linear_scale;
+    unsigned long long knee;
+    if (cost_model.empty() || cost_model == "linear"){
+        print_times(trace, LinearSeek(), timing); 
+    }
+    else if (sscanf(cost_model.c_str(), "sqrt,%lf,%lf,%lf,%llu", &settle, 
+                    &sqrt_scale, &linear_scale, &knee) == 4){
+        SqrtLinearSeek model(settle, sqrt_scale, linear_scale, knee); 
+        print_times(trace, model, timing); 
+    }
+    else{
+        ifstream profile(cost_model); 
+        TableSeek model; 
+        if (!profile || !model.read(profile)){
+            cout << cost_model << " is not a seek cost model." << endl; 
+            return; 
+        }
+        print_times(trace, model, timing); 
+    }
+}
+
+// Prints the seek distance of the trace behind cache, and how many of its 
+//     accesses hit the cache. 
+template <typename Cache>
+static void print_cached(TraceSet& trace, Cache& cache)
+{
+    size_t distance = trace.cached_seek_distance(cache); 
+    cout << "Cached: " << distance << " (hits " << cache.hits() 
+         << ", misses " << cache.misses() << ")" << endl; 
+}
+
+// Prints the seek distance of the trace behind the cache named by 
+//     cache_model: "lru,capacity", "clock,capacity" or "arc,capacity". 
+static void print_cached_seek_distance(TraceSet& trace, 
+                                       const string& cache_model)
+{
+    char policy[16];
+    unsigned long long capacity;
+    if (sscanf(cache_model.c_str(), "%15[a-z],%llu", policy, 
+               &capacity) != 2){
+        cout << cache_model << " is not a cache model." << endl; 
+    }
+    else if (!strcmp(policy, "lru")){
+        LRUCache cache(capacity); 
+        print_cached(trace, cache); 
+    }
+    else if (!strcmp(policy, "clock")){
+        ClockCache cache(capacity); 
+        print_cached(trace, cache); 
+    }
+    else if (!strcmp(policy, "arc")){
+        ARCCache cache(capacity); 
+        print_cached(trace, cache); 
+    }
+    else{
+        cout << cache_model << " is not a cache model." << endl; 
+    }
+}
+
+// Prints the share of zero and short seeks, the median, p90 and p99 seek, 
+//     and the number of seeks in every non-empty log2 bucket as a csv. 
+static void print_histogram(TraceSet& trace, unsigned threads)
+{
+    SeekHistogram histogram = trace.seek_histogram(threads); 
+    cout << "Zero seeks: " << histogram.fraction_below(1) << endl; 
+    cout << "Seeks under 1024: " << histogram.fraction_below(1024) << endl; 
+    cout << "p50: " << histogram.quantile(0.5) << " p90: " 
+         << histogram.quantile(0.9) << " p99: " << histogram.quantile(0.99) 
+         << " max: " << histogram.max() << endl; 
+    cout << "low,high,count" << endl; 
+    for (unsigned b = 0; b < SeekHistogram::NUM_LOG2_BUCKETS; ++b){
+        if (histogram.log2_bucket_count(b) != 0){
+            cout << SeekHistogram::log2_bucket_low(b) << "," 
+                 << SeekHistogram::log2_bucket_high(b) << "," 
+                 << histogram.log2_bucket_count(b) << endl; 
+        }
+    }
+}
+
 int main( int argc, char* argv[])
 {
     string file_to_load;
     string freqLBASeq; 
-    bool calcInitial; 
+    bool calcInitial = false; 
+    bool mapped = false; 
+    bool streamed = false; 
+    bool dictionary = false; 
+    bool distribution = false; 
+    unsigned threads = 1; 
+    size_t sweeps = 0; 
+    string cost_model; 
+    string disk_timing; 
+    size_t window_accesses = 0; 
+    size_t window_interval = 0; 
+    string timestamp_file; 
+    string snapshot_file; 
+    string cache_model; 
     for (int i = 1; i < argc; ++i){
         if (i + 1 != argc){ 
             if (!strcmp(argv[i], "-t")){
@@ -34,11 +162,62 @@ int main( int argc, char* argv[])
                 calcInitial = 1; 
 
             }
+            if (!strcmp(argv[i], "-m")){
+                mapped = true; 
+            }
+            if (!strcmp(argv[i], "-f")){
+                streamed = true; 
+            }
+            if (!strcmp(argv[i], "-d")){
+                dictionary = true; 
+            }
+            if (!strcmp(argv[i], "-g")){
+                distribution = true; 
+            }
+            if (!strcmp(argv[i], "-j")){
+                threads = strtoul(argv[i + 1], nullptr, 10); 
+            }
+            if (!strcmp(argv[i], "-i")){
+                sweeps = strtoull(argv[i + 1], nullptr, 10); 
+            }
+            if (!strcmp(argv[i], "-c")){
+                cost_model = argv[i + 1]; 
+            }
+            if (!strcmp(argv[i], "-r")){
+                disk_timing = argv[i + 1]; 
+            }
+            if (!strcmp(argv[i], "-w")){
+                window_accesses = strtoull(argv[i + 1], nullptr, 10); 
+            }
+            if (!strcmp(argv[i], "-W")){
+                window_interval = strtoull(argv[i + 1], nullptr, 10); 
+            }
+            if (!strcmp(argv[i], "-T")){
+                timestamp_file = argv[i + 1]; 
+            }
+            if (!strcmp(argv[i], "-S")){
+                snapshot_file = argv[i + 1]; 
+            }
+            if (!strcmp(argv[i], "-C")){
+                cache_model = argv[i + 1]; 
+            }
         }
     }
     if (!strcmp(argv[argc - 1], "-s")){
     	calcInitial = 1; 
     }
+    if (!strcmp(argv[argc - 1], "-m")){
+        mapped = true; 
+    }
+    if (!strcmp(argv[argc - 1], "-f")){
+        streamed = true; 
+    }
+    if (!strcmp(argv[argc - 1], "-d")){
+        dictionary = true; 
+    }
+    if (!strcmp(argv[argc - 1], "-g")){
+        distribution = true; 
+    }
     // Creates fstream objects which hold the contents of the
     // files input by the user.
     ifstream tracefile(file_to_load);
@@ -52,24 +231,172 @@ int main( int argc, char* argv[])
     if (!LBAFile){
         cout << freqLBASeq << " does not seem to exist." << endl;
     }
+    //With -f the trace is never loaded, it is streamed through a LayoutMap 
+    //    so that traces larger than memory can be scored. 
+    else if (streamed){
+        TraceSet trace; 
+        if (calcInitial){
+            cout << "Initial: " << LayoutMap().stream_seek_distance(file_to_load)
+                 << endl; 
+        }
+        else{
+            LayoutMap layout(trace.readLBAs(LBAFile), 0); 
+            cout << layout.stream_seek_distance(file_to_load) << endl; 
+        }
+    }
+    //A snapshot given to -i is swept straight from its mapping, without 
+    //    copying the trace into a TraceSet. 
+    else if (sweeps != 0 && !calcInitial && snapshot_file.empty() && 
+             TraceSnapshot::is_snapshot(file_to_load)){
+        TraceSnapshot snapshot; 
+        if (!snapshot.open(file_to_load, false)){
+            cout << file_to_load << " is not a valid snapshot." << endl; 
+            return 1; 
+        }
+        TraceSet trace; 
+        vector<size_t> ranked = trace.readLBAs(LBAFile); 
+        vector<size_t> prefixes(1, 0); 
+        for (size_t i = 1; i <= sweeps; ++i){
+            prefixes.push_back(ranked.size() / i); 
+        }
+        vector<size_t> distances = 
+            snapshot.sweep_seek_distance(ranked, prefixes, 0); 
+        cout << "num_LBAs,seek_distance" << endl; 
+        for (size_t i = 0; i < prefixes.size(); ++i){
+            cout << prefixes[i] << "," << distances[i] << endl; 
+        }
+    }
     else {
         //Otherwise, loads the files into the traceset.
 
-        // Creates a TraceSet object
-        TraceSet trace;
+        // Creates a TraceSet object, with -d it is dictionary encoded so 
+        //     that its memory use depends on the number of distinct LBAs 
+        //     rather than the largest LBA. 
+        TraceSet trace(dictionary);
 
-        trace.readIn(tracefile);
+        //With -m the trace is memory mapped and parsed in place, and the 
+        //    load throughput is reported on stderr. 
+        //Binary traces written by trace-convert and snapshots written with 
+        //    -S are recognized by their headers and loaded without any text 
+        //    parsing. 
+        //With -r latency,transfer the trace lines may give the length of 
+        //    each request after its LBA, and the service time of the 
+        //    requests is printed with that rotational latency and transfer 
+        //    time per block. 
+        DiskTiming timing; 
+        bool timed = !disk_timing.empty() && 
+            sscanf(disk_timing.c_str(), "%lf,%lf", &timing.rotational_latency, 
+                   &timing.transfer_per_block) == 2; 
+        if (TraceSnapshot::is_snapshot(file_to_load)){
+            trace.readInSnapshot(file_to_load); 
+        }
+        else if (BinaryTrace::is_binary_trace(file_to_load)){
+            trace.readInBinary(file_to_load); 
+        }
+        else if (timed){
+            trace.readInRequests(file_to_load); 
+        }
+        else if (mapped){
+            chrono::steady_clock::time_point start = chrono::steady_clock::now(); 
+            size_t bytes = trace.readInMapped(file_to_load); 
+            chrono::duration<double> elapsed = 
+                chrono::steady_clock::now() - start; 
+            cerr << "Loaded " << bytes / 1e6 << " MB in " << elapsed.count() 
+                 << " s (" << bytes / 1e6 / elapsed.count() << " MB/s)" 
+                 << endl; 
+        }
+        else{
+            trace.readIn(tracefile);
+        }
+        //With -S file the loaded trace is saved as a snapshot, which -t 
+        //    can load again in place of the trace. 
+        if (!snapshot_file.empty() && !trace.save_snapshot(snapshot_file)){
+            cout << snapshot_file << " could not be written." << endl; 
+        }
         //If we only want the initial distance, then we just calculate
         //    the initial distance and do nothing else. 
+        //With -j the seek distance is split across that many threads, 
+        //    -j 0 uses every hardware thread. 
+        //With -c model (or -r) the estimated seek time is printed after the 
+        //    seek distance, and with -g the distribution of the seeks. 
+        //With -C policy,capacity the seek distance behind a simulated 
+        //    buffer cache (lru, clock or arc) is printed too, where only the 
+        //    accesses that miss the cache seek. 
         if (calcInitial){
-            cout << "Initial: " << trace.total_seek_distance() << endl; 
+            cout << "Initial: " << trace.total_seek_distance(threads) << endl; 
+            if (!cost_model.empty() || timed){
+                print_seek_time(trace, cost_model, timed ? &timing : nullptr); 
+            }
+            if (distribution){
+                print_histogram(trace, threads); 
+            }
+            if (!cache_model.empty()){
+                print_cached_seek_distance(trace, cache_model); 
+            }
+        }
+
+        //With -i Num the seek distance is found with the top total/1, 
+        //    total/2, ..., total/Num LBAs of the list moved to the front, all 
+        //    from this one load of the trace, and printed as a csv curve 
+        //    whose first row is the initial seek distance. 
+        else if (sweeps != 0){
+            vector<size_t> ranked = trace.readLBAs(LBAFile); 
+            vector<size_t> prefixes(1, 0); 
+            for (size_t i = 1; i <= sweeps; ++i){
+                prefixes.push_back(ranked.size() / i); 
+            }
+            vector<size_t> distances = 
+                trace.sweep_seek_distance(ranked, prefixes, 0); 
+            cout << "num_LBAs,seek_distance" << endl; 
+            for (size_t i = 0; i < prefixes.size(); ++i){
+                cout << prefixes[i] << "," << distances[i] << endl; 
+            }
+        }
+
+        //With -w N the layout is applied and the seek distance is printed 
+        //    for every window of N accesses, with -W interval and -T file 
+        //    (one timestamp per line, one line per access) for every 
+        //    interval of time instead. 
+        else if (window_accesses != 0 || window_interval != 0){
+            trace.change_locations(trace.readLBAs(LBAFile), 0);
+            vector<TraceSet::Window> windows; 
+            if (window_interval != 0){
+                ifstream timestampStream(timestamp_file); 
+                trace.set_timestamps(trace.readLBAs(timestampStream)); 
+                windows = trace.window_seek_distance_by_time(window_interval, 
+                                                             threads); 
+            }
+            else{
+                windows = trace.window_seek_distance(window_accesses, threads); 
+            }
+            cout << "start,num_accesses,total_seek,mean_seek" << endl; 
+            for (size_t i = 0; i < windows.size(); ++i){
+                cout << windows[i].start_time << "," 
+                     << windows[i].num_accesses << "," 
+                     << windows[i].total_seek << "," 
+                     << windows[i].mean_seek << endl; 
+            }
         }
 
         else{
             trace.change_locations(trace.readLBAs(LBAFile), 0);
-            cout << trace.total_seek_distance() << endl; 
+            cout << trace.total_seek_distance(threads) << endl; 
+            if (!cost_model.empty() || timed){
+                print_seek_time(trace, cost_model, timed ? &timing : nullptr); 
+            }
+            if (distribution){
+                print_histogram(trace, threads); 
+            }
+            if (!cache_model.empty()){
+                print_cached_seek_distance(trace, cache_model); 
+            }
         }
+
+        //The memory held by each data member of the trace is printed on 
+        //    stderr, so that runs on large traces can be sized. 
+        MemoryStats::print(cerr, trace.memory_usage()); 
     }
+    MemoryStats::print(cerr); 
   return 0;
 }
 
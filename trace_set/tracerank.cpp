@@ -0,0 +1,105 @@
+/*
+ *  tracerank.cpp
+ *
+ *  Author:         Jazmin Ortiz
+ *
+ *  Description:    Ranks the LBAs of a trace from most to least accessed and
+ *                  prints them one per line, which is the list of frequent
+ *                  LBAs that trace-set2 -l reads. This replaces
+ *                  sort | uniq -c | sort -r on the text trace. Text and
+ *                  binary traces are both accepted.
+ *
+ *  Usage:          trace-rank -t <trace> [-k <top K>] [-j <threads>] [-c]
+ *
+ *                  -k only prints the K most accessed LBAs, -j sets the
+ *                  number of counting threads (0, the default, uses every
+ *                  hardware thread) and -c prints LBA,count on each line.
+ */
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "MappedTrace.hpp"
+#include "BinaryTrace.hpp"
+#include "FrequencyRank.hpp"
+
+using namespace std;
+
+int main( int argc, char* argv[])
+{
+    string trace_file; 
+    size_t top_k = 0; 
+    unsigned threads = 0; 
+    bool counts = false; 
+    for (int i = 1; i < argc; ++i){
+        if (i + 1 != argc){ 
+            if (!strcmp(argv[i], "-t")){
+                trace_file = argv[i + 1]; 
+            }
+            if (!strcmp(argv[i], "-k")){
+                top_k = strtoull(argv[i + 1], nullptr, 10); 
+            }
+            if (!strcmp(argv[i], "-j")){
+                threads = strtoul(argv[i + 1], nullptr, 10); 
+            }
+        }
+        if (!strcmp(argv[i], "-c")){
+            counts = true; 
+        }
+    }
+
+    if (trace_file.empty()){
+        cout << "Usage: trace-rank -t <trace> [-k <top K>] [-j <threads>] [-c]"
+             << endl; 
+        return 1; 
+    }
+
+    // Reads every access into memory, binary traces are recognized by their
+    //     header. 
+    vector<size_t> accesses; 
+    if (BinaryTrace::is_binary_trace(trace_file)){
+        BinaryTrace trace; 
+        if (!trace.open(trace_file)){
+            cout << trace_file << " is not a readable binary trace. " << endl;
+            return 1; 
+        }
+        accesses.reserve(trace.header().num_accesses); 
+        bool complete = trace.for_each_LBA([&accesses](size_t LBA) { 
+            accesses.push_back(LBA); 
+        });
+        if (!complete){
+            cout << trace_file << " is a corrupt binary trace. " << endl;
+            return 1; 
+        }
+    }
+    else{
+        MappedTrace trace(trace_file); 
+        if (!trace.is_open()){
+            cout << trace_file << " does not seem to exist. " << endl;
+            return 1; 
+        }
+        accesses.reserve(MappedTrace::count_lines(trace.begin(), trace.end())); 
+        MappedTrace::for_each_LBA(trace.begin(), trace.end(), 
+                                  [&accesses](size_t LBA) { 
+                                      accesses.push_back(LBA); 
+                                  });
+    }
+
+    vector<FrequencyRank::Count> ranked = 
+        FrequencyRank::count(accesses, threads); 
+    FrequencyRank::rank(ranked, top_k); 
+
+    for (size_t i = 0; i < ranked.size(); ++i){
+        if (counts){
+            cout << ranked[i].LBA << "," << ranked[i].count << "\n"; 
+        }
+        else{
+            cout << ranked[i].LBA << "\n"; 
+        }
+    }
+
+    return 0;
+}